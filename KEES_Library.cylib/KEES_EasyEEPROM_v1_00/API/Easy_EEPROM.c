@@ -33,62 +33,187 @@ void `$INSTANCE_NAME`_Start(void)
     CySetTemp();
 }
 
-void `$INSTANCE_NAME`_WriteByte(uint8 value, uint16 address)
+// RAM copy of one EEPROM row.  Writes are staged here so that every byte landing in the same row
+// costs a single row program, and bytes that already hold the value do not cost one at all.
+static uint8 `$INSTANCE_NAME`_shadow[`$INSTANCE_NAME`_EEPROM_ROW_SIZE];
+static uint16 `$INSTANCE_NAME`_shadowRow = `$INSTANCE_NAME`_NO_ROW;
+static uint8 `$INSTANCE_NAME`_shadowDirty = 0u;
+
+// in async mode the last row program of a write is left running on the SPC
+static uint8 `$INSTANCE_NAME`_async = 0u;
+static uint8 `$INSTANCE_NAME`_programming = 0u;
+
+// wait for a row program still running on the SPC, then release the SPC
+static void `$INSTANCE_NAME`_WaitProgram(void)
 {
-    uint8 row, offset;
-    cystatus status;
-    
-    if(address < `$INSTANCE_NAME`_EEPROM_SIZE)
+    if(`$INSTANCE_NAME`_programming)
     {
-        // calculate the row, and offset within the row
-        row = address / `$INSTANCE_NAME`_EEPROM_ROW_SIZE;
-        offset = address - ((uint16)row*(uint16)`$INSTANCE_NAME`_EEPROM_ROW_SIZE);
-        
-        // Turn on the SPC
+        while(CY_SPC_BUSY)
+        {
+            /* Wait until SPC becomes idle */
+        }
+        CySpcUnlock();
+        CySpcStop();
+        `$INSTANCE_NAME`_programming = 0u;
+    }
+}
+
+static void `$INSTANCE_NAME`_LoadShadow(uint16 row)
+{
+    uint16 i;
+
+    for(i = 0u; i < `$INSTANCE_NAME`_EEPROM_ROW_SIZE; i++)
+    {
+        `$INSTANCE_NAME`_shadow[i] = ((reg8 *) `$INSTANCE_NAME`_EEPROM_BASE_ADDRESS)[row * `$INSTANCE_NAME`_EEPROM_ROW_SIZE + i];
+    }
+    `$INSTANCE_NAME`_shadowRow = row;
+    `$INSTANCE_NAME`_shadowDirty = 0u;
+}
+
+// program the shadow into its row, if anything in it changed
+static cystatus `$INSTANCE_NAME`_ProgramShadow(void)
+{
+    cystatus status = CYRET_SUCCESS;
+
+    if(`$INSTANCE_NAME`_shadowDirty)
+    {
+        `$INSTANCE_NAME`_WaitProgram();
+
+        // Turn on the SPC and lock it to prevent some other process from using it
         CySpcStart();
-        
-        // lock the spc to prevent some other process from using it
         CySpcLock();
 
-        // loads a byte of data into the temporary SPC write buffer.  Write the byte into the proper offset
-        // in the temporary SPC buffer.  The offset is an artifact of the "row" oriented write operations of
-        // our EEPROM and flash.  The load multibyte SPC function loads the temporary "row" with the data we intend
-        // to write.  later, this temporary row is written into the proper "row" with another function call.
-        // to place the byte where we want it, we have to calculate the destination row, and offset within that
-        // row.
-        if(CySpcLoadMultiByte(CY_SPC_FIRST_EE_ARRAYID, offset, &value, `$INSTANCE_NAME`_SPC_BYTE_WRITE_SIZE) == CYRET_STARTED)
+        // load the whole row into the temporary SPC write buffer, then tell the SPC to write the
+        // temporary row into the EEPROM.  Loading the full row means the bytes we did not touch
+        // are written back with their current value.
+        status = CYRET_UNKNOWN;
+        if(CySpcLoadMultiByte(CY_SPC_FIRST_EE_ARRAYID, 0u, `$INSTANCE_NAME`_shadow, `$INSTANCE_NAME`_EEPROM_ROW_SIZE) == CYRET_STARTED)
         {
             while(CY_SPC_BUSY)
             {
                 /* Wait until SPC becomes idle */
             }
 
-            // this is where we tell the SPC to write the write the temporary row into the EEPROM.
-            if(CySpcWriteRow(CY_SPC_FIRST_EE_ARRAYID, row, dieTemperature[0], dieTemperature[1]) == CYRET_STARTED)
+            if(CySpcWriteRow(CY_SPC_FIRST_EE_ARRAYID, `$INSTANCE_NAME`_shadowRow, dieTemperature[0], dieTemperature[1]) == CYRET_STARTED)
             {
-                while(CY_SPC_BUSY)
-                {
-                    /* Wait until SPC becomes idle */
-                }
+                status = CYRET_SUCCESS;
             }
         }
 
-        /* Unlock the SPC so someone else can use it. */
-        CySpcUnlock();
-            
-            
-        // turn off the SPC
-        CySpcStop();
+        if(status == CYRET_SUCCESS)
+        {
+            `$INSTANCE_NAME`_shadowDirty = 0u;
+            `$INSTANCE_NAME`_programming = 1u;
+            if(!`$INSTANCE_NAME`_async)
+            {
+                `$INSTANCE_NAME`_WaitProgram();
+            }
+        }
+        else
+        {
+            /* Unlock the SPC so someone else can use it, and turn it off */
+            CySpcUnlock();
+            CySpcStop();
+        }
+    }
+    return status;
+}
+
+// writes count bytes starting at address.  Each row touched is programmed once, rows whose contents
+// do not change are not programmed.  In async mode the call returns while the last row is still being
+// programmed - use IsBusy() or Flush() before relying on it.
+cystatus `$INSTANCE_NAME`_WriteBlock(const uint8 *data, uint16 address, uint16 count)
+{
+    uint16 row, offset;
+    cystatus status = CYRET_SUCCESS;
+
+    if((count > `$INSTANCE_NAME`_EEPROM_SIZE) || (address > (`$INSTANCE_NAME`_EEPROM_SIZE - count)))
+    {
+        return CYRET_BAD_PARAM;
+    }
+
+    while((count > 0u) && (status == CYRET_SUCCESS))
+    {
+        // calculate the row, and offset within the row
+        row = address / `$INSTANCE_NAME`_EEPROM_ROW_SIZE;
+        offset = address - (row * `$INSTANCE_NAME`_EEPROM_ROW_SIZE);
+
+        if(row != `$INSTANCE_NAME`_shadowRow)
+        {
+            // done with the previous row.  The EEPROM cannot be read while the SPC programs it.
+            status = `$INSTANCE_NAME`_ProgramShadow();
+            if(status != CYRET_SUCCESS)
+            {
+                break;
+            }
+            `$INSTANCE_NAME`_WaitProgram();
+            `$INSTANCE_NAME`_LoadShadow(row);
+        }
+
+        if(`$INSTANCE_NAME`_shadow[offset] != *data)
+        {
+            `$INSTANCE_NAME`_shadow[offset] = *data;
+            `$INSTANCE_NAME`_shadowDirty = 1u;
+        }
+        data++;
+        address++;
+        count--;
+    }
+
+    if(status == CYRET_SUCCESS)
+    {
+        status = `$INSTANCE_NAME`_ProgramShadow();
+    }
+    return status;
+}
+
+void `$INSTANCE_NAME`_WriteByte(uint8 value, uint16 address)
+{
+    (void)`$INSTANCE_NAME`_WriteBlock(&value, address, 1u);
+}
+
+// with async enabled, WriteBlock starts the last row program and returns without waiting for it
+void `$INSTANCE_NAME`_SetAsync(uint8 enable)
+{
+    if(!enable)
+    {
+        (void)`$INSTANCE_NAME`_Flush();
+    }
+    `$INSTANCE_NAME`_async = enable;
+}
+
+// 1 while an async row program is running
+uint8 `$INSTANCE_NAME`_IsBusy(void)
+{
+    if(`$INSTANCE_NAME`_programming && !CY_SPC_BUSY)
+    {
+        `$INSTANCE_NAME`_WaitProgram();
     }
+    return `$INSTANCE_NAME`_programming;
+}
+
+// programs anything still staged and waits until the SPC is done
+cystatus `$INSTANCE_NAME`_Flush(void)
+{
+    cystatus status = `$INSTANCE_NAME`_ProgramShadow();
+
+    `$INSTANCE_NAME`_WaitProgram();
+    return status;
 }
 
 uint8 `$INSTANCE_NAME`_ReadByte(uint16 address)
 {
+    // the EEPROM cannot be read while the SPC programs it
+    `$INSTANCE_NAME`_WaitProgram();
     return (uint8)((reg8 *) `$INSTANCE_NAME`_EEPROM_BASE_ADDRESS)[address];
 }
 
 void `$INSTANCE_NAME`_Stop(void)
 {      
+    // let an async write finish, and forget the shadow since the EEPROM may change behind our back
+    (void)`$INSTANCE_NAME`_Flush();
+    `$INSTANCE_NAME`_shadowRow = `$INSTANCE_NAME`_NO_ROW;
+    
     // turn off the EEPROM in the power manager.  you will no longer be able to read the contets of the eerprom
     #if (CY_PSOC3 || CY_PSOC5LP)
     CyEEPROM_Stop();
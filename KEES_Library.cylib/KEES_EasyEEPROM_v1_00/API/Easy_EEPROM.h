@@ -24,11 +24,22 @@
 #define `$INSTANCE_NAME`_EEPROM_ROW_SIZE CYDEV_EEPROM_ROW_SIZE
 #define `$INSTANCE_NAME`_SPC_BYTE_WRITE_SIZE     0x01u
 
+// no row held in the RAM shadow
+#define `$INSTANCE_NAME`_NO_ROW     0xFFFFu
+
 void `$INSTANCE_NAME`_Start(void);
 void `$INSTANCE_NAME`_Stop(void);
 void `$INSTANCE_NAME`_WriteByte(uint8 value, uint16 address);
 uint8 `$INSTANCE_NAME`_ReadByte(uint16 address);
+cystatus `$INSTANCE_NAME`_WriteBlock(const uint8 *data, uint16 address, uint16 count);
+void `$INSTANCE_NAME`_SetAsync(uint8 enable);
+uint8 `$INSTANCE_NAME`_IsBusy(void);
+cystatus `$INSTANCE_NAME`_Flush(void);
 #define `$INSTANCE_NAME`_UpdateTemp() `$INSTANCE_NAME`_Start()
 
+// write a whole variable or struct, e.g. `$INSTANCE_NAME`_WriteStruct(settings, 0x10)
+#define `$INSTANCE_NAME`_WriteStruct(s, address) \
+    `$INSTANCE_NAME`_WriteBlock((const uint8 *)&(s), (address), (uint16)sizeof(s))
+
 #endif
 //[] END OF FILE
@@ -0,0 +1,294 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <string.h>
+#include <device.h>
+#include "AnimStore.h"
+#include "Timebase.h"
+#include "Telemetry.h"
+
+/* Longest wait for the refresh ISR to start a new frame before a row write */
+#define ANIM_FRAME_WAIT_MS			10u
+
+/* Bytes of one pixel row in 'matrix' */
+#define ANIM_ROW_SIZE				(MATRIX_ROW_BYTES * sizeof(color))
+
+/* The container lives in this row-aligned const array, so the linker keeps
+ * code and data out of it. It is only ever read through ANIM_FLASH - the
+ * compiler must not fold reads into the zero initialiser.
+ */
+static const uint8 animStoreFlash[ANIM_STORE_SIZE] CY_ALIGN(CY_FLASH_SIZEOF_ROW) = {0u};
+#define ANIM_FLASH					((const volatile uint8 *)animStoreFlash)
+
+static uint8 playing = 0;
+static uint16 playFrame = 0;
+static uint16 frameCount = 0;
+static uint32 containerSize = 0;
+static uint32 playOffset = 0;
+static uint32 nextFrameTime = 0;
+
+/* The row a frame is being decoded into, copied back to 'matrix' in one go
+ * once the ops move past it, so the refresh never shows a row half old and
+ * half new. There is no RAM for a whole back buffer.
+ */
+static uint8 stage[ANIM_ROW_SIZE];
+static uint8 *stageFrame;
+static uint16 stageStart;		/* offset of the staged row in the frame */
+static uint8 stageLoaded;
+static uint8 stageFromBlack;	/* frame 0: every row starts out black */
+
+static uint16 read16(uint32 offset)
+{
+	return (uint16)ANIM_FLASH[offset] | ((uint16)ANIM_FLASH[offset + 1u] << 8);
+}
+
+static uint32 read32(uint32 offset)
+{
+	return (uint32)read16(offset) | ((uint32)read16(offset + 2u) << 16);
+}
+
+/*******************************************************************************
+* Function Name: animValid
+********************************************************************************
+*
+* Summary:
+*  Checks that flash holds a container this firmware can play
+*
+* Return:
+*   1 if valid, 0 otherwise
+*
+*******************************************************************************/
+uint8 animValid(void)
+{
+	uint32 size = read32(12u);
+
+#if LED_MATRIX_PALETTE
+	/* frames are bit planes, and 'matrix' only holds the rows being refreshed */
+	(void)size;
+	return 0;
+#else
+	return (ANIM_FLASH[0] == 'G') && (ANIM_FLASH[1] == 'T') &&
+		   (ANIM_FLASH[2] == 'A') && (ANIM_FLASH[3] == 'N') &&
+		   (ANIM_FLASH[4] == ANIM_VERSION) && (ANIM_FLASH[5] == 5u) &&
+		   (read16(6u) == sizeof(matrix)) && (read16(8u) != 0u) &&
+		   (size > ANIM_HEADER_SIZE) && (size <= ANIM_STORE_SIZE);
+#endif
+}
+
+void animPlayStart(void)
+{
+	playing = animValid();
+	frameCount = read16(8u);
+	containerSize = read32(12u);
+	playFrame = 0;
+	playOffset = ANIM_HEADER_SIZE;
+	nextFrameTime = timebaseMillis();
+}
+
+/* Stages the row holding frame byte 'pos'. The staged row goes back first;
+ * from black, the rows passed over on the way are cleared one at a time.
+ */
+static void stageRow(uint16 pos)
+{
+	if(stageLoaded)
+	{
+		memcpy(stageFrame + stageStart, stage, ANIM_ROW_SIZE);
+		stageStart += ANIM_ROW_SIZE;
+	}
+	while((uint16)(pos - stageStart) >= ANIM_ROW_SIZE)
+	{
+		if(stageFromBlack)
+		{
+			memset(stageFrame + stageStart, 0, ANIM_ROW_SIZE);
+		}
+		stageStart += ANIM_ROW_SIZE;
+	}
+	if(stageFromBlack)
+	{
+		memset(stage, 0, ANIM_ROW_SIZE);
+	}
+	else
+	{
+		memcpy(stage, stageFrame + stageStart, ANIM_ROW_SIZE);
+	}
+	stageLoaded = 1;
+}
+
+static void stageByte(uint16 pos, uint8 value)
+{
+	if(!stageLoaded || ((uint16)(pos - stageStart) >= ANIM_ROW_SIZE))
+	{
+		stageRow(pos);
+	}
+	stage[pos - stageStart] = value;
+}
+
+/* Applies one frame's ops straight from flash onto the frame buffer, one
+ * staged row at a time; frame 0 starts from black. Ops that would run past
+ * the end of the buffer are clipped.
+ */
+static void decodeFrame(uint32 src, uint16 len, uint8 *dst, uint8 fromBlack)
+{
+	uint16 pos = 0, end = sizeof(matrix);
+	uint8 op, n, value;
+
+	stageFrame = dst;
+	stageStart = 0;
+	stageLoaded = 0;
+	stageFromBlack = fromBlack;
+
+	while((len > 0u) && (pos < end))
+	{
+		op = ANIM_FLASH[src++];
+		len--;
+
+		if(op < ANIM_OP_LITERAL)
+		{
+			pos += op + 1u;
+		}
+		else if(op < ANIM_OP_REPEAT)
+		{
+			n = (op & 0x3Fu) + 1u;
+			if(n > len)
+			{
+				n = (uint8)len;
+			}
+			len -= n;
+			while(n-- > 0u)
+			{
+				value = ANIM_FLASH[src++];
+				if(pos < end)
+				{
+					stageByte(pos++, value);
+				}
+			}
+		}
+		else
+		{
+			n = (op & 0x3Fu) + 1u;
+			if(len == 0u)
+			{
+				break;
+			}
+			value = ANIM_FLASH[src++];
+			len--;
+			while((n-- > 0u) && (pos < end))
+			{
+				stageByte(pos++, value);
+			}
+		}
+	}
+
+	/* the last staged row, and from black whatever the ops never reached */
+	if(stageLoaded)
+	{
+		memcpy(dst + stageStart, stage, ANIM_ROW_SIZE);
+		stageStart += ANIM_ROW_SIZE;
+	}
+	if(fromBlack)
+	{
+		for(; stageStart < end; stageStart += ANIM_ROW_SIZE)
+		{
+			memset(dst + stageStart, 0, ANIM_ROW_SIZE);
+		}
+	}
+}
+
+/*******************************************************************************
+* Function Name: animPlayService
+********************************************************************************
+*
+* Summary:
+*  Decodes the next frame into 'matrix' once the current one has been on
+*  screen for its duration, a row at a time so no row shows half a frame. Call every main loop pass while in playback mode.
+*
+* Parameters:
+* 	color *matrix: 	pointer to the matrix buffer
+*
+*******************************************************************************/
+void animPlayService(color *matrix)
+{
+	uint32 now = timebaseMillis();
+	uint16 duration, len;
+
+	if(!playing || ((int32)(now - nextFrameTime) < 0))
+	{
+		return;
+	}
+
+	/* a frame, header included, must lie within the container */
+	if((playOffset + ANIM_FRAME_HEADER_SIZE) > containerSize)
+	{
+		playing = 0;
+		return;
+	}
+	duration = read16(playOffset);
+	len = read16(playOffset + 2u);
+	if((playOffset + ANIM_FRAME_HEADER_SIZE + len) > containerSize)
+	{
+		playing = 0;
+		return;
+	}
+
+	TELEMETRY_STAMP(decodeStart);
+	decodeFrame(playOffset + ANIM_FRAME_HEADER_SIZE, len, (uint8 *)matrix, playFrame == 0u);
+	TELEMETRY_RECORD(TLM_STAT_ANIM_DECODE, decodeStart);
+
+	/* Keep the timeline unless we fell more than a frame behind */
+	nextFrameTime += duration;
+	if((int32)(now - nextFrameTime) > (int32)duration)
+	{
+		nextFrameTime = now + duration;
+	}
+
+	playOffset += ANIM_FRAME_HEADER_SIZE + len;
+	playFrame++;
+	if(playFrame >= frameCount)
+	{
+		playFrame = 0;
+		playOffset = ANIM_HEADER_SIZE;
+	}
+}
+
+/*******************************************************************************
+* Function Name: animWriteRow
+********************************************************************************
+*
+* Summary:
+*  Programs one 128-byte row of the container. Playback stops, since the
+*  container is inconsistent until the host has written every row.
+*  Waits for the start of a refresh frame, then blocks (and stalls the
+*  refresh ISR) for the duration of the row write.
+*
+* Parameters:
+*   uint16 row: 		row within the container, 0 to ANIM_STORE_ROWS-1
+*	uint8 *rowData:		CY_FLASH_SIZEOF_ROW bytes in RAM
+*
+* Return:
+*   CySysFlashWriteRow() status
+*
+*******************************************************************************/
+cystatus animWriteRow(uint16 row, const uint8 *rowData)
+{
+	uint32 flashRow = (((uint32)animStoreFlash - CY_FLASH_BASE) / CY_FLASH_SIZEOF_ROW) + row;
+
+	if(row >= ANIM_STORE_ROWS)
+	{
+		return CYRET_BAD_PARAM;
+	}
+
+	playing = 0;
+	waitFrameStart(ANIM_FRAME_WAIT_MS);
+	return CySysFlashWriteRow(flashRow, rowData);
+}
+
+/* [] END OF FILE */
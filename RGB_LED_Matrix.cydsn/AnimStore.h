@@ -0,0 +1,60 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef AnimStore_h_
+#define AnimStore_h_
+#include <device.h>
+#include <LED_Matrix.h>
+
+/*******************************************************************************
+* Animation container, stored in spare flash (all fields little endian)
+*
+*  Header (16 bytes):
+*   0  'G','T','A','N'
+*   4  uint8  version (ANIM_VERSION)
+*   5  uint8  bit planes per color (5)
+*   6  uint16 bytes per frame - must equal sizeof(matrix)
+*   8  uint16 frame count
+*   10 uint16 reserved (0)
+*   12 uint32 total container size in bytes, header included
+*
+*  Then per frame:
+*   uint16 duration in ms
+*   uint16 payload length
+*   payload - a stream of ops applied to the 'matrix' bytes in memory order,
+*             relative to the previous frame (frame 0 starts from black):
+*     0x00-0x7F: skip n+1 bytes (unchanged)
+*     0x80-0xBF: n+1 literal bytes follow
+*     0xC0-0xFF: repeat the next byte n+1 times
+********************************************************************************/
+#define ANIM_VERSION				1u
+#define ANIM_HEADER_SIZE			16u
+#define ANIM_FRAME_HEADER_SIZE		4u
+
+#define ANIM_OP_SKIP				0x00u
+#define ANIM_OP_LITERAL				0x80u
+#define ANIM_OP_REPEAT				0xC0u
+
+/* Flash rows reserved for the container (128 bytes each). They come out of
+ * the 32 KB shared with the code, so the default of 2 KB only holds a short
+ * delta coded clip; raise it for longer ones (and STORE_ROWS in
+ * ProcessingCodeAnimation.txt with it).
+ */
+#define ANIM_STORE_ROWS				16u
+#define ANIM_STORE_SIZE				(ANIM_STORE_ROWS * CY_FLASH_SIZEOF_ROW)
+
+uint8 animValid(void);
+void animPlayStart(void);
+void animPlayService(color *matrix);
+cystatus animWriteRow(uint16 row, const uint8 *rowData);
+
+#endif
+//[] END OF FILE
@@ -0,0 +1,171 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include "Buttons.h"
+#include "Timebase.h"
+
+/* Edges captured by the ISR - written at edgeHead, read at edgeTail */
+static uint32 edgeTime[BUTTON_EDGE_QUEUE];
+static uint8 edgeLevel[BUTTON_EDGE_QUEUE];
+static volatile uint8 edgeHead = 0;
+static volatile uint8 edgeTail = 0;
+
+static uint8 events[BUTTON_EVENT_QUEUE];
+static uint8 eventHead = 0;
+static uint8 eventTail = 0;
+
+/* Debounce and gesture state */
+static uint8 rawPressed = 0;
+static uint32 rawTime = 0;
+static uint8 pressed = 0;
+static uint8 longSent = 0;
+static uint8 secondPress = 0;
+static uint8 waitDouble = 0;
+static uint32 pressTime = 0;
+static uint32 releaseTime = 0;
+
+/*******************************************************************************
+* Function Name: buttonEdge
+********************************************************************************
+*
+* Summary:
+*  Call from the PB interrupt. Records the time and pin level of the edge and
+*  nothing else; a full queue drops the edge.
+*
+*******************************************************************************/
+void buttonEdge(void)
+{
+	uint8 next = (edgeHead + 1u) & (BUTTON_EDGE_QUEUE - 1u);
+
+	if(next != edgeTail)
+	{
+		edgeTime[edgeHead] = timebaseMillis();
+		edgeLevel[edgeHead] = (BUTTON_READ() == BUTTON_PRESSED_LEVEL);
+		edgeHead = next;
+	}
+}
+
+static void putEvent(uint8 event)
+{
+	uint8 next = (eventHead + 1u) & (BUTTON_EVENT_QUEUE - 1u);
+
+	if(next != eventTail)
+	{
+		events[eventHead] = event;
+		eventHead = next;
+	}
+}
+
+/*******************************************************************************
+* Function Name: buttonProcess
+********************************************************************************
+*
+* Summary:
+*  Feeds one level sample into the debounce and gesture state machine. Samples
+*  must come in time order. No hardware access.
+*
+* Parameters:
+*   uint32 now:		sample time in ms
+*	uint8 level:	1 if the button reads pressed
+*
+*******************************************************************************/
+void buttonProcess(uint32 now, uint8 level)
+{
+	if(level != rawPressed)
+	{
+		rawPressed = level;
+		rawTime = now;
+	}
+
+	if((rawPressed != pressed) && ((now - rawTime) >= BUTTON_DEBOUNCE_MS))
+	{
+		pressed = rawPressed;
+		if(pressed)
+		{
+			pressTime = now;
+			longSent = 0;
+			secondPress = waitDouble;
+			waitDouble = 0;
+		}
+		else if(longSent)
+		{
+			/* already reported */
+		}
+		else if(secondPress)
+		{
+			putEvent(BUTTON_EVENT_DOUBLE);
+		}
+		else if(BUTTON_DOUBLE_MS == 0u)
+		{
+			putEvent(BUTTON_EVENT_SHORT);
+		}
+		else
+		{
+			waitDouble = 1;
+			releaseTime = now;
+		}
+	}
+
+	if(pressed && !longSent && !secondPress && ((now - pressTime) >= BUTTON_LONG_MS))
+	{
+		longSent = 1;
+		putEvent(BUTTON_EVENT_LONG);
+	}
+
+	if(waitDouble && ((now - releaseTime) >= BUTTON_DOUBLE_MS))
+	{
+		waitDouble = 0;
+		putEvent(BUTTON_EVENT_SHORT);
+	}
+}
+
+/*******************************************************************************
+* Function Name: buttonService
+********************************************************************************
+*
+* Summary:
+*  Replays the edges queued by the ISR, then samples the pin. Call every main
+*  loop pass.
+*
+*******************************************************************************/
+void buttonService(void)
+{
+	while(edgeTail != edgeHead)
+	{
+		buttonProcess(edgeTime[edgeTail], edgeLevel[edgeTail]);
+		edgeTail = (edgeTail + 1u) & (BUTTON_EDGE_QUEUE - 1u);
+	}
+	buttonProcess(timebaseMillis(), (BUTTON_READ() == BUTTON_PRESSED_LEVEL));
+}
+
+/*******************************************************************************
+* Function Name: buttonGetEvent
+********************************************************************************
+*
+* Return:
+*   Oldest queued BUTTON_EVENT_*, BUTTON_EVENT_NONE if there is none
+*
+*******************************************************************************/
+uint8 buttonGetEvent(void)
+{
+	uint8 event = BUTTON_EVENT_NONE;
+
+	if(eventTail != eventHead)
+	{
+		event = events[eventTail];
+		eventTail = (eventTail + 1u) & (BUTTON_EVENT_QUEUE - 1u);
+	}
+	return event;
+}
+
+/* [] END OF FILE */
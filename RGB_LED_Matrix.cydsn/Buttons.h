@@ -0,0 +1,45 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef Buttons_h_
+#define Buttons_h_
+#include <device.h>
+
+/* The PB interrupt only timestamps edges (buttonEdge). Debounce and gesture
+ * detection run from buttonService in the main loop, which also samples the
+ * pin so releases are seen even though only press edges interrupt.
+ * buttonProcess holds all the timing logic and touches no hardware, so it can
+ * be driven with synthetic (time, level) sequences.
+ */
+#define BUTTON_READ()				P0_2_Read()
+#define BUTTON_PRESSED_LEVEL		0u		/* pulled up, pressed pulls low */
+
+#define BUTTON_DEBOUNCE_MS			30u		/* level must hold this long to count */
+#define BUTTON_LONG_MS				800u	/* held this long -> BUTTON_EVENT_LONG */
+#define BUTTON_DOUBLE_MS			300u	/* second press within this -> BUTTON_EVENT_DOUBLE, 0 disables */
+
+/* Queue lengths, powers of 2 */
+#define BUTTON_EDGE_QUEUE			8u
+#define BUTTON_EVENT_QUEUE			4u
+
+/* Events */
+#define BUTTON_EVENT_NONE			0u
+#define BUTTON_EVENT_SHORT			1u
+#define BUTTON_EVENT_LONG			2u
+#define BUTTON_EVENT_DOUBLE			3u
+
+void buttonEdge(void);
+void buttonService(void);
+void buttonProcess(uint32 now, uint8 pressed);
+uint8 buttonGetEvent(void);
+
+#endif
+//[] END OF FILE
@@ -0,0 +1,383 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <string.h>
+#include <device.h>
+#include "Compositor.h"
+#include "Telemetry.h"
+
+#if COMPOSITOR_ENABLE
+
+typedef struct
+{
+	uint8 *pixels;
+	const RGB *palette;
+	uint8 bpp;
+	uint8 key;
+	uint8 flags;
+	uint8 visible;
+	int8 top;
+	uint8 rows;
+	uint8 dirty[LAYER_DIRTY_BYTES];		/* canvas row y is bit y%8 of byte y/8 */
+} Layer;
+
+static Layer layers[COMPOSITOR_LAYERS];
+static uint8 lastFrame = 0;
+#if CANVAS_ROW_LANES
+/* Scratch row the layers are stacked on before it goes to 'matrix' */
+static color stage[MATRIX_ROW_BYTES];
+#endif
+
+/* Marks the canvas row showing layer row r */
+static void markRow(Layer *l, int16 r)
+{
+	int16 y = l->top + ((l->flags & LAYER_ROTATE_180) ? l->rows - 1 - r : r);
+
+	if((y >= 0) && (y < CANVAS_HEIGHT))
+	{
+		l->dirty[y >> 3] |= (uint8)(1u << (y & 7));
+	}
+}
+
+static void markAll(Layer *l)
+{
+	int16 r;
+
+	for(r = 0; r < l->rows; r++)
+	{
+		markRow(l, r);
+	}
+}
+
+/* Unchecked */
+static void putValue(Layer *l, int16 x, int16 y, uint8 v)
+{
+	uint8 *p;
+
+	if(l->bpp == LAYER_1BPP)
+	{
+		p = &l->pixels[y * LAYER_STRIDE(LAYER_1BPP) + (x >> 3)];
+		*p = (v & 1u) ? (*p | (uint8)(1u << (x & 7))) : (*p & (uint8)~(1u << (x & 7)));
+	}
+	else
+	{
+		p = &l->pixels[y * LAYER_STRIDE(LAYER_4BPP) + (x >> 1)];
+		*p = (x & 1) ? ((*p & 0x0Fu) | (uint8)(v << 4)) : ((*p & 0xF0u) | (v & 0x0Fu));
+	}
+}
+
+static uint8 valueAt(const Layer *l, const uint8 *row, int16 x)
+{
+	if(l->bpp == LAYER_1BPP)
+	{
+		return (row[x >> 3] >> (x & 7)) & 1u;
+	}
+	return (row[x >> 1] >> ((x & 1) * 4)) & 0x0Fu;
+}
+
+/*******************************************************************************
+* Function Name: layerInit
+********************************************************************************
+*
+* Summary:
+*  Sets up layer n, visible. The pixels keep whatever the buffer holds, so
+*  follow with layerClear() unless it is already drawn.
+*
+* Parameters:
+*   uint8 n:			LAYER_BACKGROUND, LAYER_CONTENT or LAYER_OVERLAY
+*	uint8 bpp:			LAYER_1BPP or LAYER_4BPP
+*	uint8 *pixels:		LAYER_BYTES(bpp, rows) bytes
+*	int8 top:			canvas row of the top of the band
+*	uint8 rows:			rows in the band
+*	RGB *palette:		color of each pixel value, kept by reference
+*	uint8 key:			transparent value, LAYER_NO_KEY for an opaque band
+*	uint8 flags:		LAYER_ROTATE_180
+*
+*******************************************************************************/
+void layerInit(uint8 n, uint8 bpp, uint8 *pixels, int8 top, uint8 rows, const RGB *palette, uint8 key, uint8 flags)
+{
+	Layer *l = &layers[n];
+
+	markAll(l);
+	l->pixels = pixels;
+	l->palette = palette;
+	l->bpp = bpp;
+	l->key = key;
+	l->flags = flags;
+	l->visible = 1;
+	l->top = top;
+	l->rows = rows;
+	markAll(l);
+}
+
+void layerShow(uint8 n, uint8 visible)
+{
+	if(layers[n].visible != visible)
+	{
+		layers[n].visible = visible;
+		markAll(&layers[n]);
+	}
+}
+
+/* Repaints all of layer n, after a change to its palette */
+void layerTouch(uint8 n)
+{
+	markAll(&layers[n]);
+}
+
+void layerClear(uint8 n, uint8 v)
+{
+	Layer *l = &layers[n];
+	uint8 fill = (l->bpp == LAYER_1BPP) ? (uint8)(0u - (v & 1u)) : (uint8)((v & 0x0Fu) * 0x11u);
+	uint16 i;
+
+	for(i = 0; i < LAYER_STRIDE(l->bpp) * l->rows; i++)
+	{
+		l->pixels[i] = fill;
+	}
+	markAll(l);
+}
+
+void layerPixel(uint8 n, int8 x, int8 y, uint8 v)
+{
+	Layer *l = &layers[n];
+
+	if((x >= 0) && (x < CANVAS_WIDTH) && (y >= 0) && (y < l->rows))
+	{
+		putValue(l, x, y, v);
+		markRow(l, y);
+	}
+}
+
+/* w x h pixels from (x,y), clipped to the layer */
+void layerFillRect(uint8 n, int8 x, int8 y, int8 w, int8 h, uint8 v)
+{
+	Layer *l = &layers[n];
+	int16 left = (x < 0) ? 0 : x, right = (int16)x + w - 1;
+	int16 top = (y < 0) ? 0 : y, bottom = (int16)y + h - 1, k;
+
+	if(right >= CANVAS_WIDTH)
+	{
+		right = CANVAS_WIDTH - 1;
+	}
+	if(bottom >= l->rows)
+	{
+		bottom = l->rows - 1;
+	}
+	for(; top <= bottom; top++)
+	{
+		for(k = left; k <= right; k++)
+		{
+			putValue(l, k, top, v);
+		}
+		markRow(l, top);
+	}
+}
+
+/* Set bits of a 1bpp sprite take value v, clear bits leave the layer alone */
+void layerSprite1(uint8 n, int8 x, int8 y, const Sprite *s, uint8 v)
+{
+	Layer *l = &layers[n];
+	uint8 stride = (s->width + 7u) / 8u;
+	int16 r, k;
+	const uint8 *src;
+
+	for(r = 0; r < s->height; r++)
+	{
+		if((y + r < 0) || (y + r >= l->rows))
+		{
+			continue;
+		}
+		src = &s->data[r * stride];
+		for(k = 0; k < s->width; k++)
+		{
+			if((src[k >> 3] & (1u << (k & 7))) && (x + k >= 0) && (x + k < CANVAS_WIDTH))
+			{
+				putValue(l, x + k, y + r, v);
+			}
+		}
+		markRow(l, y + r);
+	}
+}
+
+/* drawString() into layer n: returns the pen position after the last glyph */
+int16 layerString(uint8 n, int8 x, int8 y, const char8 *s, const Font *f, uint8 v)
+{
+	Sprite glyph;
+	int16 pen = x;
+
+	for(; (*s != 0) && (pen < CANVAS_WIDTH); s++)
+	{
+		fontGlyph(f, *s, &glyph);
+		if(pen > -(int16)FONT_MAX_GLYPH_WIDTH)
+		{
+			layerSprite1(n, (int8)pen, y, &glyph, v);
+		}
+		pen += glyph.width;
+		if(s[1] != 0)
+		{
+			pen += fontGap(f, s[0], s[1]);
+		}
+	}
+	return pen;
+}
+
+/* Repaints every layer on its next compositorService() */
+void compositorRefresh(void)
+{
+	uint8 n;
+
+	for(n = 0; n < COMPOSITOR_LAYERS; n++)
+	{
+		markAll(&layers[n]);
+	}
+}
+
+/* Canvas row y of layer l, one span per run of equal pixels */
+static void paintRow(const Layer *l, int16 y, color *matrix)
+{
+	uint8 perByte, v, fill;
+	int16 r = y - l->top, x, start;
+	const uint8 *row;
+
+	if(!l->visible || (r < 0) || (r >= l->rows))
+	{
+		return;
+	}
+	perByte = 8u / l->bpp;
+	if(l->flags & LAYER_ROTATE_180)
+	{
+		r = l->rows - 1 - r;
+	}
+	row = &l->pixels[r * LAYER_STRIDE(l->bpp)];
+
+	for(x = 0; x < CANVAS_WIDTH; )
+	{
+		v = valueAt(l, row, x);
+		fill = (l->bpp == LAYER_1BPP) ? (uint8)(0u - v) : (uint8)(v * 0x11u);
+		start = x;
+		for(x++; x < CANVAS_WIDTH; )
+		{
+			/* whole bytes of the same value at once */
+			if(((x % perByte) == 0) && (row[x / perByte] == fill))
+			{
+				x += perByte;
+			}
+			else if(valueAt(l, row, x) == v)
+			{
+				x++;
+			}
+			else
+			{
+				break;
+			}
+		}
+		if(v == l->key)
+		{
+			continue;
+		}
+		if(l->flags & LAYER_ROTATE_180)
+		{
+			drawFastHLine((int8)(CANVAS_WIDTH - x), (int8)y, (int8)(x - 1 - start), l->palette[v], matrix);
+		}
+		else
+		{
+			drawFastHLine((int8)start, (int8)y, (int8)(x - 1 - start), l->palette[v], matrix);
+		}
+	}
+}
+
+/*******************************************************************************
+* Function Name: compositorService
+********************************************************************************
+*
+* Summary:
+*  Once per refresh frame, at the first call after it wraps to row 0,
+*  recomposes the rows any layer marked dirty: each is cleared on a scratch
+*  row, the layers are painted over it bottom up, and it is copied into
+*  'matrix' in one go, so the refresh never shows it black or half painted.
+*  Each layer's share is timed as TLM_STAT_LAYER0 + n. Call from the main
+*  loop while a mode shows the layers.
+*
+* Parameters:
+* 	color *matrix: 	pointer to the matrix buffer
+*
+*******************************************************************************/
+void compositorService(color *matrix)
+{
+	static const RGB black = {0u, 0u, 0u};
+	uint8 rows[LAYER_DIRTY_BYTES], any = 0, n, i;
+	int16 y;
+	color *dst = matrix;
+#if TELEMETRY_ENABLE
+	uint32 cycles[COMPOSITOR_LAYERS] = {0}, t;
+#endif
+
+	if(refreshFrames == lastFrame)
+	{
+		return;
+	}
+	lastFrame = refreshFrames;
+
+	for(i = 0; i < LAYER_DIRTY_BYTES; i++)
+	{
+		rows[i] = 0;
+		for(n = 0; n < COMPOSITOR_LAYERS; n++)
+		{
+			rows[i] |= layers[n].dirty[i];
+			layers[n].dirty[i] = 0;
+		}
+		any |= rows[i];
+	}
+	if(any == 0u)
+	{
+		return;
+	}
+
+	for(y = 0; y < CANVAS_HEIGHT; y++)
+	{
+		if(!(rows[y >> 3] & (1u << (y & 7))))
+		{
+			continue;
+		}
+#if CANVAS_ROW_LANES
+		/* the draw calls index lanes from the top of the matrix: this base
+		 * puts row y on the stage
+		 */
+		dst = stage - MATRIX_LANE(0, y);
+#endif
+		drawFastHLine(0, (int8)y, CANVAS_WIDTH - 1, black, dst);
+		for(n = 0; n < COMPOSITOR_LAYERS; n++)
+		{
+#if TELEMETRY_ENABLE
+			t = timebaseCycles();
+#endif
+			paintRow(&layers[n], y, dst);
+#if TELEMETRY_ENABLE
+			cycles[n] += timebaseCycles() - t;
+#endif
+		}
+#if CANVAS_ROW_LANES
+		memcpy(&matrix[MATRIX_LANE(0, y)], stage, sizeof(stage));
+#endif
+	}
+#if TELEMETRY_ENABLE
+	for(n = 0; n < COMPOSITOR_LAYERS; n++)
+	{
+		telemetryRecord(TLM_STAT_LAYER0 + n, cycles[n]);
+	}
+#endif
+}
+
+#endif
+
+/* [] END OF FILE */
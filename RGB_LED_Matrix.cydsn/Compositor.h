@@ -0,0 +1,74 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef Compositor_h_
+#define Compositor_h_
+#include <device.h>
+#include <LED_Matrix.h>
+#include "Font.h"
+
+/* Stacks up to COMPOSITOR_LAYERS small indexed layers into 'matrix', bottom
+ * first, instead of a mode drawing there itself. Leave at 0 when no mode
+ * uses layers. Can be set with -D, as the host tests do.
+ */
+#ifndef COMPOSITOR_ENABLE
+#define COMPOSITOR_ENABLE			0
+#endif
+
+/*******************************************************************************
+* Layer format
+*
+*  A layer is a band of 'rows' full-width rows starting at canvas row 'top',
+*  in a buffer owned by the caller (LAYER_BYTES). Pixels hold a value, 1 or 4
+*  bits each, packed from the least significant bit like the lanes of
+*  'matrix'; the layer's palette gives the color of every value (2 or 16
+*  entries). Pixels equal to the key are transparent, LAYER_NO_KEY makes the
+*  band opaque.
+*
+*  Drawing goes through the layer* functions, in layer coordinates, and marks
+*  the canvas rows it touches dirty. compositorService() repaints just those
+*  rows, one span per run of equal pixels per layer, each on a scratch row
+*  that then replaces the row in 'matrix' whole.
+********************************************************************************/
+#define COMPOSITOR_LAYERS			3u
+#define LAYER_BACKGROUND			0u		/* effect */
+#define LAYER_CONTENT				1u		/* clock, text */
+#define LAYER_OVERLAY				2u		/* banners */
+
+#define LAYER_1BPP					1u
+#define LAYER_4BPP					4u
+#define LAYER_NO_KEY				0xFFu
+
+/* Flags */
+#define LAYER_ROTATE_180			0x01u	/* shown upside down, for panels mounted that way */
+
+#define LAYER_STRIDE(bpp)			(CANVAS_WIDTH * (bpp) / 8u)
+#define LAYER_BYTES(bpp, rows)		(LAYER_STRIDE(bpp) * (rows))
+#define LAYER_DIRTY_BYTES			((CANVAS_HEIGHT + 7u) / 8u)
+
+#if COMPOSITOR_ENABLE
+void layerInit(uint8 n, uint8 bpp, uint8 *pixels, int8 top, uint8 rows, const RGB *palette, uint8 key, uint8 flags);
+void layerShow(uint8 n, uint8 visible);
+void layerTouch(uint8 n);
+void layerClear(uint8 n, uint8 v);
+void layerPixel(uint8 n, int8 x, int8 y, uint8 v);
+void layerFillRect(uint8 n, int8 x, int8 y, int8 w, int8 h, uint8 v);
+void layerSprite1(uint8 n, int8 x, int8 y, const Sprite *s, uint8 v);
+int16 layerString(uint8 n, int8 x, int8 y, const char8 *s, const Font *f, uint8 v);
+void compositorRefresh(void);
+void compositorService(color *matrix);
+#else
+#define compositorRefresh()
+#define compositorService(matrix)
+#endif
+
+#endif
+//[] END OF FILE
@@ -0,0 +1,658 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <string.h>
+#include <device.h>
+#include "DisplayList.h"
+#include "Telemetry.h"
+
+#if DISPLAY_LIST_ENABLE
+
+/* Item types */
+#define DL_FREE					0u
+#define DL_RECT					1u
+#define DL_LINE					2u
+#define DL_TEXT					3u
+#define DL_GLYPH				4u
+#define DL_SPRITE				5u
+#define DL_DIGIT				6u
+
+typedef struct
+{
+	uint8 type;
+	uint8 visible;
+	int8 x;
+	int8 y;
+	int8 x1;				/* rect: width, line: far end, text: width when marked */
+	int8 y1;				/* rect: height */
+	uint8 arg;				/* glyph: character, sprite: SPRITE_FLIP_*, digit: 0-F or DL_DIGIT_COLON */
+	RGB c;
+	const void *data;		/* text: string, sprite: Sprite */
+	const Font *font;
+} DlItem;
+
+static DlItem items[DL_MAX_ITEMS];
+static uint8 dirty[DL_DIRTY_BYTES];
+/* Marked columns, the same span for every marked row; left > right for none */
+static int16 dirtyLeft = CANVAS_WIDTH;
+static int16 dirtyRight = -1;
+static uint8 lastFrame = 0;
+
+#define ROW_DIRTY(y)			(dirty[(y) >> 3] & (1u << ((y) & 7)))
+
+#if CANVAS_ROW_LANES
+static color stage[MATRIX_ROW_BYTES];
+#endif
+
+/* Canvas rows the item covers, top > bottom for none */
+static void itemRows(const DlItem *it, int16 *top, int16 *bottom)
+{
+	*top = it->y;
+	switch(it->type)
+	{
+		case DL_RECT:
+			*bottom = (int16)it->y + it->y1 - 1;
+			break;
+		case DL_LINE:
+			*top = (it->y < it->y1) ? it->y : it->y1;
+			*bottom = (it->y < it->y1) ? it->y1 : it->y;
+			break;
+		case DL_TEXT:
+		case DL_GLYPH:
+			*bottom = (int16)it->y + it->font->height - 1;
+			break;
+		case DL_SPRITE:
+			*bottom = (int16)it->y + ((const Sprite *)it->data)->height - 1;
+			break;
+		case DL_DIGIT:
+			if(it->arg == DL_DIGIT_COLON)
+			{
+				/* the dots only, so the blink redraws just their rows */
+				*top = (int16)it->y + 3;
+				*bottom = (int16)it->y + 8;
+			}
+			else
+			{
+				*bottom = (int16)it->y + DL_DIGIT_HEIGHT - 1;
+			}
+			break;
+		default:
+			*bottom = *top - 1;
+			break;
+	}
+}
+
+/* Canvas columns the item covers, left > right for none */
+static void itemCols(const DlItem *it, int16 *left, int16 *right)
+{
+	Sprite glyph;
+
+	*left = it->x;
+	switch(it->type)
+	{
+		case DL_RECT:
+		case DL_TEXT:
+			*right = (int16)it->x + it->x1 - 1;
+			break;
+		case DL_LINE:
+			*left = (it->x < it->x1) ? it->x : it->x1;
+			*right = (it->x < it->x1) ? it->x1 : it->x;
+			break;
+		case DL_GLYPH:
+			fontGlyph(it->font, (char8)it->arg, &glyph);
+			*right = (int16)it->x + glyph.width - 1;
+			break;
+		case DL_SPRITE:
+			*right = (int16)it->x + ((const Sprite *)it->data)->width - 1;
+			break;
+		case DL_DIGIT:
+			*right = (int16)it->x + ((it->arg == DL_DIGIT_COLON) ? 2 : DL_DIGIT_WIDTH) - 1;
+			break;
+		default:
+			*right = *left - 1;
+			break;
+	}
+}
+
+/* Canvas rows of a visible item, clamped to the canvas; top > bottom for none */
+static void visibleRows(const DlItem *it, int16 *top, int16 *bottom)
+{
+	if((it->type == DL_FREE) || !it->visible)
+	{
+		*top = 0;
+		*bottom = -1;
+		return;
+	}
+	itemRows(it, top, bottom);
+	if(*top < 0)
+	{
+		*top = 0;
+	}
+	if(*bottom >= CANVAS_HEIGHT)
+	{
+		*bottom = CANVAS_HEIGHT - 1;
+	}
+}
+
+/* 1 if a visible item reaches into the marked columns */
+static uint8 inDirtyCols(const DlItem *it)
+{
+	int16 left, right;
+
+	itemCols(it, &left, &right);
+	return (left <= right) && (left <= dirtyRight) && (right >= dirtyLeft);
+}
+
+static void markCols(const DlItem *it)
+{
+	int16 left, right;
+
+	itemCols(it, &left, &right);
+	if(left > right)
+	{
+		return;
+	}
+	dirtyLeft = (left < dirtyLeft) ? left : dirtyLeft;
+	dirtyRight = (right > dirtyRight) ? right : dirtyRight;
+}
+
+static void markItem(const DlItem *it)
+{
+	int16 top, bottom;
+
+	visibleRows(it, &top, &bottom);
+	if(top > bottom)
+	{
+		return;
+	}
+	for(; top <= bottom; top++)
+	{
+		dirty[top >> 3] |= (uint8)(1u << (top & 7));
+	}
+	markCols(it);
+}
+
+static void drawItem(const DlItem *it, color *matrix)
+{
+	Sprite glyph;
+
+	switch(it->type)
+	{
+		case DL_RECT:
+			fillRect(it->x, it->y, it->x1, it->y1, it->c, matrix);
+			break;
+		case DL_LINE:
+			drawLine(it->x, it->y, it->x1, it->y1, it->c, matrix);
+			break;
+		case DL_TEXT:
+			drawString(it->x, it->y, (const char8 *)it->data, it->font, it->c, matrix);
+			break;
+		case DL_GLYPH:
+			fontGlyph(it->font, (char8)it->arg, &glyph);
+			drawSprite1(it->x, it->y, &glyph, it->c, 0, matrix);
+			break;
+		case DL_SPRITE:
+			drawSprite1(it->x, it->y, (const Sprite *)it->data, it->c, it->arg, matrix);
+			break;
+		case DL_DIGIT:
+			if(it->arg == DL_DIGIT_COLON)
+			{
+				drawColon(it->x, it->y, it->c, matrix);
+			}
+			else
+			{
+				drawHex(it->arg, it->x, it->y, it->c, matrix);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/* Width of a text item, int8 like the canvas */
+static int8 textWidth(const char8 *s, const Font *f)
+{
+	int16 w = measureString(s, f);
+
+	return (int8)((w > 127) ? 127 : w);
+}
+
+/* A free slot set up with the common fields, marked; NULL when the list is full */
+static DlItem *newItem(uint8 type, int8 x, int8 y, RGB c, uint8 *handle)
+{
+	uint8 n;
+
+	for(n = 0; n < DL_MAX_ITEMS; n++)
+	{
+		if(items[n].type == DL_FREE)
+		{
+			items[n].type = type;
+			items[n].visible = 1;
+			items[n].x = x;
+			items[n].y = y;
+			items[n].c = c;
+			*handle = n;
+			return &items[n];
+		}
+	}
+	*handle = DL_NO_HANDLE;
+	return NULL;
+}
+
+/*******************************************************************************
+* Function Name: dlRect
+********************************************************************************
+*
+* Summary:
+*  Adds a w x h filled rectangle on top of the list. dlLine, dlText, dlGlyph,
+*  dlSprite and dlDigit do the same for the other item types.
+*
+* Return:
+*   Handle of the item, DL_NO_HANDLE when all DL_MAX_ITEMS are in use
+*
+*******************************************************************************/
+uint8 dlRect(int8 x, int8 y, int8 w, int8 h, RGB c)
+{
+	uint8 handle;
+	DlItem *it = newItem(DL_RECT, x, y, c, &handle);
+
+	if(it != NULL)
+	{
+		it->x1 = w;
+		it->y1 = h;
+		markItem(it);
+	}
+	return handle;
+}
+
+uint8 dlLine(int8 x0, int8 y0, int8 x1, int8 y1, RGB c)
+{
+	uint8 handle;
+	DlItem *it = newItem(DL_LINE, x0, y0, c, &handle);
+
+	if(it != NULL)
+	{
+		it->x1 = x1;
+		it->y1 = y1;
+		markItem(it);
+	}
+	return handle;
+}
+
+uint8 dlText(int8 x, int8 y, const char8 *s, const Font *f, RGB c)
+{
+	uint8 handle;
+	DlItem *it = newItem(DL_TEXT, x, y, c, &handle);
+
+	if(it != NULL)
+	{
+		it->data = s;
+		it->font = f;
+		it->x1 = textWidth(s, f);
+		markItem(it);
+	}
+	return handle;
+}
+
+uint8 dlGlyph(int8 x, int8 y, char8 ch, const Font *f, RGB c)
+{
+	uint8 handle;
+	DlItem *it = newItem(DL_GLYPH, x, y, c, &handle);
+
+	if(it != NULL)
+	{
+		it->arg = (uint8)ch;
+		it->font = f;
+		markItem(it);
+	}
+	return handle;
+}
+
+uint8 dlSprite(int8 x, int8 y, const Sprite *s, uint8 flags, RGB c)
+{
+	uint8 handle;
+	DlItem *it = newItem(DL_SPRITE, x, y, c, &handle);
+
+	if(it != NULL)
+	{
+		it->data = s;
+		it->arg = flags;
+		markItem(it);
+	}
+	return handle;
+}
+
+/* One of printTime's digits, 0-F, or its colon with DL_DIGIT_COLON */
+uint8 dlDigit(int8 x, int8 y, uint8 digit, RGB c)
+{
+	uint8 handle;
+	DlItem *it = newItem(DL_DIGIT, x, y, c, &handle);
+
+	if(it != NULL)
+	{
+		it->arg = digit;
+		markItem(it);
+	}
+	return handle;
+}
+
+void dlRemove(uint8 item)
+{
+	if(item < DL_MAX_ITEMS)
+	{
+		markItem(&items[item]);
+		items[item].type = DL_FREE;
+	}
+}
+
+void dlShow(uint8 item, uint8 visible)
+{
+	if((item < DL_MAX_ITEMS) && (items[item].visible != visible))
+	{
+		markItem(&items[item]);
+		items[item].visible = visible;
+		markItem(&items[item]);
+	}
+}
+
+void dlMove(uint8 item, int8 x, int8 y)
+{
+	DlItem *it;
+	int8 dx, dy;
+
+	if(item >= DL_MAX_ITEMS)
+	{
+		return;
+	}
+	it = &items[item];
+	if((it->x == x) && (it->y == y))
+	{
+		return;
+	}
+	markItem(it);
+	if(it->type == DL_LINE)
+	{
+		/* the far end moves along */
+		dx = x - it->x;
+		dy = y - it->y;
+		it->x1 += dx;
+		it->y1 += dy;
+	}
+	it->x = x;
+	it->y = y;
+	markItem(it);
+}
+
+void dlSetColor(uint8 item, RGB c)
+{
+	DlItem *it;
+
+	if(item >= DL_MAX_ITEMS)
+	{
+		return;
+	}
+	it = &items[item];
+	if((it->c.r != c.r) || (it->c.g != c.g) || (it->c.b != c.b))
+	{
+		it->c = c;
+		markItem(it);
+	}
+}
+
+/* Width and height of a rect */
+void dlSetSize(uint8 item, int8 w, int8 h)
+{
+	DlItem *it;
+
+	if(item >= DL_MAX_ITEMS)
+	{
+		return;
+	}
+	it = &items[item];
+	if((it->type == DL_RECT) && ((it->x1 != w) || (it->y1 != h)))
+	{
+		markItem(it);
+		it->x1 = w;
+		it->y1 = h;
+		markItem(it);
+	}
+}
+
+/* Far end of a line */
+void dlSetEnd(uint8 item, int8 x1, int8 y1)
+{
+	DlItem *it;
+
+	if(item >= DL_MAX_ITEMS)
+	{
+		return;
+	}
+	it = &items[item];
+	if((it->type == DL_LINE) && ((it->x1 != x1) || (it->y1 != y1)))
+	{
+		markItem(it);
+		it->x1 = x1;
+		it->y1 = y1;
+		markItem(it);
+	}
+}
+
+/* New string, or the same buffer after its contents changed: the width as
+ * last marked clears what the old text covered
+ */
+void dlSetText(uint8 item, const char8 *s)
+{
+	DlItem *it;
+
+	if(item >= DL_MAX_ITEMS)
+	{
+		return;
+	}
+	it = &items[item];
+	if(it->type == DL_TEXT)
+	{
+		markItem(it);
+		it->data = s;
+		it->x1 = textWidth(s, it->font);
+		markItem(it);
+	}
+}
+
+void dlSetGlyph(uint8 item, char8 ch)
+{
+	DlItem *it;
+
+	if(item >= DL_MAX_ITEMS)
+	{
+		return;
+	}
+	it = &items[item];
+	if((it->type == DL_GLYPH) && (it->arg != (uint8)ch))
+	{
+		markItem(it);
+		it->arg = (uint8)ch;
+		markItem(it);
+	}
+}
+
+void dlSetDigit(uint8 item, uint8 digit)
+{
+	DlItem *it;
+
+	if(item >= DL_MAX_ITEMS)
+	{
+		return;
+	}
+	it = &items[item];
+	if((it->type == DL_DIGIT) && (it->arg != digit))
+	{
+		/* the colon covers fewer rows than a digit */
+		markItem(it);
+		it->arg = digit;
+		markItem(it);
+	}
+}
+
+/* Re-renders every row, e.g. after another mode drew over the matrix */
+void dlRefresh(void)
+{
+	uint8 i;
+
+	for(i = 0; i < DL_DIRTY_BYTES; i++)
+	{
+		dirty[i] = 0xFFu;
+	}
+	dirtyLeft = 0;
+	dirtyRight = CANVAS_WIDTH - 1;
+}
+
+/* The marked columns kept on the canvas; left > right when none are on it */
+static void clampCols(void)
+{
+	if(dirtyLeft < 0)
+	{
+		dirtyLeft = 0;
+	}
+	if(dirtyRight >= CANVAS_WIDTH)
+	{
+		dirtyRight = CANVAS_WIDTH - 1;
+	}
+}
+
+/* The marked columns of rows top to bottom cleared and the items reaching
+ * into them replayed, clipped to them; 'drawn' gets a bit per item replayed
+ */
+static void renderRows(int16 top, int16 bottom, color *matrix, uint16 *drawn)
+{
+	static const RGB black = {0u, 0u, 0u};
+	int16 itemTop, itemBottom;
+	int8 w = (int8)(dirtyRight - dirtyLeft + 1), h = (int8)(bottom - top + 1);
+	uint8 n;
+
+	setClipRect((int8)dirtyLeft, (int8)top, w, h);
+	fillRect((int8)dirtyLeft, (int8)top, w, h, black, matrix);
+	for(n = 0; n < DL_MAX_ITEMS; n++)
+	{
+		visibleRows(&items[n], &itemTop, &itemBottom);
+		if((itemTop <= bottom) && (itemBottom >= top) && inDirtyCols(&items[n]))
+		{
+			drawItem(&items[n], matrix);
+			*drawn |= (uint16)(1u << n);
+		}
+	}
+}
+
+/*******************************************************************************
+* Function Name: dlRender
+********************************************************************************
+*
+* Summary:
+*  Once per refresh frame, at the first call after it wraps to row 0, redraws
+*  the marked columns of the marked rows: each row is copied to the staging
+*  row, cleared there and the items reaching into it are replayed in handle
+*  order, clipped to it, then the lanes it spans go back to 'matrix' in one
+*  copy. Visible items replayed and left alone are counted in
+*  TLM_COUNT_DL_DRAWN and TLM_COUNT_DL_SKIPPED.
+*
+* Parameters:
+* 	color *matrix: 	pointer to the matrix buffer
+*
+*******************************************************************************/
+void dlRender(color *matrix)
+{
+	int16 top;
+	uint16 drawn = 0;
+	uint8 n, any = 0;
+#if CANVAS_ROW_LANES
+	uint8 first, lanes;
+#else
+	int16 bottom;
+#endif
+
+	if(refreshFrames == lastFrame)
+	{
+		return;
+	}
+	lastFrame = refreshFrames;
+
+	for(n = 0; n < DL_DIRTY_BYTES; n++)
+	{
+		any |= dirty[n];
+	}
+	clampCols();
+	if((any != 0u) && (dirtyLeft <= dirtyRight))
+	{
+#if CANVAS_ROW_LANES
+		first = (uint8)(dirtyLeft / 8);
+		lanes = (uint8)(dirtyRight / 8 - first + 1);
+		for(top = 0; top < CANVAS_HEIGHT; top++)
+		{
+			if(!ROW_DIRTY(top))
+			{
+				continue;
+			}
+			/* the draw calls index lanes from the top of the matrix: this
+			 * base puts row 'top' on the stage, and the clip keeps them there
+			 */
+			memcpy(&stage[first], &matrix[MATRIX_LANE(0, top) + first], lanes * sizeof(color));
+			renderRows(top, top, stage - MATRIX_LANE(0, top), &drawn);
+			memcpy(&matrix[MATRIX_LANE(0, top) + first], &stage[first], lanes * sizeof(color));
+		}
+#else
+		for(top = 0; top < CANVAS_HEIGHT; top = bottom + 1)
+		{
+			bottom = top;
+			if(!ROW_DIRTY(top))
+			{
+				continue;
+			}
+			while((bottom + 1 < CANVAS_HEIGHT) && ROW_DIRTY(bottom + 1))
+			{
+				bottom++;
+			}
+			renderRows(top, bottom, matrix, &drawn);
+		}
+#endif
+		resetClipRect();
+	}
+
+	for(n = 0; n < DL_DIRTY_BYTES; n++)
+	{
+		dirty[n] = 0;
+	}
+	dirtyLeft = CANVAS_WIDTH;
+	dirtyRight = -1;
+
+#if TELEMETRY_ENABLE
+	/* of the items on show, those replayed and those culled */
+	for(n = 0; n < DL_MAX_ITEMS; n++)
+	{
+		if((items[n].type != DL_FREE) && items[n].visible)
+		{
+			if(drawn & (1u << n))
+			{
+				TELEMETRY_COUNT(TLM_COUNT_DL_DRAWN);
+			}
+			else
+			{
+				TELEMETRY_COUNT(TLM_COUNT_DL_SKIPPED);
+			}
+		}
+	}
+#else
+	(void)drawn;
+#endif
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,71 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef DisplayList_h_
+#define DisplayList_h_
+#include <device.h>
+#include <LED_Matrix.h>
+#include "Font.h"
+
+/* Retained drawing commands for screens that barely change. Clock mode
+ * builds its screen from one unless COMPOSITOR_ENABLE; the list costs
+ * DL_MAX_ITEMS * 20 bytes of SRAM.
+ */
+#define DISPLAY_LIST_ENABLE			1
+
+/*******************************************************************************
+* Display list
+*
+*  A screen is a list of items - filled rect, line, text, glyph, 1bpp sprite,
+*  printTime digit - drawn in handle order, so later items are on top. Handles stay valid until
+*  dlRemove(). Strings, sprites and fonts are kept by reference.
+*
+*  Changing an item through a dl* call marks the canvas rows it covered and
+*  now covers, and widens the span of marked columns to its columns.
+*  dlRender() clears just those rows within that span and replays, clipped to
+*  them, only the items that reach into them; with nothing marked it does
+*  nothing. Each row is built on a staging row and copied into 'matrix' in
+*  one go, so the refresh never shows it half drawn (not on a chained canvas
+*  or in palette mode, where rows are not runs of lanes). Rendering owns the
+*  clip rectangle and leaves it reset.
+********************************************************************************/
+#define DL_MAX_ITEMS				12u
+#define DL_NO_HANDLE				0xFFu
+#define DL_DIRTY_BYTES				((CANVAS_HEIGHT + 7u) / 8u)
+#define DL_DIGIT_COLON				0x10u	/* dlDigit: drawColon instead of drawHex */
+#define DL_DIGIT_WIDTH				6		/* columns drawHex reaches right of x, C E F the most */
+#define DL_DIGIT_HEIGHT				13		/* rows drawHex reaches below y, B D E F the most */
+
+#if DISPLAY_LIST_ENABLE
+uint8 dlRect(int8 x, int8 y, int8 w, int8 h, RGB c);
+uint8 dlLine(int8 x0, int8 y0, int8 x1, int8 y1, RGB c);
+uint8 dlText(int8 x, int8 y, const char8 *s, const Font *f, RGB c);
+uint8 dlGlyph(int8 x, int8 y, char8 ch, const Font *f, RGB c);
+uint8 dlSprite(int8 x, int8 y, const Sprite *s, uint8 flags, RGB c);
+uint8 dlDigit(int8 x, int8 y, uint8 digit, RGB c);
+void dlRemove(uint8 item);
+void dlShow(uint8 item, uint8 visible);
+void dlMove(uint8 item, int8 x, int8 y);
+void dlSetColor(uint8 item, RGB c);
+void dlSetSize(uint8 item, int8 w, int8 h);
+void dlSetEnd(uint8 item, int8 x1, int8 y1);
+void dlSetText(uint8 item, const char8 *s);
+void dlSetGlyph(uint8 item, char8 ch);
+void dlSetDigit(uint8 item, uint8 digit);
+void dlRefresh(void);
+void dlRender(color *matrix);
+#else
+#define dlRefresh()
+#define dlRender(matrix)
+#endif
+
+#endif
+//[] END OF FILE
@@ -0,0 +1,300 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include "Effects.h"
+#include "Telemetry.h"
+#include "Timebase.h"
+
+#if EFFECTS_ENABLE
+
+typedef struct
+{
+	void (*frame)(uint16 t);					/* before the rows, NULL for none */
+	void (*row)(uint8 y, uint16 t, RGB *pixels);	/* canvas row y at t ms */
+} Effect;
+
+/* round(128 + 127 * sin(2 * pi * i / 256)) */
+static const uint8 sine8[256] =
+{
+	128, 131, 134, 137, 140, 144, 147, 150, 153, 156, 159, 162, 165, 168, 171, 174,
+	177, 179, 182, 185, 188, 191, 193, 196, 199, 201, 204, 206, 209, 211, 213, 216,
+	218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 239, 240, 241, 243, 244,
+	245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+	255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+	245, 244, 243, 241, 240, 239, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+	218, 216, 213, 211, 209, 206, 204, 201, 199, 196, 193, 191, 188, 185, 182, 179,
+	177, 174, 171, 168, 165, 162, 159, 156, 153, 150, 147, 144, 140, 137, 134, 131,
+	128, 125, 122, 119, 116, 112, 109, 106, 103, 100,  97,  94,  91,  88,  85,  82,
+	 79,  77,  74,  71,  68,  65,  63,  60,  57,  55,  52,  50,  47,  45,  43,  40,
+	 38,  36,  34,  32,  30,  28,  26,  24,  22,  21,  19,  17,  16,  15,  13,  12,
+	 11,  10,   8,   7,   6,   6,   5,   4,   3,   3,   2,   2,   2,   1,   1,   1,
+	  1,   1,   1,   1,   2,   2,   2,   3,   3,   4,   5,   6,   6,   7,   8,  10,
+	 11,  12,  13,  15,  16,  17,  19,  21,  22,  24,  26,  28,  30,  32,  34,  36,
+	 38,  40,  43,  45,  47,  50,  52,  55,  57,  60,  63,  65,  68,  71,  74,  77,
+	 79,  82,  85,  88,  91,  94,  97, 100, 103, 106, 109, 112, 116, 119, 122, 125
+};
+
+/* Black, red, orange, yellow, white by heat / 4 */
+static const RGB firePalette[64] =
+{
+	{  0,   0,   0}, {  6,   0,   0}, { 12,   0,   0}, { 18,   0,   0},
+	{ 24,   0,   0}, { 30,   0,   0}, { 36,   0,   0}, { 42,   0,   0},
+	{ 48,   0,   0}, { 54,   0,   0}, { 60,   0,   0}, { 66,   0,   0},
+	{ 72,   0,   0}, { 78,   0,   0}, { 84,   0,   0}, { 90,   0,   0},
+	{ 96,   0,   0}, {106,   2,   0}, {116,   4,   0}, {126,   6,   0},
+	{136,   8,   0}, {146,  10,   0}, {156,  12,   0}, {166,  14,   0},
+	{176,  16,   0}, {185,  18,   0}, {195,  20,   0}, {205,  22,   0},
+	{215,  24,   0}, {225,  26,   0}, {235,  28,   0}, {245,  30,   0},
+	{255,  32,   0}, {255,  40,   0}, {255,  48,   0}, {255,  56,   0},
+	{255,  64,   0}, {255,  72,   0}, {255,  80,   0}, {255,  88,   0},
+	{255,  96,   0}, {255, 104,   0}, {255, 112,   0}, {255, 120,   0},
+	{255, 128,   0}, {255, 136,   0}, {255, 144,   0}, {255, 152,   0},
+	{255, 160,   0}, {255, 170,   6}, {255, 179,  13}, {255, 188,  19},
+	{255, 198,  26}, {255, 208,  32}, {255, 217,  38}, {255, 226,  45},
+	{255, 236,  51}, {255, 246,  58}, {255, 255,  64}, {255, 255,  96},
+	{255, 255, 128}, {255, 255, 160}, {255, 255, 192}, {255, 255, 224}
+};
+
+/* Sine table position after t ms at 'speed' entries per ms in Q8. Whole
+ * turns of t's 16-bit wrap, so the phase runs on smoothly across it.
+ */
+#define PHASE(t, speed)			((uint8)(((uint32)(t) * (speed)) >> 8))
+
+/* a + (b - a) * f / 256 */
+static uint8 lerp8(uint8 a, uint8 b, uint8 f)
+{
+	return (uint8)(a + ((((int16)b - a) * f) >> 8));
+}
+
+static uint16 randomState = 0xACE1u;
+
+/* xorshift16, full period */
+static uint8 effectRandom(void)
+{
+	randomState ^= randomState << 7;
+	randomState ^= randomState >> 9;
+	randomState ^= randomState << 8;
+	return (uint8)randomState;
+}
+
+/*******************************************************************************
+* Plasma: four sine waves summed, the sum turned into a slowly rotating hue
+*******************************************************************************/
+static void plasmaRow(uint8 y, uint16 t, RGB *pixels)
+{
+	uint8 a = PHASE(t, 40u), b = PHASE(t, 27u), c = PHASE(t, 19u), hue = PHASE(t, 5u);
+	uint8 rowWave = sine8[(uint8)(y * 12u + b)];
+	int8 cx = (int8)(sine8[c] >> 3), dy = (int8)y - (int8)(sine8[b] >> 4);
+	uint8 x, v;
+	int8 dx;
+
+	for(x = 0; x < CANVAS_WIDTH; x++)
+	{
+		dx = (int8)x - cx;
+		v = (uint8)(((uint16)sine8[(uint8)(x * 8u + a)] + rowWave + sine8[(uint8)(x * 5u + y * 7u + c)] +
+			sine8[(uint8)((((uint16)(dx * dx) + (uint16)(dy * dy)) >> 2) - a)]) >> 2);
+		v += hue;
+		pixels[x].r = sine8[v];
+		pixels[x].g = sine8[(uint8)(v + 85u)];
+		pixels[x].b = sine8[(uint8)(v + 170u)];
+	}
+}
+
+/*******************************************************************************
+* Fire: two octaves of value noise scrolling along the rows, fading with
+* height. The base is row 0, the bottom as the clock panel is mounted.
+*******************************************************************************/
+#define FIRE_CELL_X				72u			/* lattice cells per pixel, Q8 */
+#define FIRE_CELL_Y				96u
+#define FIRE_RISE				2u			/* lattice cells per ms, Q8 */
+
+/* Value of lattice point (cx, cy) */
+static uint8 lattice(uint8 cx, uint8 cy)
+{
+	uint8 h = (uint8)(cx * 0x9Du + cy * 0x3Bu);
+
+	h ^= (uint8)(h >> 3);
+	h = (uint8)(h * 0xB5u + cy);
+	return (uint8)(h ^ (h >> 4));
+}
+
+/* Bilinear value noise at a Q8 lattice position */
+static uint8 noise(uint16 xq, uint16 yq)
+{
+	uint8 cx = (uint8)(xq >> 8), cy = (uint8)(yq >> 8);
+
+	return lerp8(lerp8(lattice(cx, cy), lattice(cx + 1u, cy), (uint8)xq),
+		lerp8(lattice(cx, cy + 1u), lattice(cx + 1u, cy + 1u), (uint8)xq), (uint8)yq);
+}
+
+static void fireRow(uint8 y, uint16 t, RGB *pixels)
+{
+	/* uint16 wraps with t, whole lattice turns */
+	uint16 yq = (uint16)(y * FIRE_CELL_Y - t * FIRE_RISE);
+	uint8 fade = (uint8)(255u - y * (256u / CANVAS_HEIGHT)), x;
+	uint16 heat;
+
+	for(x = 0; x < CANVAS_WIDTH; x++)
+	{
+		heat = noise((uint16)(x * FIRE_CELL_X), yq) + (noise((uint16)(x * FIRE_CELL_X * 2u), (uint16)(yq * 2u)) >> 1);
+		/* 0 - 382 scaled by the fade, cooled and stretched over the palette */
+		heat = (uint16)((heat * fade) >> 8);
+		heat = (heat > 64u) ? (uint16)((heat - 64u) * 3u / 2u) : 0u;
+		pixels[x] = firePalette[(heat > 255u) ? 63u : (heat >> 2)];
+	}
+}
+
+/*******************************************************************************
+* Starfield: stars at Q8 depths flying at the viewer, nearer ones brighter
+*******************************************************************************/
+#define STARS					24u
+#define STAR_FAR				2048u		/* depth, Q8 */
+#define STAR_NEAR				64u
+#define STAR_SPEED				256u		/* depth per ms, Q8 */
+
+typedef struct
+{
+	int8 x;
+	int8 y;
+	uint16 z;
+	int8 sx;			/* canvas position */
+	int8 sy;
+	uint8 level;
+} Star;
+
+static Star stars[STARS];
+static uint16 starsLast = 0;
+
+static void starsFrame(uint16 t)
+{
+	uint16 step = (uint16)(t - starsLast);
+	uint8 n;
+	Star *s;
+
+	starsLast = t;
+	/* after a pause, e.g. when the mode comes back */
+	if(step > 100u)
+	{
+		step = 100u;
+	}
+	step = (uint16)((step * STAR_SPEED) >> 8);
+
+	for(n = 0; n < STARS; n++)
+	{
+		s = &stars[n];
+		if(s->z <= STAR_NEAR + step)
+		{
+			s->x = (int8)effectRandom();
+			s->y = (int8)effectRandom();
+			s->z = STAR_FAR - 1u - ((uint16)effectRandom() << 2);
+		}
+		else
+		{
+			s->z -= step;
+		}
+		s->sx = (int8)(CANVAS_WIDTH / 2 + ((int16)s->x * 32) / (int16)s->z);
+		s->sy = (int8)(CANVAS_HEIGHT / 2 + ((int16)s->y * 32) / (int16)s->z);
+		s->level = (uint8)(255u - (s->z >> 3));
+		if((s->sx < 0) || (s->sx >= CANVAS_WIDTH) || (s->sy < 0) || (s->sy >= CANVAS_HEIGHT))
+		{
+			/* flown past the edge: back to the far plane next frame */
+			s->z = 0;
+			s->level = 0;
+		}
+	}
+}
+
+static void starsRow(uint8 y, uint16 t, RGB *pixels)
+{
+	static const RGB black = {0u, 0u, 0u};
+	uint8 n;
+
+	(void)t;
+	for(n = 0; n < CANVAS_WIDTH; n++)
+	{
+		pixels[n] = black;
+	}
+	for(n = 0; n < STARS; n++)
+	{
+		if((stars[n].sy == (int8)y) && (stars[n].level != 0u))
+		{
+			pixels[stars[n].sx].r = stars[n].level;
+			pixels[stars[n].sx].g = stars[n].level;
+			pixels[stars[n].sx].b = stars[n].level;
+		}
+	}
+}
+
+static const Effect effects[EFFECT_COUNT] =
+{
+	{NULL, plasmaRow},
+	{NULL, fireRow},
+	{starsFrame, starsRow}
+};
+
+static uint8 effect = EFFECT_PLASMA;
+static uint32 lastRender = 0;
+static RGB rowPixels[CANVAS_WIDTH];
+
+void effectSelect(uint8 n)
+{
+	effect = (n < EFFECT_COUNT) ? n : EFFECT_PLASMA;
+}
+
+void effectNext(void)
+{
+	effectSelect(effect + 1u);
+}
+
+/*******************************************************************************
+* Function Name: effectService
+********************************************************************************
+*
+* Summary:
+*  Renders a frame of the selected effect over the whole canvas when
+*  EFFECT_FRAME_MS have passed since the last one. The frame is timed as
+*  TLM_STAT_EFFECT. Call from the main loop while the mode shows effects.
+*
+* Parameters:
+* 	color *matrix: 	pointer to the matrix buffer
+*
+*******************************************************************************/
+void effectService(color *matrix)
+{
+	uint32 now = timebaseMillis();
+	uint8 y;
+
+	if(now - lastRender < EFFECT_FRAME_MS)
+	{
+		return;
+	}
+	lastRender = now;
+	{
+		TELEMETRY_STAMP(frameStart);
+
+		if(effects[effect].frame != NULL)
+		{
+			effects[effect].frame((uint16)now);
+		}
+		for(y = 0; y < CANVAS_HEIGHT; y++)
+		{
+			effects[effect].row(y, (uint16)now, rowPixels);
+			drawRow(0, (int8)y, CANVAS_WIDTH, rowPixels, matrix);
+		}
+		TELEMETRY_RECORD(TLM_STAT_EFFECT, frameStart);
+	}
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,53 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef Effects_h_
+#define Effects_h_
+#include <device.h>
+#include <LED_Matrix.h>
+
+/* Attract mode: procedural effects as main loop mode 5. Leave at 0 to keep
+ * the mode and its tables out of the build. Can be set with -D, as the host
+ * tests do.
+ */
+#ifndef EFFECTS_ENABLE
+#define EFFECTS_ENABLE				0
+#endif
+
+/*******************************************************************************
+* Effects
+*
+*  An effect renders a frame a canvas row at a time, as CANVAS_WIDTH 8-bit
+*  colors that drawRow() packs into the bit planes. All of the arithmetic is
+*  8-bit fixed point on flash tables - a 256-entry sine, a fire palette - so
+*  a frame costs no floats and no per-pixel plane writes. Adding one takes
+*  a row function, an optional per-frame function and an entry in the table
+*  in Effects.c.
+********************************************************************************/
+#define EFFECT_PLASMA				0u
+#define EFFECT_FIRE					1u
+#define EFFECT_STARFIELD			2u
+#define EFFECT_COUNT				3u
+
+/* Shortest time between frames, 50 fps at most */
+#define EFFECT_FRAME_MS				20u
+
+#if EFFECTS_ENABLE
+void effectSelect(uint8 n);
+void effectNext(void);
+void effectService(color *matrix);
+#else
+#define effectNext()
+#define effectService(matrix)
+#endif
+
+#endif
+//[] END OF FILE
@@ -0,0 +1,119 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include "Font.h"
+#include "Telemetry.h"
+
+/* The glyph of ch as a sprite, '?' for anything the font does not cover */
+void fontGlyph(const Font *f, char8 ch, Sprite *glyph)
+{
+	uint8 n = (uint8)ch;
+
+	if((n < f->first) || (n > f->last))
+	{
+		n = '?';
+	}
+	n -= f->first;
+	glyph->width = f->widths[n];
+	glyph->height = f->height;
+	glyph->data = &f->bitmap[(uint16)n * f->height];
+}
+
+/* Space between left and right: the font's spacing plus any kerning pair */
+int8 fontGap(const Font *f, char8 left, char8 right)
+{
+	const FontKern *k = f->kerning;
+
+	if(k != NULL)
+	{
+		for(; k->left != 0; k++)
+		{
+			if((k->left == left) && (k->right == right))
+			{
+				return (int8)f->spacing + k->adjust;
+			}
+		}
+	}
+	return (int8)f->spacing;
+}
+
+/*******************************************************************************
+* Function Name: drawString
+********************************************************************************
+*
+* Summary:
+*  Draws s with the top of its cells at row y. Every glyph goes through
+*  drawSprite1, so it is clipped and written a row of lane bytes at a time.
+*  Stops at the end of the string or once the pen leaves the right edge.
+*
+* Parameters:
+*   int8 x, y: 		canvas position of the first cell, may be off the canvas
+*	char8 *s:		zero terminated text
+*	Font *f:		font
+*	RGB c:			text color
+* 	color *matrix: 	pointer to the matrix buffer
+*
+* Return:
+*   Pen position after the last glyph drawn, where the next one would go
+*
+*******************************************************************************/
+int16 drawString(int8 x, int8 y, const char8 *s, const Font *f, RGB c, color *matrix)
+{
+	Sprite glyph;
+	int16 pen = x;
+
+	for(; (*s != 0) && (pen < SURFACE_WIDTH); s++)
+	{
+		TELEMETRY_STAMP(glyphStart);
+
+		fontGlyph(f, *s, &glyph);
+		if(pen > -(int16)FONT_MAX_GLYPH_WIDTH)
+		{
+			drawSprite1((int8)pen, y, &glyph, c, 0, matrix);
+		}
+		pen += glyph.width;
+		if(s[1] != 0)
+		{
+			pen += fontGap(f, s[0], s[1]);
+		}
+		TELEMETRY_RECORD(TLM_STAT_GLYPH, glyphStart);
+	}
+	return pen;
+}
+
+/*******************************************************************************
+* Function Name: measureString
+********************************************************************************
+*
+* Return:
+*   Width of s in pixels as drawString lays it out, 0 for an empty string
+*
+*******************************************************************************/
+int16 measureString(const char8 *s, const Font *f)
+{
+	Sprite glyph;
+	int16 width = 0;
+
+	for(; *s != 0; s++)
+	{
+		fontGlyph(f, *s, &glyph);
+		width += glyph.width;
+		if(s[1] != 0)
+		{
+			width += fontGap(f, s[0], s[1]);
+		}
+	}
+	return width;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,59 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef Font_h_
+#define Font_h_
+#include <device.h>
+#include <LED_Matrix.h>
+
+/*******************************************************************************
+* Proportional 1bpp bitmap font, kept in flash
+*
+*  Glyphs 'first' to 'last', each 'height' rows of one byte with the leftmost
+*  pixel in bit 0 (the Sprite layout), cropped to its ink: glyph n starts at
+*  bitmap[n * height] and is widths[n] pixels wide, at most 8. Row 'ascent'
+*  is the first one below the baseline.
+*
+*  ProcessingCodeFont.txt writes the widths and bitmap tables from a BDF font.
+*  Kerning pairs are optional, a list ending with left == 0.
+********************************************************************************/
+#define FONT_MAX_GLYPH_WIDTH		8u
+
+typedef struct
+{
+	char8 left;
+	char8 right;
+	int8 adjust;				/* added to the gap between the two */
+} FontKern;
+
+typedef struct
+{
+	uint8 first;
+	uint8 last;
+	uint8 height;
+	uint8 ascent;
+	uint8 spacing;				/* columns between glyphs */
+	const uint8 *widths;
+	const uint8 *bitmap;
+	const FontKern *kerning;	/* NULL for none */
+} Font;
+
+/* In FontData.c: ASCII 32 - 126 */
+extern const Font font5x7;		/* 8 rows, capitals 7 high, 1 row of descender */
+extern const Font font3x5;		/* 6 rows, capitals 5 high, 1 row of descender */
+
+void fontGlyph(const Font *f, char8 ch, Sprite *glyph);
+int8 fontGap(const Font *f, char8 left, char8 right);
+int16 drawString(int8 x, int8 y, const char8 *s, const Font *f, RGB c, color *matrix);
+int16 measureString(const char8 *s, const Font *f);
+
+#endif
+//[] END OF FILE
@@ -0,0 +1,249 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include "Font.h"
+
+/* Glyph tables as ProcessingCodeFont.txt writes them, ASCII 32 - 126 */
+
+/* font5x7: 8 rows, 7 above the baseline */
+static const uint8 font5x7Widths[95] =
+{
+	3, 1, 3, 5, 5, 5, 5, 1, 2, 2, 5, 5, 2, 4, 1, 5,
+	5, 3, 5, 5, 5, 5, 5, 5, 5, 5, 1, 2, 4, 4, 4, 5,
+	5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 5, 5, 5, 5, 5, 5,
+	5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 2, 5, 2, 5, 5,
+	2, 4, 4, 3, 4, 4, 3, 4, 4, 1, 2, 4, 2, 5, 4, 4,
+	4, 4, 3, 4, 3, 4, 5, 5, 4, 4, 4, 3, 1, 3, 5
+};
+
+static const uint8 font5x7Bitmap[760] =
+{
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	/* ' ' */
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x01, 0x00,	/* '!' */
+	0x05, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	/* '"' */
+	0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A, 0x00,	/* '#' */
+	0x04, 0x1E, 0x05, 0x0E, 0x14, 0x0F, 0x04, 0x00,	/* '$' */
+	0x03, 0x13, 0x08, 0x04, 0x02, 0x19, 0x18, 0x00,	/* '%' */
+	0x06, 0x09, 0x05, 0x02, 0x15, 0x09, 0x16, 0x00,	/* '&' */
+	0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	/* '\'' */
+	0x02, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x00,	/* '(' */
+	0x01, 0x02, 0x02, 0x02, 0x02, 0x02, 0x01, 0x00,	/* ')' */
+	0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00, 0x00,	/* '*' */
+	0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, 0x00,	/* '+' */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01,	/* ',' */
+	0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00,	/* '-' */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,	/* '.' */
+	0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00,	/* '/' */
+	0x0E, 0x11, 0x19, 0x15, 0x13, 0x11, 0x0E, 0x00,	/* '0' */
+	0x02, 0x03, 0x02, 0x02, 0x02, 0x02, 0x07, 0x00,	/* '1' */
+	0x0E, 0x11, 0x10, 0x08, 0x04, 0x02, 0x1F, 0x00,	/* '2' */
+	0x1F, 0x08, 0x04, 0x08, 0x10, 0x11, 0x0E, 0x00,	/* '3' */
+	0x08, 0x0C, 0x0A, 0x09, 0x1F, 0x08, 0x08, 0x00,	/* '4' */
+	0x1F, 0x01, 0x0F, 0x10, 0x10, 0x11, 0x0E, 0x00,	/* '5' */
+	0x0C, 0x02, 0x01, 0x0F, 0x11, 0x11, 0x0E, 0x00,	/* '6' */
+	0x1F, 0x10, 0x08, 0x04, 0x02, 0x02, 0x02, 0x00,	/* '7' */
+	0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E, 0x00,	/* '8' */
+	0x0E, 0x11, 0x11, 0x1E, 0x10, 0x08, 0x06, 0x00,	/* '9' */
+	0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,	/* ':' */
+	0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01,	/* ';' */
+	0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00,	/* '<' */
+	0x00, 0x00, 0x0F, 0x00, 0x0F, 0x00, 0x00, 0x00,	/* '=' */
+	0x01, 0x02, 0x04, 0x08, 0x04, 0x02, 0x01, 0x00,	/* '>' */
+	0x0E, 0x11, 0x10, 0x08, 0x04, 0x00, 0x04, 0x00,	/* '?' */
+	0x0E, 0x11, 0x10, 0x16, 0x15, 0x15, 0x0E, 0x00,	/* '@' */
+	0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x00,	/* 'A' */
+	0x0F, 0x11, 0x11, 0x0F, 0x11, 0x11, 0x0F, 0x00,	/* 'B' */
+	0x0E, 0x11, 0x01, 0x01, 0x01, 0x11, 0x0E, 0x00,	/* 'C' */
+	0x07, 0x09, 0x11, 0x11, 0x11, 0x09, 0x07, 0x00,	/* 'D' */
+	0x1F, 0x01, 0x01, 0x0F, 0x01, 0x01, 0x1F, 0x00,	/* 'E' */
+	0x1F, 0x01, 0x01, 0x0F, 0x01, 0x01, 0x01, 0x00,	/* 'F' */
+	0x0E, 0x11, 0x01, 0x1D, 0x11, 0x11, 0x1E, 0x00,	/* 'G' */
+	0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00,	/* 'H' */
+	0x07, 0x02, 0x02, 0x02, 0x02, 0x02, 0x07, 0x00,	/* 'I' */
+	0x1C, 0x08, 0x08, 0x08, 0x08, 0x09, 0x06, 0x00,	/* 'J' */
+	0x11, 0x09, 0x05, 0x03, 0x05, 0x09, 0x11, 0x00,	/* 'K' */
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x1F, 0x00,	/* 'L' */
+	0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00,	/* 'M' */
+	0x11, 0x11, 0x13, 0x15, 0x19, 0x11, 0x11, 0x00,	/* 'N' */
+	0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00,	/* 'O' */
+	0x0F, 0x11, 0x11, 0x0F, 0x01, 0x01, 0x01, 0x00,	/* 'P' */
+	0x0E, 0x11, 0x11, 0x11, 0x15, 0x09, 0x16, 0x00,	/* 'Q' */
+	0x0F, 0x11, 0x11, 0x0F, 0x05, 0x09, 0x11, 0x00,	/* 'R' */
+	0x1E, 0x01, 0x01, 0x0E, 0x10, 0x10, 0x0F, 0x00,	/* 'S' */
+	0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00,	/* 'T' */
+	0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00,	/* 'U' */
+	0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00,	/* 'V' */
+	0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A, 0x00,	/* 'W' */
+	0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11, 0x00,	/* 'X' */
+	0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x00,	/* 'Y' */
+	0x1F, 0x10, 0x08, 0x04, 0x02, 0x01, 0x1F, 0x00,	/* 'Z' */
+	0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x00,	/* '[' */
+	0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00,	/* '\\' */
+	0x03, 0x02, 0x02, 0x02, 0x02, 0x02, 0x03, 0x00,	/* ']' */
+	0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00,	/* '^' */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x00,	/* '_' */
+	0x01, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	/* '`' */
+	0x00, 0x00, 0x06, 0x08, 0x0E, 0x09, 0x0E, 0x00,	/* 'a' */
+	0x01, 0x01, 0x07, 0x09, 0x09, 0x09, 0x07, 0x00,	/* 'b' */
+	0x00, 0x00, 0x06, 0x01, 0x01, 0x01, 0x06, 0x00,	/* 'c' */
+	0x08, 0x08, 0x0E, 0x09, 0x09, 0x09, 0x0E, 0x00,	/* 'd' */
+	0x00, 0x00, 0x06, 0x09, 0x0F, 0x01, 0x0E, 0x00,	/* 'e' */
+	0x04, 0x02, 0x07, 0x02, 0x02, 0x02, 0x02, 0x00,	/* 'f' */
+	0x00, 0x00, 0x0E, 0x09, 0x09, 0x0E, 0x08, 0x06,	/* 'g' */
+	0x01, 0x01, 0x07, 0x09, 0x09, 0x09, 0x09, 0x00,	/* 'h' */
+	0x01, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,	/* 'i' */
+	0x02, 0x00, 0x02, 0x02, 0x02, 0x02, 0x02, 0x01,	/* 'j' */
+	0x01, 0x01, 0x09, 0x05, 0x03, 0x05, 0x09, 0x00,	/* 'k' */
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x00,	/* 'l' */
+	0x00, 0x00, 0x0B, 0x15, 0x15, 0x15, 0x15, 0x00,	/* 'm' */
+	0x00, 0x00, 0x07, 0x09, 0x09, 0x09, 0x09, 0x00,	/* 'n' */
+	0x00, 0x00, 0x06, 0x09, 0x09, 0x09, 0x06, 0x00,	/* 'o' */
+	0x00, 0x00, 0x07, 0x09, 0x09, 0x07, 0x01, 0x01,	/* 'p' */
+	0x00, 0x00, 0x0E, 0x09, 0x09, 0x0E, 0x08, 0x08,	/* 'q' */
+	0x00, 0x00, 0x05, 0x03, 0x01, 0x01, 0x01, 0x00,	/* 'r' */
+	0x00, 0x00, 0x0E, 0x01, 0x06, 0x08, 0x07, 0x00,	/* 's' */
+	0x02, 0x02, 0x07, 0x02, 0x02, 0x02, 0x04, 0x00,	/* 't' */
+	0x00, 0x00, 0x09, 0x09, 0x09, 0x09, 0x0E, 0x00,	/* 'u' */
+	0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00,	/* 'v' */
+	0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A, 0x00,	/* 'w' */
+	0x00, 0x00, 0x09, 0x09, 0x06, 0x09, 0x09, 0x00,	/* 'x' */
+	0x00, 0x00, 0x09, 0x09, 0x09, 0x0E, 0x08, 0x06,	/* 'y' */
+	0x00, 0x00, 0x0F, 0x08, 0x06, 0x01, 0x0F, 0x00,	/* 'z' */
+	0x04, 0x02, 0x02, 0x01, 0x02, 0x02, 0x04, 0x00,	/* '{' */
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,	/* '|' */
+	0x01, 0x02, 0x02, 0x04, 0x02, 0x02, 0x01, 0x00,	/* '}' */
+	0x00, 0x00, 0x02, 0x15, 0x08, 0x00, 0x00, 0x00 	/* '~' */
+};
+
+/* font3x5: 6 rows, 5 above the baseline */
+static const uint8 font3x5Widths[95] =
+{
+	2, 1, 3, 3, 3, 3, 3, 1, 2, 2, 3, 3, 2, 3, 1, 3,
+	3, 2, 3, 3, 3, 3, 3, 3, 3, 3, 1, 2, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 3, 2, 3, 3,
+	2, 3, 3, 3, 3, 3, 3, 3, 3, 1, 2, 3, 2, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 3, 3
+};
+
+static const uint8 font3x5Bitmap[570] =
+{
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	/* ' ' */
+	0x01, 0x01, 0x01, 0x00, 0x01, 0x00,	/* '!' */
+	0x05, 0x05, 0x00, 0x00, 0x00, 0x00,	/* '"' */
+	0x05, 0x07, 0x05, 0x07, 0x05, 0x00,	/* '#' */
+	0x06, 0x03, 0x02, 0x06, 0x03, 0x00,	/* '$' */
+	0x05, 0x04, 0x02, 0x01, 0x05, 0x00,	/* '%' */
+	0x03, 0x03, 0x07, 0x05, 0x06, 0x00,	/* '&' */
+	0x01, 0x01, 0x00, 0x00, 0x00, 0x00,	/* '\'' */
+	0x02, 0x01, 0x01, 0x01, 0x02, 0x00,	/* '(' */
+	0x01, 0x02, 0x02, 0x02, 0x01, 0x00,	/* ')' */
+	0x05, 0x02, 0x05, 0x00, 0x00, 0x00,	/* '*' */
+	0x00, 0x02, 0x07, 0x02, 0x00, 0x00,	/* '+' */
+	0x00, 0x00, 0x00, 0x02, 0x01, 0x00,	/* ',' */
+	0x00, 0x00, 0x07, 0x00, 0x00, 0x00,	/* '-' */
+	0x00, 0x00, 0x00, 0x00, 0x01, 0x00,	/* '.' */
+	0x04, 0x04, 0x02, 0x01, 0x01, 0x00,	/* '/' */
+	0x06, 0x05, 0x05, 0x05, 0x03, 0x00,	/* '0' */
+	0x02, 0x03, 0x02, 0x02, 0x02, 0x00,	/* '1' */
+	0x03, 0x04, 0x02, 0x01, 0x07, 0x00,	/* '2' */
+	0x03, 0x04, 0x02, 0x04, 0x03, 0x00,	/* '3' */
+	0x05, 0x05, 0x07, 0x04, 0x04, 0x00,	/* '4' */
+	0x07, 0x01, 0x03, 0x04, 0x03, 0x00,	/* '5' */
+	0x06, 0x01, 0x07, 0x05, 0x07, 0x00,	/* '6' */
+	0x07, 0x04, 0x02, 0x01, 0x01, 0x00,	/* '7' */
+	0x07, 0x05, 0x07, 0x05, 0x07, 0x00,	/* '8' */
+	0x07, 0x05, 0x07, 0x04, 0x03, 0x00,	/* '9' */
+	0x00, 0x01, 0x00, 0x01, 0x00, 0x00,	/* ':' */
+	0x00, 0x02, 0x00, 0x02, 0x01, 0x00,	/* ';' */
+	0x04, 0x02, 0x01, 0x02, 0x04, 0x00,	/* '<' */
+	0x00, 0x07, 0x00, 0x07, 0x00, 0x00,	/* '=' */
+	0x01, 0x02, 0x04, 0x02, 0x01, 0x00,	/* '>' */
+	0x07, 0x04, 0x02, 0x00, 0x02, 0x00,	/* '?' */
+	0x02, 0x05, 0x07, 0x01, 0x06, 0x00,	/* '@' */
+	0x02, 0x05, 0x07, 0x05, 0x05, 0x00,	/* 'A' */
+	0x03, 0x05, 0x03, 0x05, 0x03, 0x00,	/* 'B' */
+	0x06, 0x01, 0x01, 0x01, 0x06, 0x00,	/* 'C' */
+	0x03, 0x05, 0x05, 0x05, 0x03, 0x00,	/* 'D' */
+	0x07, 0x01, 0x07, 0x01, 0x07, 0x00,	/* 'E' */
+	0x07, 0x01, 0x07, 0x01, 0x01, 0x00,	/* 'F' */
+	0x06, 0x01, 0x05, 0x05, 0x06, 0x00,	/* 'G' */
+	0x05, 0x05, 0x07, 0x05, 0x05, 0x00,	/* 'H' */
+	0x07, 0x02, 0x02, 0x02, 0x07, 0x00,	/* 'I' */
+	0x04, 0x04, 0x04, 0x05, 0x02, 0x00,	/* 'J' */
+	0x05, 0x05, 0x03, 0x05, 0x05, 0x00,	/* 'K' */
+	0x01, 0x01, 0x01, 0x01, 0x07, 0x00,	/* 'L' */
+	0x05, 0x07, 0x07, 0x05, 0x05, 0x00,	/* 'M' */
+	0x05, 0x07, 0x07, 0x07, 0x05, 0x00,	/* 'N' */
+	0x02, 0x05, 0x05, 0x05, 0x02, 0x00,	/* 'O' */
+	0x03, 0x05, 0x03, 0x01, 0x01, 0x00,	/* 'P' */
+	0x02, 0x05, 0x05, 0x07, 0x06, 0x00,	/* 'Q' */
+	0x03, 0x05, 0x07, 0x03, 0x05, 0x00,	/* 'R' */
+	0x06, 0x01, 0x02, 0x04, 0x03, 0x00,	/* 'S' */
+	0x07, 0x02, 0x02, 0x02, 0x02, 0x00,	/* 'T' */
+	0x05, 0x05, 0x05, 0x05, 0x06, 0x00,	/* 'U' */
+	0x05, 0x05, 0x05, 0x02, 0x02, 0x00,	/* 'V' */
+	0x05, 0x05, 0x07, 0x07, 0x05, 0x00,	/* 'W' */
+	0x05, 0x05, 0x02, 0x05, 0x05, 0x00,	/* 'X' */
+	0x05, 0x05, 0x02, 0x02, 0x02, 0x00,	/* 'Y' */
+	0x07, 0x04, 0x02, 0x01, 0x07, 0x00,	/* 'Z' */
+	0x03, 0x01, 0x01, 0x01, 0x03, 0x00,	/* '[' */
+	0x01, 0x01, 0x02, 0x04, 0x04, 0x00,	/* '\\' */
+	0x03, 0x02, 0x02, 0x02, 0x03, 0x00,	/* ']' */
+	0x02, 0x05, 0x00, 0x00, 0x00, 0x00,	/* '^' */
+	0x00, 0x00, 0x00, 0x00, 0x07, 0x00,	/* '_' */
+	0x01, 0x02, 0x00, 0x00, 0x00, 0x00,	/* '`' */
+	0x00, 0x03, 0x06, 0x05, 0x07, 0x00,	/* 'a' */
+	0x01, 0x03, 0x05, 0x05, 0x03, 0x00,	/* 'b' */
+	0x00, 0x06, 0x01, 0x01, 0x06, 0x00,	/* 'c' */
+	0x04, 0x06, 0x05, 0x05, 0x06, 0x00,	/* 'd' */
+	0x00, 0x06, 0x05, 0x03, 0x06, 0x00,	/* 'e' */
+	0x06, 0x01, 0x07, 0x01, 0x01, 0x00,	/* 'f' */
+	0x00, 0x06, 0x05, 0x06, 0x04, 0x03,	/* 'g' */
+	0x01, 0x03, 0x05, 0x05, 0x05, 0x00,	/* 'h' */
+	0x01, 0x00, 0x01, 0x01, 0x01, 0x00,	/* 'i' */
+	0x02, 0x00, 0x02, 0x02, 0x02, 0x01,	/* 'j' */
+	0x01, 0x05, 0x03, 0x03, 0x05, 0x00,	/* 'k' */
+	0x03, 0x02, 0x02, 0x02, 0x02, 0x00,	/* 'l' */
+	0x00, 0x07, 0x07, 0x07, 0x05, 0x00,	/* 'm' */
+	0x00, 0x03, 0x05, 0x05, 0x05, 0x00,	/* 'n' */
+	0x00, 0x02, 0x05, 0x05, 0x02, 0x00,	/* 'o' */
+	0x00, 0x03, 0x05, 0x05, 0x03, 0x01,	/* 'p' */
+	0x00, 0x06, 0x05, 0x05, 0x06, 0x04,	/* 'q' */
+	0x00, 0x06, 0x01, 0x01, 0x01, 0x00,	/* 'r' */
+	0x00, 0x06, 0x03, 0x06, 0x03, 0x00,	/* 's' */
+	0x02, 0x07, 0x02, 0x02, 0x06, 0x00,	/* 't' */
+	0x00, 0x05, 0x05, 0x05, 0x06, 0x00,	/* 'u' */
+	0x00, 0x05, 0x05, 0x02, 0x02, 0x00,	/* 'v' */
+	0x00, 0x05, 0x07, 0x07, 0x07, 0x00,	/* 'w' */
+	0x00, 0x05, 0x02, 0x02, 0x05, 0x00,	/* 'x' */
+	0x00, 0x05, 0x05, 0x06, 0x04, 0x03,	/* 'y' */
+	0x00, 0x07, 0x06, 0x03, 0x07, 0x00,	/* 'z' */
+	0x06, 0x02, 0x03, 0x02, 0x06, 0x00,	/* '{' */
+	0x01, 0x01, 0x00, 0x01, 0x01, 0x00,	/* '|' */
+	0x03, 0x02, 0x06, 0x02, 0x03, 0x00,	/* '}' */
+	0x06, 0x03, 0x00, 0x00, 0x00, 0x00 	/* '~' */
+};
+
+static const FontKern font5x7Kerning[] =
+{
+	{'T', '.', -1}, {'T', ',', -1}, {'T', 'a', -1}, {'T', 'o', -1},
+	{'L', 'T', -1}, {'F', '.', -1}, {'F', ',', -1}, {'P', '.', -1},
+	{'r', '.', -1}, {'r', ',', -1},
+	{0, 0, 0}
+};
+
+const Font font5x7 = {32u, 126u, 8u, 7u, 1u, font5x7Widths, font5x7Bitmap, font5x7Kerning};
+const Font font3x5 = {32u, 126u, 6u, 5u, 1u, font3x5Widths, font3x5Bitmap, NULL};
+
+/* [] END OF FILE */
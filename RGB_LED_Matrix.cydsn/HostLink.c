@@ -0,0 +1,146 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include "HostLink.h"
+#include "Telemetry.h"
+#include "AnimStore.h"
+#include "Settings.h"
+
+#if HOSTLINK_ENABLE
+
+void hostLinkStart(void)
+{
+	UART_Start();
+}
+
+/* Waits up to HOSTLINK_TIMEOUT_MS for the next byte of a command */
+static uint8 getByte(uint8 *b)
+{
+	uint32 start = timebaseMillis();
+
+	while(UART_SpiUartGetRxBufferSize() == 0u)
+	{
+		if((timebaseMillis() - start) > HOSTLINK_TIMEOUT_MS)
+		{
+			return 0;
+		}
+	}
+	*b = (uint8)UART_UartGetChar();
+	return 1;
+}
+
+/* Receives one animation container row and programs it into flash.
+ * The host writes the header row (0) last, so playback restarts only
+ * once the whole container is in place.
+ */
+static void receiveAnimRow(void)
+{
+	uint8 rowData[CY_FLASH_SIZEOF_ROW];
+	uint8 lo, hi, sum, check = 0;
+	uint16 row, i;
+
+	if(!getByte(&lo) || !getByte(&hi))
+	{
+		UART_UartPutChar(HOSTLINK_NAK);
+		return;
+	}
+	row = (uint16)lo | ((uint16)hi << 8);
+
+	for(i = 0; i < CY_FLASH_SIZEOF_ROW; i++)
+	{
+		if(!getByte(&rowData[i]))
+		{
+			UART_UartPutChar(HOSTLINK_NAK);
+			return;
+		}
+		check += rowData[i];
+	}
+
+	if(!getByte(&sum) || (sum != check) || (animWriteRow(row, rowData) != CYRET_SUCCESS))
+	{
+		UART_UartPutChar(HOSTLINK_NAK);
+		return;
+	}
+
+	if(row == 0u)
+	{
+		animPlayStart();
+	}
+	UART_UartPutChar(HOSTLINK_ACK);
+}
+
+/* Changes one persistent setting; it reaches flash from settingsService() */
+static void receiveSetting(void)
+{
+	uint8 key, lo, hi;
+
+	if(!getByte(&key) || !getByte(&lo) || !getByte(&hi) || (key >= SETTINGS_COUNT))
+	{
+		UART_UartPutChar(HOSTLINK_NAK);
+		return;
+	}
+	settingsSet(key, (uint16)lo | ((uint16)hi << 8));
+	UART_UartPutChar(HOSTLINK_ACK);
+}
+
+/*******************************************************************************
+* Function Name: hostLinkService
+********************************************************************************
+*
+* Summary:
+*  Polls the UART for host commands. Call from the main loop; it never blocks
+*  when nothing has been received.
+*
+*******************************************************************************/
+void hostLinkService(void)
+{
+	uint8 cmd;
+
+	while(UART_SpiUartGetRxBufferSize() != 0u)
+	{
+		cmd = (uint8)UART_UartGetChar();
+
+		switch(cmd)
+		{
+			case HOSTLINK_CMD_TELEMETRY:
+				telemetrySend();
+				break;
+			case HOSTLINK_CMD_PERIODIC:
+				telemetrySetPeriodic(!telemetryGetPeriodic());
+				break;
+			case HOSTLINK_CMD_ANIM_ROW:
+				receiveAnimRow();
+				break;
+			case HOSTLINK_CMD_SETTING:
+				receiveSetting();
+				break;
+			default:
+				break;
+		}
+	}
+
+	telemetryService();
+}
+
+void hostLinkPutString(const char8 *s)
+{
+	UART_UartPutString(s);
+}
+
+void hostLinkPutArray(const uint8 *buf, uint32 count)
+{
+	UART_SpiUartPutArray(buf, count);
+}
+
+#endif
+/* [] END OF FILE */
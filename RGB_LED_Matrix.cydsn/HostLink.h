@@ -0,0 +1,48 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef HostLink_h_
+#define HostLink_h_
+#include <device.h>
+
+/* The host link needs an SCB UART Component named "UART" (115200 8N1) placed
+ * in TopDesign - the same port the Processing sketches talk to.
+ * Leave this at 0 on boards built without it.
+ */
+#define HOSTLINK_ENABLE				0
+
+/* Single byte commands sent by the host */
+#define HOSTLINK_CMD_TELEMETRY		'T'		/* send one telemetry snapshot */
+#define HOSTLINK_CMD_PERIODIC		'P'		/* toggle periodic telemetry */
+#define HOSTLINK_CMD_ANIM_ROW		'A'		/* row lo, row hi, 128 data bytes, 8-bit sum */
+#define HOSTLINK_CMD_SETTING		'S'		/* key, value lo, value hi (see Settings.h) */
+
+/* Replies to commands that carry data */
+#define HOSTLINK_ACK				'K'
+#define HOSTLINK_NAK				'E'
+
+/* Longest gap allowed between bytes of one command */
+#define HOSTLINK_TIMEOUT_MS			100u
+
+#if HOSTLINK_ENABLE
+void hostLinkStart(void);
+void hostLinkService(void);
+void hostLinkPutString(const char8 *s);
+void hostLinkPutArray(const uint8 *buf, uint32 count);
+#else
+#define hostLinkStart()
+#define hostLinkService()
+#define hostLinkPutString(s)
+#define hostLinkPutArray(buf, count)
+#endif
+
+#endif
+//[] END OF FILE
@@ -36,6 +36,21 @@ uint8 bcdToDec( uint8 val )
     return (uint8) ((val / 16 * 10) + (val % 16));
 }
 
+/* 24h BCD hour to 12h BCD hour (0 -> 12, 13 -> 1 ...) */
+uint8 bcdTo12Hour(uint8 hour)
+{
+    uint8 h = bcdToDec(hour);
+    if(h == 0)
+    {
+        h = 12;
+    }
+    else if(h > 12)
+    {
+        h = h - 12;
+    }
+    return decToBcd(h);
+}
+
 void localTimeInit(PCF8583 *RTC)
 {
 	RTC->hour = 12;
@@ -32,6 +32,7 @@ typedef struct PCF8583_Tag
 void localTimeInit(PCF8583 *RTC);
 uint8 decToBcd(uint8 val);
 uint8 bcdToDec(uint8 val);
+uint8 bcdTo12Hour(uint8 hour);
 uint8 i2cWrite(uint8 Reg_Addr,uint8 Reg_Data);
 void i2cBurstRead(uint8 Reg_Addr, uint8 *readData,uint8 dataSize);
 uint8 setTime(PCF8583 *RTC);
@@ -20,272 +20,1895 @@
 #include <device.h>
 #include <LED_Matrix.h>
 #include <stdlib.h>
+#include "Telemetry.h"
+#include "Timebase.h"
 
+/* 8-bit channel value to plane value in quarter steps, gamma 2.2:
+ * round(124 * (i / 255) ^ 2.2). The top 5 bits go to the bit planes; the
+ * low 2 are dithered with LED_MATRIX_DITHER and rounded away without it.
+ */
+static const uint8 gammaQ[256] =
+{
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,
+	  3,   3,   3,   4,   4,   4,   4,   4,   4,   5,   5,   5,   5,   5,   6,   6,
+	  6,   6,   6,   7,   7,   7,   7,   7,   8,   8,   8,   8,   9,   9,   9,   9,
+	 10,  10,  10,  10,  11,  11,  11,  12,  12,  12,  13,  13,  13,  13,  14,  14,
+	 14,  15,  15,  15,  16,  16,  17,  17,  17,  18,  18,  18,  19,  19,  20,  20,
+	 20,  21,  21,  22,  22,  22,  23,  23,  24,  24,  24,  25,  25,  26,  26,  27,
+	 27,  28,  28,  29,  29,  30,  30,  31,  31,  32,  32,  33,  33,  34,  34,  35,
+	 35,  36,  36,  37,  37,  38,  39,  39,  40,  40,  41,  41,  42,  43,  43,  44,
+	 44,  45,  46,  46,  47,  48,  48,  49,  50,  50,  51,  51,  52,  53,  53,  54,
+	 55,  56,  56,  57,  58,  58,  59,  60,  60,  61,  62,  63,  63,  64,  65,  66,
+	 66,  67,  68,  69,  70,  70,  71,  72,  73,  73,  74,  75,  76,  77,  78,  78,
+	 79,  80,  81,  82,  83,  83,  84,  85,  86,  87,  88,  89,  90,  91,  91,  92,
+	 93,  94,  95,  96,  97,  98,  99, 100, 101, 102, 103, 104, 105, 106, 107, 108,
+	109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124
+};
+
+uint8 bcmPeriod[BCM_PLANES] = {BCM_UNIT_MAX, BCM_UNIT_MAX << 1, BCM_UNIT_MAX << 2, BCM_UNIT_MAX << 3, BCM_UNIT_MAX << 4};
+volatile uint8 bcmFirstPlane = 0;
+
+#if !LED_MATRIX_HW_BCM
+/* without hardware OE the brightness has to go into the plane values */
+static uint8 brightness = 255;
+#endif
+
+/*******************************************************************************
+* Function Name: setBrightness
+********************************************************************************
+*
+* Summary:
+*  Sets the global brightness. With LED_MATRIX_HW_BCM it scales the OE window
+*  of every plane and takes effect at once; otherwise it only applies to
+*  pixels drawn afterwards.
+*
+* Parameters:  
+*   uint8 level: 	0 (off) to 255 (full)
+*
+*******************************************************************************/
+void setBrightness(uint8 level)
+{
+#if LED_MATRIX_HW_BCM
+	uint8 i;
+
+	/* rounded up, so no plane goes dark before the level is 0; the periods
+	 * stay exact at 255 and grow with the plane and the level. At the lowest
+	 * levels the LSB planes then weigh a unit or two more than binary.
+	 */
+	for(i = 0; i < BCM_PLANES; i++)
+	{
+		bcmPeriod[i] = (uint8)(((uint16)(BCM_UNIT_MAX << i) * level + 254u) / 255u);
+	}
+#else
+	brightness = level;
+#endif
+}
+
+#if LED_MATRIX_HW_BCM
+/*******************************************************************************
+* Function Name: setColorDepth
+********************************************************************************
+*
+* Summary:
+*  Sets how many bit planes the refresh shows, from the most significant down.
+*  The planes below are neither shifted nor lit, so every plane dropped saves
+*  its FIFO fill and shift time; the refresh ISR switches over at the start of
+*  the next frame. The framebuffer keeps all BCM_PLANES planes.
+*
+* Parameters:  
+*   uint8 planes: 	1 to BCM_PLANES
+*
+*******************************************************************************/
+void setColorDepth(uint8 planes)
+{
+	if(planes < 1u)
+	{
+		planes = 1u;
+	}
+	else if(planes > BCM_PLANES)
+	{
+		planes = BCM_PLANES;
+	}
+	bcmFirstPlane = BCM_PLANES - planes;
+}
+
+uint8 getColorDepth(void)
+{
+	return BCM_PLANES - bcmFirstPlane;
+}
+#endif
+
+/*******************************************************************************
+* Function Name: waitFrameStart
+********************************************************************************
+*
+* Summary:
+*  Flash row writes stall the CPU, ISRs included, for several milliseconds.
+*  Starting one right after the refresh ISR wraps to the first row of its
+*  downward scan keeps the hiccup off a frame that is half scanned.
+*  Busy-waits until then: with the refresh running that is less than one
+*  frame, 8 rows of up to BCM_PLANES planes or well under a millisecond, and
+*  maxMs only bounds it should it be stopped.
+*
+* Parameters:
+*   uint8 maxMs: 	longest wait
+*
+*******************************************************************************/
+void waitFrameStart(uint8 maxMs)
+{
+	uint8 frame = refreshFrames;
+	uint32 start = timebaseMillis();
+
+	while((refreshFrames == frame) && ((timebaseMillis() - start) < maxMs))
+	{
+	}
+}
+
+static uint8 toQuarters(uint8 v)
+{
+#if LED_MATRIX_HW_BCM
+	return gammaQ[v];
+#else
+	return (uint8)(((uint16)gammaQ[v] * brightness + 127u) / 255u);
+#endif
+}
+
+#if LED_MATRIX_DITHER
+/* Quarter-step remainder of every pixel, two planes per channel in the same
+ * lane layout as 'matrix'
+ */
+typedef struct
+{
+	uint8 r[2];
+	uint8 g[2];
+	uint8 b[2];
+} fraction;
+
+static fraction ditherFrac[MATRIX_LANES];
+static uint8 ditherPhase = 0;
+static uint8 ditherFrame = 0;
+
+/* 2x2 ordered pattern. A pixel shows one step more in the frames where
+ * (ditherOffset + phase) & 3 is below its remainder, so a remainder of n
+ * is on for n frames out of 4 and neighbours take turns.
+ */
+static const uint8 ditherOffset[2][2] = {{0, 2}, {3, 1}};
+
+/* Pixels of a lane whose remainder is above t */
+static uint8 fracAbove(const uint8 *frac, uint8 t)
+{
+	switch(t)
+	{
+		case 0:
+			return frac[0] | frac[1];
+		case 1:
+			return frac[1];
+		case 2:
+			return frac[0] & frac[1];
+		default:
+			return 0;
+	}
+}
+
+/* Pixels of a lane on row y that show the extra step in 'phase' */
+static uint8 carryMask(const uint8 *frac, uint8 y, uint8 phase)
+{
+	return (fracAbove(frac, (ditherOffset[y & 1u][0] + phase) & 3u) & 0x55u) |
+		(fracAbove(frac, (ditherOffset[y & 1u][1] + phase) & 3u) & 0xAAu);
+}
+
+/* Stores the remainder of quarter value q for one pixel and returns the plane
+ * value to show in the current phase. q <= 124, so this never passes 31.
+ */
+static uint8 ditherChannel(uint8 *frac, uint8 mask, uint8 t, uint8 q)
+{
+	frac[0] = (q & 0x01u) ? (frac[0] | mask) : (frac[0] & ~mask);
+	frac[1] = (q & 0x02u) ? (frac[1] | mask) : (frac[1] & ~mask);
+	return (q >> 2) + ((q & 0x03u) > t);
+}
+
+/*******************************************************************************
+* Function Name: ditherService
+********************************************************************************
+*
+* Summary:
+*  Moves the dither pattern on by one phase once per refresh frame. Only
+*  pixels whose extra step changes are touched: each lane adds or removes one
+*  step with a bit-sliced increment or decrement over its 5 planes, so the
+*  refresh ISR is unchanged. Call every main loop pass.
+*
+* Parameters:  
+* 	color *matrix: 	pointer to the matrix buffer
+*
+*******************************************************************************/
+void ditherService(color *matrix)
+{
+	uint16 lane;
+	uint8 y, ch, i, prev, next, inc, dec, t, phase, interrupts;
+	uint8 p[5];
+	uint8 *planes;
+	const uint8 *frac;
+
+	if(refreshFrames == ditherFrame)
+	{
+		return;
+	}
+	ditherFrame = refreshFrames;
+	phase = (ditherPhase + 1u) & 3u;
+
+	TELEMETRY_STAMP(ditherStart);
+	for(lane = 0; lane < MATRIX_LANES; lane++)
+	{
+		y = (uint8)(lane / MATRIX_ROW_BYTES);
+		for(ch = 0; ch < 3u; ch++)
+		{
+			frac = (const uint8 *)&ditherFrac[lane] + ch * 2u;
+			prev = carryMask(frac, y, ditherPhase);
+			next = carryMask(frac, y, phase);
+			inc = next & ~prev;
+			dec = prev & ~next;
+			if((inc | dec) == 0u)
+			{
+				continue;
+			}
+
+			planes = (uint8 *)&matrix[lane] + ch * 5u;
+			for(i = 0; i < 5u; i++)
+			{
+				p[i] = planes[i];
+			}
+			for(i = 0; i < 5u; i++)
+			{
+				t = p[i] & inc;
+				p[i] ^= inc;
+				inc = t;
+				t = ~p[i] & dec;
+				p[i] ^= dec;
+				dec = t;
+			}
+
+			/* all planes of the lane at once, or a scan could catch half a carry */
+			interrupts = CyEnterCriticalSection();
+			for(i = 0; i < 5u; i++)
+			{
+				planes[i] = p[i];
+			}
+			CyExitCriticalSection(interrupts);
+		}
+	}
+	ditherPhase = phase;
+	TELEMETRY_RECORD(TLM_STAT_DITHER, ditherStart);
+}
+#endif
+
+#if CANVAS_MAPPED
+static const uint8 canvasRotation[PANEL_CHAIN] = CANVAS_ROTATION;
+
+/* Canvas coordinates to chain stream coordinates. Returns 0 off the canvas. */
+static uint8 canvasMap(int8 *x, int8 *y)
+{
+	uint8 tx, ty, lx, ly, px, py, pos;
+
+	if((*x < 0) || (*x >= CANVAS_WIDTH) || (*y < 0) || (*y >= CANVAS_HEIGHT))
+	{
+		return 0;
+	}
+	tx = (uint8)*x / PANEL_WIDTH;
+	lx = (uint8)*x % PANEL_WIDTH;
+	ty = (uint8)*y / PANEL_HEIGHT;
+	ly = (uint8)*y % PANEL_HEIGHT;
+
+	/* tile to position along the chain */
+#if CANVAS_ORDER == CANVAS_ROWS
+#if CANVAS_SERPENTINE
+	if(ty & 1u)
+	{
+		tx = CANVAS_TILES_X - 1u - tx;
+	}
+#endif
+	pos = ty * CANVAS_TILES_X + tx;
+#else
+#if CANVAS_SERPENTINE
+	if(tx & 1u)
+	{
+		ty = CANVAS_TILES_Y - 1u - ty;
+	}
+#endif
+	pos = tx * CANVAS_TILES_Y + ty;
+#endif
+
+	/* undo the panel's mounting */
+	switch(canvasRotation[pos] & 3u)
+	{
+		case 1:
+			px = ly;
+			py = PANEL_HEIGHT - 1u - lx;
+			break;
+		case 2:
+			px = PANEL_WIDTH - 1u - lx;
+			py = PANEL_HEIGHT - 1u - ly;
+			break;
+		case 3:
+			px = PANEL_WIDTH - 1u - ly;
+			py = lx;
+			break;
+		default:
+			px = lx;
+			py = ly;
+			break;
+	}
+
+	/* the first panel on the chain gets the columns shifted last */
+	*x = (int8)((PANEL_CHAIN - 1u - pos) * PANEL_WIDTH + px);
+	*y = (int8)py;
+	return 1;
+}
+#endif
+
+/* Clip rectangle in canvas coordinates, inclusive. Every primitive clips
+ * against it once, so the pixel writers below it need no checks.
+ */
+static int8 clipLeft = 0;
+static int8 clipTop = 0;
+static int8 clipRight = SURFACE_WIDTH - 1;
+static int8 clipBottom = SURFACE_HEIGHT - 1;
+
+/*******************************************************************************
+* Function Name: setClipRect
+********************************************************************************
+*
+* Summary:
+*  Restricts all drawing to a w x h rectangle at (x,y), cut down to the
+*  canvas (the virtual canvas with LED_MATRIX_SCROLL). An empty rectangle stops drawing until resetClipRect().
+*
+*******************************************************************************/
+void setClipRect(int8 x, int8 y, int8 w, int8 h)
+{
+	int16 left = (x < 0) ? 0 : x, top = (y < 0) ? 0 : y;
+	int16 right = (int16)x + w - 1, bottom = (int16)y + h - 1;
+
+	if(right > SURFACE_WIDTH - 1)
+	{
+		right = SURFACE_WIDTH - 1;
+	}
+	if(bottom > SURFACE_HEIGHT - 1)
+	{
+		bottom = SURFACE_HEIGHT - 1;
+	}
+	if((right < left) || (bottom < top))
+	{
+		/* nothing passes */
+		left = 1;
+		right = 0;
+		top = 0;
+		bottom = 0;
+	}
+	clipLeft = (int8)left;
+	clipTop = (int8)top;
+	clipRight = (int8)right;
+	clipBottom = (int8)bottom;
+}
+
+/* Back to the whole canvas */
+void resetClipRect(void)
+{
+	clipLeft = 0;
+	clipTop = 0;
+	clipRight = SURFACE_WIDTH - 1;
+	clipBottom = SURFACE_HEIGHT - 1;
+}
+
+static uint8 clipPoint(int16 x, int16 y)
+{
+	return (x >= clipLeft) && (x <= clipRight) && (y >= clipTop) && (y <= clipBottom);
+}
+
+/* 1 when the box lies wholly inside the clip rectangle */
+static uint8 clipBox(int16 left, int16 top, int16 right, int16 bottom)
+{
+	return (left >= clipLeft) && (right <= clipRight) && (top >= clipTop) && (bottom <= clipBottom);
+}
+
+#if LED_MATRIX_PALETTE
+/* Palette index of every pixel, two pixels per byte with the even x in the
+ * low nibble. Chain stream coordinates, or the virtual canvas when scrolling.
+ */
+#if CANVAS_MAPPED
+#define INDEX_WIDTH				MATRIX_WIDTH
+#define INDEX_HEIGHT			MATRIX_HEIGHT
+#else
+#define INDEX_WIDTH				SURFACE_WIDTH
+#define INDEX_HEIGHT			SURFACE_HEIGHT
+#endif
+static uint8 pixelIndex[INDEX_HEIGHT * INDEX_WIDTH / 2];
+
+/* Top left corner of the window on the panel, taken from scrollX/scrollY as
+ * the expansion of a frame starts
+ */
+static uint8 viewX = 0;
+static uint8 viewY = 0;
+#if LED_MATRIX_SCROLL
+static volatile uint8 scrollX = 0;
+static volatile uint8 scrollY = 0;
+#endif
+
+/* Palette entries as plane values: bit ch*5 + i is plane i of channel ch,
+ * in the order of 'color' (r, g, b)
+ */
+#define PALETTE_BITS(r, g, b)	((uint16)(r) | ((uint16)(g) << 5) | ((uint16)(b) << 10))
+
+/* 0 - 7 the primaries at full, 8 - 15 at half (plane value 7 for 128) */
+static uint16 paletteBits[PALETTE_SIZE] =
+{
+	PALETTE_BITS(0, 0, 0),		PALETTE_BITS(31, 0, 0),		PALETTE_BITS(0, 31, 0),		PALETTE_BITS(31, 31, 0),
+	PALETTE_BITS(0, 0, 31),		PALETTE_BITS(31, 0, 31),	PALETTE_BITS(0, 31, 31),	PALETTE_BITS(31, 31, 31),
+	PALETTE_BITS(0, 0, 0),		PALETTE_BITS(7, 0, 0),		PALETTE_BITS(0, 7, 0),		PALETTE_BITS(7, 7, 0),
+	PALETTE_BITS(0, 0, 7),		PALETTE_BITS(7, 0, 7),		PALETTE_BITS(0, 7, 7),		PALETTE_BITS(7, 7, 7)
+};
+
+static uint8 planeValue(uint8 v)
+{
+	return (uint8)((toQuarters(v) + 2u) >> 2);
+}
+
+/*******************************************************************************
+* Function Name: paletteSet
+********************************************************************************
+*
+* Summary:
+*  Sets palette entry n. Every pixel drawn with it changes color from the next
+*  refresh frame, nothing is redrawn. Entry 0 is what clearPixel and
+*  clearScreen leave behind, so it also sets the background.
+*
+* Parameters:  
+*   uint8 n: 		0 to PALETTE_SIZE - 1
+*	RGB c:			8-bit color, through the gamma table like drawPixel
+*
+*******************************************************************************/
+void paletteSet(uint8 n, RGB c)
+{
+	if(n < PALETTE_SIZE)
+	{
+		paletteBits[n] = PALETTE_BITS(planeValue(c.r), planeValue(c.g), planeValue(c.b));
+	}
+}
+
+/* Entry closest to c, an exact match if there is one. Searching from the top
+ * lets the entries main loads from the settings win over the defaults.
+ */
+static uint8 paletteNearest(RGB c)
+{
+	uint8 r = planeValue(c.r), g = planeValue(c.g), b = planeValue(c.b);
+	uint8 n = PALETTE_SIZE, best = 0, d, bestD = 0xFFu;
+	uint16 bits;
+
+	while(n-- > 0u)
+	{
+		bits = paletteBits[n];
+		d = (uint8)(abs((int16)(bits & 0x1Fu) - r) + abs((int16)((bits >> 5) & 0x1Fu) - g) +
+			abs((int16)((bits >> 10) & 0x1Fu) - b));
+		if(d < bestD)
+		{
+			bestD = d;
+			best = n;
+			if(d == 0u)
+			{
+				break;
+			}
+		}
+	}
+	return best;
+}
+
+static void putIndex(uint8 x, uint8 y, uint8 n)
+{
+	uint8 *p = &pixelIndex[((uint16)y * INDEX_WIDTH + x) >> 1];
+
+	*p = (x & 1u) ? (uint8)((*p & 0x0Fu) | (n << 4)) : (uint8)((*p & 0xF0u) | n);
+}
+
+/* canvas coordinates, already clipped */
+static void putPixelIndex(int8 x, int8 y, uint8 n)
+{
+#if CANVAS_MAPPED
+	canvasMap(&x, &y);
+#endif
+	putIndex((uint8)x, (uint8)y, n);
+}
+
+/*******************************************************************************
+* Function Name: drawPixelIndex
+********************************************************************************
+*
+* Summary:
+*  Sets the (x,y) pixel to palette entry n
+*
+* Parameters:  
+*   uint8 x: 		betn 0 and CANVAS_WIDTH - 1
+*	uint8 y: 		betn 0 and CANVAS_HEIGHT - 1
+*	uint8 n:		palette entry, 0 to PALETTE_SIZE - 1
+*
+*******************************************************************************/
+void drawPixelIndex(int8 x, int8 y, uint8 n)
+{
+	if(clipPoint(x, y))
+	{
+		putPixelIndex(x, y, n & (PALETTE_SIZE - 1u));
+	}
+}
+
+/*******************************************************************************
+* Function Name: paletteExpandRow
+********************************************************************************
+*
+* Summary:
+*  Expands scan row 'row' and the row MATRIX_SCAN_ROWS below it from palette
+*  indices into the bit planes of 'matrix', upper half first. Called by the
+*  refresh ISR before it shifts the first plane of the row, while the last
+*  and longest plane of the previous row is lit. With LED_MATRIX_SCROLL the
+*  rows come from the window at the scroll offset, wrapping around the
+*  virtual canvas; row MATRIX_SCAN_ROWS - 1, where the ISR's downward scan
+*  starts, fixes the offset for the whole frame.
+*
+* Parameters:  
+*   uint8 row: 		scan row, 0 to MATRIX_SCAN_ROWS - 1
+* 	color *matrix: 	pointer to the two-row plane buffer
+*
+*******************************************************************************/
+void paletteExpandRow(uint8 row, color *matrix)
+{
+	uint8 half, x, sx, sy, n, i, bit;
+	uint8 *planes = (uint8 *)matrix;
+	const uint8 *src;
+	uint16 bits;
+
+	TELEMETRY_STAMP(expandStart);
+#if LED_MATRIX_SCROLL
+	if(row == MATRIX_SCAN_ROWS - 1u)
+	{
+		viewX = scrollX;
+		viewY = scrollY;
+	}
+#endif
+	for(half = 0; half < 2u; half++)
+	{
+		sy = row + half * MATRIX_SCAN_ROWS + viewY;
+		if(sy >= INDEX_HEIGHT)
+		{
+			sy -= INDEX_HEIGHT;
+		}
+		src = &pixelIndex[(uint16)sy * (INDEX_WIDTH / 2)];
+		for(x = 0, sx = viewX; x < MATRIX_WIDTH; x++, sx = (sx == INDEX_WIDTH - 1) ? 0 : sx + 1)
+		{
+			bit = (uint8)(0x01 << (x % 8));
+			if(bit == 0x01u)
+			{
+				planes = (uint8 *)&matrix[half * MATRIX_ROW_BYTES + x / 8];
+				for(i = 0; i < 15u; i++)
+				{
+					planes[i] = 0;
+				}
+			}
+			n = (sx & 1u) ? (src[sx >> 1] >> 4) : (src[sx >> 1] & 0x0Fu);
+			/* only the set bits, most entries have few */
+			for(bits = paletteBits[n], i = 0; bits != 0u; bits >>= 1, i++)
+			{
+				if(bits & 1u)
+				{
+					planes[i] |= bit;
+				}
+			}
+		}
+	}
+	TELEMETRY_RECORD(TLM_STAT_ROW_EXPAND, expandStart);
+}
+
+#if LED_MATRIX_SCROLL
+/* Scroll position in thousandths of a pixel, so that pixels per second times
+ * elapsed ms adds up exactly whatever the loop rate
+ */
+#define SCROLL_SCALE			1000L
 
+static int32 scrollPosX = 0;
+static int32 scrollPosY = 0;
+static int16 scrollVX = 0;
+static int16 scrollVY = 0;
+static uint8 scrollWrap = 1;
+static uint32 scrollLast = 0;
 
+/* Keeps one axis on the virtual canvas: modulo its size when wrapping,
+ * otherwise stopped at the edges with the window still wholly inside
+ */
+static int32 scrollLimit(int32 pos, int16 size, int16 view)
+{
+	int32 span = (int32)size * SCROLL_SCALE;
+
+	if(scrollWrap)
+	{
+		pos %= span;
+		return (pos < 0) ? pos + span : pos;
+	}
+	span -= (int32)view * SCROLL_SCALE;
+	return (pos < 0) ? 0 : ((pos > span) ? span : pos);
+}
+
+static void scrollPublish(void)
+{
+	scrollPosX = scrollLimit(scrollPosX, VIRTUAL_WIDTH, MATRIX_WIDTH);
+	scrollPosY = scrollLimit(scrollPosY, VIRTUAL_HEIGHT, MATRIX_HEIGHT);
+	scrollX = (uint8)(scrollPosX / SCROLL_SCALE);
+	scrollY = (uint8)(scrollPosY / SCROLL_SCALE);
+}
+
+/*******************************************************************************
+* Function Name: scrollTo
+********************************************************************************
+*
+* Summary:
+*  Puts the top left corner of the panel at (x,y) on the virtual canvas,
+*  from the next frame on.
+*
+*******************************************************************************/
+void scrollTo(int16 x, int16 y)
+{
+	scrollPosX = (int32)x * SCROLL_SCALE;
+	scrollPosY = (int32)y * SCROLL_SCALE;
+	scrollPublish();
+}
+
+/*******************************************************************************
+* Function Name: scrollSpeed
+********************************************************************************
+*
+* Summary:
+*  Starts scrolling at vx, vy pixels per second, negative to the left or up,
+*  0 to stop. scrollService moves the window by elapsed time, so the speed
+*  does not depend on the frame or loop rate.
+*
+* Parameters:  
+*   int16 vx, vy: 	pixels per second
+*	uint8 wrap:		1 for a marquee that wraps around the virtual canvas,
+*					0 to stop where the window reaches its edge
+*
+*******************************************************************************/
+void scrollSpeed(int16 vx, int16 vy, uint8 wrap)
+{
+	scrollVX = vx;
+	scrollVY = vy;
+	scrollWrap = wrap;
+	scrollLast = timebaseMillis();
+	scrollPublish();
+}
+
+/* Advances the scroll by the time since the last call. Call every main loop pass. */
+void scrollService(void)
+{
+	uint32 now = timebaseMillis();
+	int32 dt = (int32)(now - scrollLast);
+
+	scrollLast = now;
+	if((scrollVX | scrollVY) != 0)
+	{
+		scrollPosX += (int32)scrollVX * dt;
+		scrollPosY += (int32)scrollVY * dt;
+		scrollPublish();
+	}
+}
+#endif
+#else
+
+static void clearBits(uint16 index, uint8 bit_pos, color *matrix)
+{
+	uint8 i;
+	
+	for(i = 0; i < 5 ; i++)
+	{
+		matrix[index].r[i] &= ~(uint8)(0x01<<(bit_pos));
+		matrix[index].g[i] &= ~(uint8)(0x01<<(bit_pos));
+		matrix[index].b[i] &= ~(uint8)(0x01<<(bit_pos));
+	}
+#if LED_MATRIX_DITHER
+	for(i = 0; i < 2 ; i++)
+	{
+		ditherFrac[index].r[i] &= ~(uint8)(0x01<<(bit_pos));
+		ditherFrac[index].g[i] &= ~(uint8)(0x01<<(bit_pos));
+		ditherFrac[index].b[i] &= ~(uint8)(0x01<<(bit_pos));
+	}
+#endif
+}
+#endif
+
+/* Unchecked pixel write, canvas coordinates already clipped */
+#if LED_MATRIX_PALETTE
+static void putPixel(int8 x, int8 y, RGB c, color *matrix)
+{
+	/* the nearest palette entry; 'matrix' belongs to the refresh ISR */
+	(void)matrix;
+	putPixelIndex(x, y, paletteNearest(c));
+}
+#else
+static void putPixel(int8 x, int8 y, RGB c, color *matrix)
+{
+	/* pre-calculate some values to index the matrix 
+	 * Note that the translation has been done here to
+	 * leave the ISR clean
+	 */
+	int8 i = 0;
+	int16 index, scratch1;
+	int8 scratch2, bit_pos;
+#if LED_MATRIX_DITHER
+	uint8 threshold;
+#endif
+	
+#if CANVAS_MAPPED
+	canvasMap(&x, &y);
+#endif
+	
+	/* index indexes the elements of 'matrix' 
+	 * 'matrix' consists of MATRIX_LANES 'color' structs, MATRIX_ROW_BYTES per row
+	 * The formula for index thus is index = y*MATRIX_ROW_BYTES + x/8
+	 */
+	scratch1 = y*MATRIX_ROW_BYTES;
+	
+	/* The x-coordinate is broken up into 2 parts:
+	* 1. Which of the MATRIX_ROW_BYTES FIFO bytes need to be written (scratch2)
+	* 2. Which bit of that byte needs to be written (bit_pos)
+	*/
+	scratch2 = (int8)(x/8);
+	bit_pos = (int8)x%8;
+#if LED_MATRIX_DITHER
+	threshold = (ditherOffset[y & 1][x & 1] + ditherPhase) & 3u;
+#endif
+	
+	index = scratch1 + scratch2;
+	
+	clearBits(index, bit_pos, matrix);
+	
+	c.r = toQuarters(c.r);
+	c.g = toQuarters(c.g);
+	c.b = toQuarters(c.b);
+#if LED_MATRIX_DITHER
+	c.r = ditherChannel(ditherFrac[index].r, (uint8)(0x01 << bit_pos), threshold, c.r);
+	c.g = ditherChannel(ditherFrac[index].g, (uint8)(0x01 << bit_pos), threshold, c.g);
+	c.b = ditherChannel(ditherFrac[index].b, (uint8)(0x01 << bit_pos), threshold, c.b);
+#else
+	c.r = (c.r + 2u) >> 2;
+	c.g = (c.g + 2u) >> 2;
+	c.b = (c.b + 2u) >> 2;
+#endif
+	
+	for(i = 0; i < 5 ; i++)
+	{
+		matrix[index].r[i] |= (int8)((int8)((c.r & (0x01 << i)) && 1)<<(bit_pos));
+		matrix[index].g[i] |= (int8)((int8)((c.g & (0x01 << i)) && 1)<<(bit_pos));
+		matrix[index].b[i] |= (int8)((int8)((c.b & (0x01 << i)) && 1)<<(bit_pos));
+	}
+}
+#endif
+
+/*******************************************************************************
+* Function Name: DrawPixel
+********************************************************************************
+*
+* Summary:
+*  This function writes to the (x,y) coordinate of the 'matrix' buffer in RAM.
+*  Pixels outside the clip rectangle are dropped.
+*
+* Parameters:  
+*   uint8 x: 		betn 0 and CANVAS_WIDTH - 1
+*	uint8 y: 		betn 0 and CANVAS_HEIGHT - 1
+*	RGB c:			8-bit color to be written to the pixel 
+* 	color *matrix: 	pointer to the matrix buffer
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+void drawPixel(int8 x, int8 y, RGB c, color *matrix)
+{
+	if(clipPoint(x, y))
+	{
+		putPixel(x, y, c, matrix);
+	}
+}
 
 /*******************************************************************************
-* Function Name: DrawPixel
+* Function Name: ClearPixel
 ********************************************************************************
 *
 * Summary:
-*  This function writes to the (x,y) coordinate of the 'matrix' buffer in RAM
+*  This function clears the (x,y) pixel of the matrix buffer
 *
 * Parameters:  
-*   uint8 x: 		betn 0 and 31
-*	uint8 y: 		betn 0 and 15
-*	RGB c:			5-bit color to be written to the pixel 
+*   uint8 x: 		betn 0 and CANVAS_WIDTH - 1
+*	uint8 y: 		betn 0 and CANVAS_HEIGHT - 1
 * 	color *matrix: 	pointer to the matrix buffer
 *
 * Return:
 *   None
 *
 *******************************************************************************/
-void drawPixel(int8 x, int8 y, RGB c, color *matrix)
+void clearPixel(uint8 x, uint8 y, color *matrix)
 {
-	/* pre-calculate some values to index the matrix 
-	 * Note that the translation has been done here to
-	 * leave the ISR clean
-	 */
-	int8 i = 0, index;
-	
-	/* index indexes the elements of 'matrix' 
-	 * 'matrix' consists of 64 'color' structs, 4 elements per row
-	 * The formula for index thus is index = y*4 + x/8
-	 */
-	int8 scratch1 = y*4;
+#if LED_MATRIX_PALETTE
+	(void)matrix;
+	drawPixelIndex((int8)x, (int8)y, 0);
+#else
+#if CANVAS_MAPPED
+	int8 cx = (int8)x, cy = (int8)y;
+#endif
 	
-	/* The x-coordinate is broken up into 2 parts:
-	* 1. Which of the 4 FIFO bytes need to be written (scratch2)
-	* 2. Which bit of that byte needs to be written (bit_pos)
-	*/
-	int8 scratch2 = (int8)(x/8);
-	int8 bit_pos = (int8)x%8;
+	if(!clipPoint((int8)x, (int8)y))
+	{
+		return;
+	}
+#if CANVAS_MAPPED
+	canvasMap(&cx, &cy);
+	x = (uint8)cx;
+	y = (uint8)cy;
+#endif
 	
-	index = scratch1 + scratch2;
+	clearBits((uint16)y*MATRIX_ROW_BYTES + x/8, (uint8)x%8, matrix);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: ClearScreen
+********************************************************************************
+*
+* Summary:
+*  This function clears the 'matrix' buffer in RAM
+*
+* Parameters:  
+* 	color *matrix: 	pointer to the matrix buffer
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+void clearScreen(color *matrix)
+{
+	uint16 index;
 	
-	clearPixel(x, y, matrix);
+#if LED_MATRIX_PALETTE
+	/* to entry 0; 'matrix' is refilled by the ISR row by row */
+	(void)matrix;
+	for(index = 0; index < sizeof(pixelIndex); index++)
+	{
+		pixelIndex[index] = 0x00;
+	}
+#else
+	uint8 x;
 	
-	for(i = 0; i < 5 ; i++)
+	for(index = 0; index < MATRIX_LANES; index++)
+	{
+		for(x = 0; x < 5 ; x++)
+		{
+			matrix[index].r[x] = 0x00;
+			matrix[index].g[x] = 0x00;
+			matrix[index].b[x] = 0x00;
+		}
+#if LED_MATRIX_DITHER
+		for(x = 0; x < 2 ; x++)
+		{
+			ditherFrac[index].r[x] = 0x00;
+			ditherFrac[index].g[x] = 0x00;
+			ditherFrac[index].b[x] = 0x00;
+		}
+#endif
+	}
+#endif
+}
+
+static uint16 inkOf(RGB c)
+{
+#if LED_MATRIX_PALETTE
+	return paletteNearest(c);
+#else
+	/* bit ch*5 + i is plane i of channel ch, the byte order of 'color' */
+	return (uint16)((toQuarters(c.r) + 2u) >> 2) | ((uint16)((toQuarters(c.g) + 2u) >> 2) << 5) |
+		((uint16)((toQuarters(c.b) + 2u) >> 2) << 10);
+#endif
+}
+
+/* A color converted once per primitive for the span writer */
+typedef struct
+{
+	RGB c;					/* for the per-pixel paths */
+	uint16 ink;				/* inkOf(c) */
+} Paint;
+
+static void paintOf(Paint *p, RGB c)
+{
+	p->c = c;
+	p->ink = inkOf(c);
+}
+
+/* Unchecked horizontal run x0..x1 (x0 <= x1) on row y, clipped by the
+ * caller. Without mapping or dithering each lane byte of the run takes the
+ * color in one masked write per plane.
+ */
+static void putSpan(int16 x0, int16 x1, int16 y, const Paint *p, color *matrix)
+{
+#if CANVAS_MAPPED || LED_MATRIX_DITHER
+	for(; x0 <= x1; x0++)
+	{
+		putPixel((int8)x0, (int8)y, p->c, matrix);
+	}
+#elif LED_MATRIX_PALETTE
+	(void)matrix;
+	for(; x0 <= x1; x0++)
+	{
+		putIndex((uint8)x0, (uint8)y, (uint8)p->ink);
+	}
+#else
+	color *lane = &matrix[MATRIX_LANE(x0, y)];
+	color *last = &matrix[MATRIX_LANE(x1, y)];
+	uint8 i, mask, *planes;
+	uint16 bits;
+
+	mask = (uint8)(0xFFu << (x0 % 8));
+	for(; lane <= last; lane++)
+	{
+		if(lane == last)
+		{
+			mask &= (uint8)(0xFFu >> (7 - x1 % 8));
+		}
+		planes = (uint8 *)lane;
+		for(i = 0, bits = p->ink; i < 15u; i++, bits >>= 1)
+		{
+			planes[i] = (bits & 1u) ? (planes[i] | mask) : (planes[i] & ~mask);
+		}
+		mask = 0xFFu;
+	}
+#endif
+}
+
+/* Clips a horizontal run once, then writes it */
+static void drawSpan(int16 x0, int16 x1, int16 y, const Paint *p, color *matrix)
+{
+	if(x0 > x1)
+	{
+		int16 t = x0;
+		x0 = x1;
+		x1 = t;
+	}
+	if((y < clipTop) || (y > clipBottom) || (x1 < clipLeft) || (x0 > clipRight))
+	{
+		return;
+	}
+	putSpan((x0 < clipLeft) ? clipLeft : x0, (x1 > clipRight) ? clipRight : x1, y, p, matrix);
+}
+
+/* Cohen-Sutherland region code of a point against the surface. Lines step
+ * from their ends cut to the surface, not to the clip rectangle, so that a
+ * clip rectangle only drops pixels of a line and never moves them.
+ */
+#define CLIP_LEFT		0x01u
+#define CLIP_RIGHT		0x02u
+#define CLIP_TOP		0x04u
+#define CLIP_BOTTOM		0x08u
+
+static uint8 clipCode(int16 x, int16 y)
+{
+	uint8 code = 0;
+
+	if(x < 0)
+	{
+		code |= CLIP_LEFT;
+	}
+	else if(x > SURFACE_WIDTH - 1)
+	{
+		code |= CLIP_RIGHT;
+	}
+	if(y < 0)
+	{
+		code |= CLIP_TOP;
+	}
+	else if(y > SURFACE_HEIGHT - 1)
+	{
+		code |= CLIP_BOTTOM;
+	}
+	return code;
+}
+
+/* Cuts the segment down to the surface (Cohen-Sutherland). Returns 0
+ * when nothing of it is left.
+ */
+static uint8 clipLine(int16 *x0, int16 *y0, int16 *x1, int16 *y1)
+{
+	uint8 code0 = clipCode(*x0, *y0), code1 = clipCode(*x1, *y1), code;
+	int16 x, y;
+	int32 dx, dy;
+
+	for(;;)
+	{
+		if((code0 | code1) == 0u)
+		{
+			return 1;
+		}
+		if(code0 & code1)
+		{
+			return 0;
+		}
+
+		code = code0 ? code0 : code1;
+		dx = (int32)*x1 - *x0;
+		dy = (int32)*y1 - *y0;
+		if(code & CLIP_TOP)
+		{
+			y = 0;
+			x = (int16)(*x0 + dx * (y - *y0) / dy);
+		}
+		else if(code & CLIP_BOTTOM)
+		{
+			y = SURFACE_HEIGHT - 1;
+			x = (int16)(*x0 + dx * (y - *y0) / dy);
+		}
+		else if(code & CLIP_LEFT)
+		{
+			x = 0;
+			y = (int16)(*y0 + dy * (x - *x0) / dx);
+		}
+		else
+		{
+			x = SURFACE_WIDTH - 1;
+			y = (int16)(*y0 + dy * (x - *x0) / dx);
+		}
+
+		if(code == code0)
+		{
+			*x0 = x;
+			*y0 = y;
+			code0 = clipCode(x, y);
+		}
+		else
+		{
+			*x1 = x;
+			*y1 = y;
+			code1 = clipCode(x, y);
+		}
+	}
+}
+
+/* drawLine on 16-bit coordinates, so callers adding lengths cannot wrap */
+static void drawLine16(int16 x0, int16 y0, int16 x1, int16 y1, RGB c, color *matrix)
+{
+	int16 dx, dy, err, ystep, t;
+	uint8 steep, whole;
+
+	if(y0 == y1)
+	{
+		Paint p;
+
+		paintOf(&p, c);
+		drawSpan(x0, x1, y0, &p, matrix);
+		return;
+	}
+	if(!clipLine(&x0, &y0, &x1, &y1))
+	{
+		return;
+	}
+
+	/* on the surface now, so unchecked unless the clip rectangle is smaller */
+	whole = (clipLeft == 0) && (clipTop == 0) && (clipRight == SURFACE_WIDTH - 1) &&
+		(clipBottom == SURFACE_HEIGHT - 1);
+	steep = abs(y1 - y0) > abs(x1 - x0);
+	if(steep)
+	{
+		t = x0; x0 = y0; y0 = t;
+		t = x1; x1 = y1; y1 = t;
+	}
+	if(x0 > x1)
+	{
+		t = x0; x0 = x1; x1 = t;
+		t = y0; y0 = y1; y1 = t;
+	}
+
+	dx = x1 - x0;
+	dy = abs(y1 - y0);
+	err = dx / 2;
+	ystep = (y0 < y1) ? 1 : -1;
+
+	if(!whole)
+	{
+		/* nothing past the clip rectangle along the major axis */
+		t = steep ? clipBottom : clipRight;
+		x1 = (x1 > t) ? t : x1;
+	}
+	for(; x0 <= x1; x0++)
+	{
+		if(steep)
+		{
+			if(whole || clipPoint(y0, x0))
+			{
+				putPixel((int8)y0, (int8)x0, c, matrix);
+			}
+		}
+		else if(whole || clipPoint(x0, y0))
+		{
+			putPixel((int8)x0, (int8)y0, c, matrix);
+		}
+		err -= dy;
+		if(err < 0)
+		{
+			y0 += ystep;
+			err += dx;
+		}
+	}
+}
+
+/* Circle points in int16: x0 + r past 127 must not wrap back onto the
+ * surface as an int8 would
+ */
+static void putPoint(int16 x, int16 y, RGB c, color *matrix)
+{
+  putPixel((int8)x, (int8)y, c, matrix);
+}
+
+static void drawPoint(int16 x, int16 y, RGB c, color *matrix)
+{
+  if (clipPoint(x, y)) {
+    putPixel((int8)x, (int8)y, c, matrix);
+  }
+}
+
+void drawCircle(int8 cx, int8 cy, int8 radius,RGB c, color *matrix) {
+  int16 x0 = cx, y0 = cy, r = radius;
+  int16 f = 1 - r;
+  int16 ddF_x = 1;
+  int16 ddF_y = -2 * r;
+  int16 x = 0;
+  int16 y = r;
+  void (*plot)(int16, int16, RGB, color *);
+
+  /* a negative radius would turn the box inside out */
+  if (r < 0 || x0 - r > clipRight || x0 + r < clipLeft || y0 - r > clipBottom || y0 + r < clipTop) {
+    return;
+  }
+  /* clip once: unchecked writes when the circle is wholly inside */
+  plot = clipBox(x0 - r, y0 - r, x0 + r, y0 + r) ? putPoint : drawPoint;
+  plot(x0 , y0+r, c,matrix);
+  plot(x0 , y0-r, c,matrix);
+  plot(x0+r, y0 , c,matrix);
+  plot(x0-r, y0 , c,matrix);
+
+  while (x < y) 
+  {
+    if (f >= 0) 
+	{
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+  
+    plot(x0 + x, y0 + y, c,matrix);
+    plot(x0 - x, y0 + y, c,matrix);
+    plot(x0 + x, y0 - y, c,matrix);
+    plot(x0 - x, y0 - y, c,matrix);
+    plot(x0 + y, y0 + x, c,matrix);
+    plot(x0 - y, y0 + x, c,matrix);
+    plot(x0 + y, y0 - x, c,matrix);
+    plot(x0 - y, y0 - x, c,matrix);
+  }
+
+}
+
+void drawCircleHelper( int8 cx, int8 cy,int8 radius, int8 cornername, RGB c, color *matrix) {
+  int16 x0 = cx, y0 = cy, r = radius;
+  int16 f = 1 - r;
+  int16 ddF_x = 1;
+  int16 ddF_y = -2 * r;
+  int16 x = 0;
+  int16 y = r;
+  void (*plot)(int16, int16, RGB, color *);
+
+  if (r < 0 || x0 - r > clipRight || x0 + r < clipLeft || y0 - r > clipBottom || y0 + r < clipTop) {
+    return;
+  }
+  plot = clipBox(x0 - r, y0 - r, x0 + r, y0 + r) ? putPoint : drawPoint;
+
+  while (x<y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    if (cornername & 0x4) {
+      plot(x0 + x, y0 + y, c, matrix);
+      plot(x0 + y, y0 + x, c, matrix);
+    }
+    if (cornername & 0x2) {
+      plot(x0 + x, y0 - y, c, matrix);
+      plot(x0 + y, y0 - x, c, matrix);
+    }
+    if (cornername & 0x8) {
+      plot(x0 - y, y0 + x, c, matrix);
+      plot(x0 - x, y0 + y, c, matrix);
+    }
+    if (cornername & 0x1) {
+      plot(x0 - y, y0 - x, c, matrix);
+      plot(x0 - x, y0 - y, c, matrix);
+    }
+  }
+}
+
+void drawLine(int8 x0, int8 y0, int8 x1, int8 y1, RGB c, color *matrix)
+{
+  drawLine16(x0, y0, x1, y1, c, matrix);
+}
+
+void drawRect(int16_t x, int16_t y,int16_t w, int16_t h,RGB c, color *matrix) {
+  drawFastHLine(x, y, w, c, matrix);
+  drawFastHLine(x, y+h, w, c, matrix);
+  drawFastVLine(x, y, h, c, matrix);
+  drawFastVLine(x+w, y, h, c, matrix);
+}
+
+void drawFastVLine(int8 x, int8 y, int8 h, RGB c, color *matrix) 
+{
+  int16 top = y, bottom = (int16)y + h;
+
+  if (top > bottom) {
+    top = bottom;
+    bottom = y;
+  }
+  if (x < clipLeft || x > clipRight || bottom < clipTop || top > clipBottom) {
+    return;
+  }
+  if (top < clipTop) {
+    top = clipTop;
+  }
+  if (bottom > clipBottom) {
+    bottom = clipBottom;
+  }
+  for (; top <= bottom; top++) {
+    putPixel(x, (int8)top, c, matrix);
+  }
+}
+
+void drawFastHLine(int8 x, int8 y, int8 w, RGB c, color *matrix) 
+{
+  Paint p;
+
+  paintOf(&p, c);
+  drawSpan(x, (int16)x + w, y, &p, matrix);
+}
+
+/* w x h pixels from (x,y) */
+void fillRect(int8 x, int8 y, int8 w, int8 h, RGB c, color *matrix) 
+{
+  int16 left = x, right = (int16)x + w - 1, top = y, bottom = (int16)y + h - 1;
+  Paint p;
+
+  if (left < clipLeft) {
+    left = clipLeft;
+  }
+  if (right > clipRight) {
+    right = clipRight;
+  }
+  if (top < clipTop) {
+    top = clipTop;
+  }
+  if (bottom > clipBottom) {
+    bottom = clipBottom;
+  }
+  if (left > right) {
+    return;
+  }
+  paintOf(&p, c);
+  for (; top <= bottom; top++) {
+    putSpan(left, right, top, &p, matrix);
+  }
+}
+
+void fillScreen(RGB c, color *matrix)
+{
+  int16 y;
+  Paint p;
+
+  /* the whole surface, clipped: every row of the clip rectangle */
+  paintOf(&p, c);
+  for (y = clipTop; y <= clipBottom; y++) {
+    if (clipLeft <= clipRight) {
+      putSpan(clipLeft, clipRight, y, &p, matrix);
+    }
+  }
+}
+
+/*******************************************************************************
+* Function Name: drawRow
+********************************************************************************
+*
+* Summary:
+*  Writes w pixels of 8-bit color from (x,y) rightwards, clipped. Without
+*  mapping, dithering or a palette the plane bytes of each lane are built in
+*  one pass over its pixels and stored once, instead of a read-modify-write
+*  of all 15 planes per pixel.
+*
+* Parameters:
+*   int8 x, y: 		canvas position of pixels[0]
+*	uint8 w:		pixels in the row
+*	RGB *pixels:	colors, left to right
+* 	color *matrix: 	pointer to the matrix buffer
+*
+*******************************************************************************/
+void drawRow(int8 x, int8 y, uint8 w, const RGB *pixels, color *matrix)
+{
+	int16 x0 = x, x1 = (int16)x + w - 1;
+
+	if((w == 0u) || (y < clipTop) || (y > clipBottom) || (x1 < clipLeft) || (x0 > clipRight))
 	{
-		matrix[index].r[i] |= (int8)((int8)((c.r & (0x01 << i)) && 1)<<(bit_pos));
-		matrix[index].g[i] |= (int8)((int8)((c.g & (0x01 << i)) && 1)<<(bit_pos));
-		matrix[index].b[i] |= (int8)((int8)((c.b & (0x01 << i)) && 1)<<(bit_pos));
+		return;
+	}
+	if(x0 < clipLeft)
+	{
+		pixels += clipLeft - x0;
+		x0 = clipLeft;
+	}
+	if(x1 > clipRight)
+	{
+		x1 = clipRight;
+	}
+#if CANVAS_MAPPED || LED_MATRIX_DITHER || LED_MATRIX_PALETTE
+	for(; x0 <= x1; x0++, pixels++)
+	{
+		putPixel((int8)x0, y, *pixels, matrix);
+	}
+#else
+	{
+		uint8 planes[15], mask = 0, bit, i, *lane;
+		uint16 ink;
+
+		for(i = 0; i < 15u; i++)
+		{
+			planes[i] = 0;
+		}
+		for(; x0 <= x1; x0++, pixels++)
+		{
+			bit = (uint8)(0x01u << (x0 % 8));
+			for(ink = inkOf(*pixels), i = 0; ink != 0u; ink >>= 1, i++)
+			{
+				if(ink & 1u)
+				{
+					planes[i] |= bit;
+				}
+			}
+			mask |= bit;
+			if((bit == 0x80u) || (x0 == x1))
+			{
+				lane = (uint8 *)&matrix[MATRIX_LANE(x0, y)];
+				for(i = 0; i < 15u; i++)
+				{
+					lane[i] = (lane[i] & (uint8)~mask) | planes[i];
+					planes[i] = 0;
+				}
+				mask = 0;
+			}
+		}
 	}
+#endif
 }
 
 /*******************************************************************************
-* Function Name: ClearPixel
+* Function Name: drawRowBits
 ********************************************************************************
 *
 * Summary:
-*  This function clears the (x,y) pixel of the matrix buffer
+*  Writes canvas row y, clipped, from a bitmap: set bits take color 'on',
+*  clear bits 'off'. Without mapping, dithering or a palette every plane
+*  byte of a lane is the bitmap byte, its complement, both or neither.
 *
-* Parameters:  
-*   uint8 x: 		betn 0 and 31
-*	uint8 y: 		betn 0 and 15
+* Parameters:
+*   int8 y: 		canvas row
+*	uint8 *bits:	CANVAS_WIDTH pixels, pixel x in bit x%8 of byte x/8
+*	RGB on, off:	colors of set and clear bits
 * 	color *matrix: 	pointer to the matrix buffer
 *
-* Return:
-*   None
-*
 *******************************************************************************/
-void clearPixel(uint8 x, uint8 y, color *matrix)
+void drawRowBits(int8 y, const uint8 *bits, RGB on, RGB off, color *matrix)
 {
-	uint8 i, index;
-	uint8 scratch1 = y*4;
-	uint8 scratch2 = (uint8)(x/8);
-	uint8 bit_pos = (uint8)x%8;
-	
-	index = scratch1 + scratch2;
-	
-	for(i = 0; i < 5 ; i++)
+	int16 left = clipLeft, right = (clipRight < CANVAS_WIDTH) ? clipRight : CANVAS_WIDTH - 1;
+
+	if((y < clipTop) || (y > clipBottom) || (left > right))
 	{
-		matrix[index].r[i] &= ~(uint8)(0x01<<(bit_pos));
-		matrix[index].g[i] &= ~(uint8)(0x01<<(bit_pos));
-		matrix[index].b[i] &= ~(uint8)(0x01<<(bit_pos));
+		return;
 	}
+#if CANVAS_MAPPED || LED_MATRIX_DITHER || LED_MATRIX_PALETTE
+	for(; left <= right; left++)
+	{
+		putPixel((int8)left, y, (bits[left >> 3] & (1u << (left & 7))) ? on : off, matrix);
+	}
+#else
+	{
+		uint16 onInk = inkOf(on), offInk = inkOf(off), a, b;
+		uint8 lane, i, mask, v, *planes;
+
+		for(lane = (uint8)(left / 8); lane <= right / 8; lane++)
+		{
+			mask = 0xFFu;
+			if(lane == left / 8)
+			{
+				mask &= (uint8)(0xFFu << (left % 8));
+			}
+			if(lane == right / 8)
+			{
+				mask &= (uint8)(0xFFu >> (7 - right % 8));
+			}
+			planes = (uint8 *)&matrix[MATRIX_LANE(lane * 8, y)];
+			for(i = 0, a = onInk, b = offInk; i < 15u; i++, a >>= 1, b >>= 1)
+			{
+				v = (uint8)(((a & 1u) ? bits[lane] : 0u) | ((b & 1u) ? (uint8)~bits[lane] : 0u));
+				planes[i] = (planes[i] & (uint8)~mask) | (v & mask);
+			}
+		}
+	}
+#endif
+}
+
+void drawTriangle(int8 x0, int8 y0,int8 x1, int8 y1,
+						int8 x2, int8 y2, RGB c, color *matrix) 
+{
+  drawLine(x0, y0, x1, y1, c, matrix);
+  drawLine(x1, y1, x2, y2, c, matrix);
+  drawLine(x2, y2, x0, y0, c, matrix);
 }
 
 /*******************************************************************************
-* Function Name: ClearScreen
+* Function Name: fillRounded
 ********************************************************************************
 *
 * Summary:
-*  This function clears the 'matrix' buffer in RAM
-*
-* Parameters:  
-* 	color *matrix: 	pointer to the matrix buffer
-*
-* Return:
-*   None
+*  Fills a disc of radius r cut open at its centre: the left half is centred
+*  on column xl, the right half on xr, the top half on row yt and the bottom
+*  half on yb (xl <= xr, yt <= yb). Equal centres make a plain disc, apart they
+*  make a rounded rectangle. The edge follows the midpoint stepping of
+*  drawCircle and every row goes out as one span, written once.
 *
 *******************************************************************************/
-void clearScreen(color *matrix)
+static void fillRounded(int16 xl, int16 xr, int16 yt, int16 yb, int16 r, RGB c, color *matrix)
 {
-	uint8 x, index;
-	
-	for(index = 0; index < 64; index++)
+	int16 f = 1 - r, ddF_x = 1, ddF_y = -2 * r;
+	int16 x = 0, y = r, px = 0, py = r, row, last;
+	void (*span)(int16, int16, int16, const Paint *, color *);
+	Paint p;
+
+	if((r < 0) || (xl - r > clipRight) || (xr + r < clipLeft) || (yt - r > clipBottom) || (yb + r < clipTop))
 	{
-		for(x = 0; x < 5 ; x++)
+		return;
+	}
+	/* clip once: unchecked spans when the shape is wholly inside */
+	span = clipBox(xl - r, yt - r, xr + r, yb + r) ? putSpan : drawSpan;
+	paintOf(&p, c);
+
+	row = (yt < clipTop) ? clipTop : yt;
+	last = (yb > clipBottom) ? clipBottom : yb;
+	for(; row <= last; row++)
+	{
+		span(xl - r, xr + r, row, &p, matrix);
+	}
+
+	while(x < y)
+	{
+		if(f >= 0)
 		{
-			matrix[index].r[x] = 0x00;
-			matrix[index].g[x] = 0x00;
-			matrix[index].b[x] = 0x00;
+			y--;
+			ddF_y += 2;
+			f += ddF_y;
+		}
+		x++;
+		ddF_x += 2;
+		f += ddF_x;
+
+		/* rows x out are y wide; rows y out only once y has moved on */
+		if(x < y + 1)
+		{
+			span(xl - y, xr + y, yt - x, &p, matrix);
+			span(xl - y, xr + y, yb + x, &p, matrix);
+		}
+		if(y != py)
+		{
+			span(xl - px, xr + px, yt - py, &p, matrix);
+			span(xl - px, xr + px, yb + py, &p, matrix);
+			py = y;
 		}
+		px = x;
 	}
 }
 
-void drawCircle(int8 x0, int8 y0, int8 r,RGB c, color *matrix) {
-  int8 f = 1 - r;
-  int8 ddF_x = 1;
-  int8 ddF_y = -2 * r;
-  int8 x = 0;
-  int8 y = r;
+void fillCircle(int8 x0, int8 y0, int8 r, RGB c, color *matrix)
+{
+	fillRounded(x0, x0, y0, y0, r, c, matrix);
+}
 
-  drawPixel(x0 , y0+r, c,matrix);
-  drawPixel(x0 , y0-r, c,matrix);
-  drawPixel(x0+r, y0 , c,matrix);
-  drawPixel(x0-r, y0 , c,matrix);
+/* w x h pixels from (x,y) with corners of radius r, which shrinks to fit */
+void fillRoundRect(int8 x, int8 y, int8 w, int8 h, int8 r, RGB c, color *matrix)
+{
+	int16 limit = (((w < h) ? w : h) - 1) / 2;
 
-  while (x < y) 
-  {
-    if (f >= 0) 
+	if((w <= 0) || (h <= 0))
 	{
-      y--;
-      ddF_y += 2;
-      f += ddF_y;
-    }
-    x++;
-    ddF_x += 2;
-    f += ddF_x;
-  
-    drawPixel(x0 + x, y0 + y, c,matrix);
-    drawPixel(x0 - x, y0 + y, c,matrix);
-    drawPixel(x0 + x, y0 - y, c,matrix);
-    drawPixel(x0 - x, y0 - y, c,matrix);
-    drawPixel(x0 + y, y0 + x, c,matrix);
-    drawPixel(x0 - y, y0 + x, c,matrix);
-    drawPixel(x0 + y, y0 - x, c,matrix);
-    drawPixel(x0 - y, y0 - x, c,matrix);
-  }
-
+		return;
+	}
+	if(r > limit)
+	{
+		r = (int8)limit;
+	}
+	if(r < 0)
+	{
+		r = 0;
+	}
+	fillRounded((int16)x + r, (int16)x + w - 1 - r, (int16)y + r, (int16)y + h - 1 - r, r, c, matrix);
 }
 
-void drawCircleHelper( int8 x0, int8 y0,int8 r, int8 cornername, RGB c, color *matrix) {
-  int8 f = 1 - r;
-  int8 ddF_x = 1;
-  int8 ddF_y = -2 * r;
-  int8 x = 0;
-  int8 y = r;
+/* A triangle edge stepped one row at a time, x = x0 + floor(dx * t / dy) kept
+ * as a whole part and a remainder: one division per edge, none per row
+ */
+typedef struct
+{
+	int16 x;
+	int16 step;				/* whole columns per row */
+	int16 rem;				/* and the fraction, rem / dy with 0 <= rem < dy */
+	int16 err;
+	int16 dy;
+} Edge;
 
-  while (x<y) {
-    if (f >= 0) {
-      y--;
-      ddF_y += 2;
-      f += ddF_y;
-    }
-    x++;
-    ddF_x += 2;
-    f += ddF_x;
-    if (cornername & 0x4) {
-      drawPixel(x0 + x, y0 + y, c, matrix);
-      drawPixel(x0 + y, y0 + x, c, matrix);
-    }
-    if (cornername & 0x2) {
-      drawPixel(x0 + x, y0 - y, c, matrix);
-      drawPixel(x0 + y, y0 - x, c, matrix);
-    }
-    if (cornername & 0x8) {
-      drawPixel(x0 - y, y0 + x, c, matrix);
-      drawPixel(x0 - x, y0 + y, c, matrix);
-    }
-    if (cornername & 0x1) {
-      drawPixel(x0 - y, y0 - x, c, matrix);
-      drawPixel(x0 - x, y0 - y, c, matrix);
-    }
-  }
+static void edgeStart(Edge *e, int16 x0, int16 y0, int16 x1, int16 y1)
+{
+	e->x = x0;
+	e->dy = y1 - y0;
+	e->err = 0;
+	e->step = 0;
+	e->rem = 0;
+	if(e->dy > 0)
+	{
+		e->step = (x1 - x0) / e->dy;
+		e->rem = (x1 - x0) % e->dy;
+		if(e->rem < 0)
+		{
+			e->step--;
+			e->rem += e->dy;
+		}
+	}
 }
 
-void drawLine(int8 x0, int8 y0, int8 x1, int8 y1, RGB c, color *matrix)
+static void edgeStep(Edge *e)
 {
-  int8 steep = abs(y1 - y0) > abs(x1 - x0);
-  if (steep) {
-    swap(x0, y0);
-    swap(x1, y1);
-  }
+	e->x += e->step;
+	e->err += e->rem;
+	if(e->err >= e->dy)
+	{
+		e->x++;
+		e->err -= e->dy;
+	}
+}
 
-  if (x0 > x1) {
-    swap(x0, x1);
-    swap(y0, y1);
-  }
+/*******************************************************************************
+* Function Name: fillTriangle
+********************************************************************************
+*
+* Summary:
+*  Fills the triangle one span per row between the long edge (top to bottom
+*  vertex) and the two short ones, clipped once.
+*
+*******************************************************************************/
+void fillTriangle(int8 x0, int8 y0, int8 x1, int8 y1, int8 x2, int8 y2, RGB c, color *matrix)
+{
+	int16 ax = x0, ay = y0, bx = x1, by = y1, cx = x2, cy = y2, t;
+	int16 left, right, y;
+	void (*span)(int16, int16, int16, const Paint *, color *);
+	Edge major, minor;
+	Paint p;
 
-  int8 dx, dy;
-  dx = x1 - x0;
-  dy = abs(y1 - y0);
+	/* sort the vertices top to bottom: a, b, c */
+	if(ay > by)
+	{
+		t = ax; ax = bx; bx = t;
+		t = ay; ay = by; by = t;
+	}
+	if(by > cy)
+	{
+		t = bx; bx = cx; cx = t;
+		t = by; by = cy; cy = t;
+	}
+	if(ay > by)
+	{
+		t = ax; ax = bx; bx = t;
+		t = ay; ay = by; by = t;
+	}
 
-  int8 err = dx / 2;
-  int8 ystep;
+	left = (ax < bx) ? ax : bx;
+	left = (cx < left) ? cx : left;
+	right = (ax > bx) ? ax : bx;
+	right = (cx > right) ? cx : right;
+	if((right < clipLeft) || (left > clipRight) || (cy < clipTop) || (ay > clipBottom))
+	{
+		return;
+	}
+	span = clipBox(left, ay, right, cy) ? putSpan : drawSpan;
+	paintOf(&p, c);
 
-  if (y0 < y1) {
-    ystep = 1;
-  } else {
-    ystep = -1;
-  }
+	if(ay == cy)
+	{
+		span(left, right, ay, &p, matrix);
+		return;
+	}
 
-  for (; x0<=x1; x0++) {
-    if (steep) {
-      drawPixel(y0, x0, c, matrix);
-    } else {
-      drawPixel(x0, y0, c, matrix);
-    }
-    err -= dy;
-    if (err < 0) {
-      y0 += ystep;
-      err += dx;
-    }
-  }
+	edgeStart(&major, ax, ay, cx, cy);
+	edgeStart(&minor, ax, ay, bx, by);
+	for(y = ay; (y <= cy) && (y <= clipBottom); y++)
+	{
+		/* the lower short edge takes over at b, unless the bottom is flat */
+		if((y == by) && (by != cy))
+		{
+			edgeStart(&minor, bx, by, cx, cy);
+		}
+		if(y >= clipTop)
+		{
+			if(major.x < minor.x)
+			{
+				span(major.x, minor.x, y, &p, matrix);
+			}
+			else
+			{
+				span(minor.x, major.x, y, &p, matrix);
+			}
+		}
+		edgeStep(&major);
+		edgeStep(&minor);
+	}
 }
 
-void drawRect(int16_t x, int16_t y,int16_t w, int16_t h,RGB c, color *matrix) {
-  drawFastHLine(x, y, w, c, matrix);
-  drawFastHLine(x, y+h, w, c, matrix);
-  drawFastVLine(x, y, h, c, matrix);
-  drawFastVLine(x+w, y, h, c, matrix);
-}
+/* One blit: where the sprite sits and its colors, converted once per call */
+typedef struct
+{
+	int16 x;				/* canvas column of sprite column 0 */
+	int16 left;				/* first and last visible canvas column */
+	int16 right;
+	uint32 visible;			/* sprite columns left to right */
+	const RGB *colors;
+	uint16 ink[16];			/* colors as plane bits, palette entries in palette mode */
+} Blit;
 
-void drawFastVLine(int8 x, int8 y, int8 h, RGB c, color *matrix) 
+/* Clips the sprite columns once. Returns 0 when none are visible. */
+static uint8 blitStart(Blit *b, int8 x, const Sprite *s)
 {
-  // Update in subclasses if desired!
-  drawLine(x, y, x, y+h, c, matrix);
+	b->x = x;
+	b->left = (x < clipLeft) ? clipLeft : x;
+	b->right = (int16)x + s->width - 1;
+	if(b->right > clipRight)
+	{
+		b->right = clipRight;
+	}
+	if((s->width == 0u) || (s->width > SPRITE_MAX_WIDTH) || (b->left > b->right))
+	{
+		return 0;
+	}
+	b->visible = (0xFFFFFFFFu >> (31 - (b->right - x))) & (0xFFFFFFFFu << (b->left - x));
+	return 1;
 }
 
-void drawFastHLine(int8 x, int8 y, int8 w, RGB c, color *matrix) 
+/*******************************************************************************
+* Function Name: blitRow
+********************************************************************************
+*
+* Summary:
+*  Writes the pixels of one sprite row set in 'mask' (bit k = sprite column
+*  k, already cut to the visible columns) to canvas row y. In the plain
+*  plane layout each lane byte is shifted out of the mask and merged into the
+*  planes at once; with mapping, dithering or a palette it goes pixel by
+*  pixel.
+*
+* Parameters:  
+*   Blit *b: 		from blitStart
+*	int16 y:		visible canvas row
+*	uint32 mask:	opaque pixels
+*	uint8 *index:	color of each column, NULL for all b->ink[0]
+* 	color *matrix: 	pointer to the matrix buffer
+*
+*******************************************************************************/
+static void blitRow(const Blit *b, int16 y, uint32 mask, const uint8 *index, color *matrix)
 {
-  // Update in subclasses if desired!
-  drawLine(x, y, x+w, y, c, matrix);
+#if CANVAS_MAPPED || LED_MATRIX_DITHER || LED_MATRIX_PALETTE
+	int16 k;
+
+#if LED_MATRIX_PALETTE
+	(void)matrix;
+#endif
+	for(k = b->left - b->x; k <= b->right - b->x; k++)
+	{
+		if(mask & (1uL << k))
+		{
+#if LED_MATRIX_PALETTE
+			putPixelIndex((int8)(b->x + k), (int8)y, (uint8)b->ink[index ? index[k] : 0u]);
+#else
+			putPixel((int8)(b->x + k), (int8)y, b->colors[index ? index[k] : 0u], matrix);
+#endif
+		}
+	}
+#else
+	color *lane = &matrix[MATRIX_LANE(b->left, y)];
+	color *last = &matrix[MATRIX_LANE(b->right, y)];
+	int16 o = (b->left & ~7) - b->x;
+	uint8 m, k, p, acc[15];
+	uint8 *planes;
+	uint16 bits;
+
+	/* o is the sprite column at bit 0 of the lane, -7 to SPRITE_MAX_WIDTH - 1 */
+	for(; lane <= last; lane++, o += 8)
+	{
+		m = (uint8)((o >= 0) ? (mask >> o) : (mask << -o));
+		if(m == 0u)
+		{
+			continue;
+		}
+		planes = (uint8 *)lane;
+		if(index == 0)
+		{
+			for(p = 0, bits = b->ink[0]; p < 15u; p++, bits >>= 1)
+			{
+				planes[p] = (bits & 1u) ? (planes[p] | m) : (planes[p] & ~m);
+			}
+		}
+		else
+		{
+			for(p = 0; p < 15u; p++)
+			{
+				acc[p] = 0;
+			}
+			for(k = 0; k < 8u; k++)
+			{
+				if(m & (1u << k))
+				{
+					for(p = 0, bits = b->ink[index[o + k]]; bits != 0u; p++, bits >>= 1)
+					{
+						if(bits & 1u)
+						{
+							acc[p] |= (uint8)(1u << k);
+						}
+					}
+				}
+			}
+			for(p = 0; p < 15u; p++)
+			{
+				planes[p] = (planes[p] & ~m) | acc[p];
+			}
+		}
+	}
+#endif
 }
 
-void fillRect(int8 x, int8 y, int8 w, int8 h, RGB c, color *matrix) 
+/* Sprite rows shown on the canvas: first and last, 0 when none */
+static uint8 blitRows(int8 y, const Sprite *s, int16 *first, int16 *last)
 {
-  // Update in subclasses if desired!
-	int8 i = 0;
-  for(i=x; i<x+w; i++) {
-    drawFastVLine(i, y, h, c, matrix);
-  }
+	*first = (y < clipTop) ? clipTop - y : 0;
+	*last = (int16)s->height - 1;
+	if(*last > clipBottom - y)
+	{
+		*last = clipBottom - y;
+	}
+	return *first <= *last;
 }
 
-void fillScreen(RGB c, color *matrix)
+/*******************************************************************************
+* Function Name: drawSprite1
+********************************************************************************
+*
+* Summary:
+*  Draws a 1bpp sprite with its top left corner at (x,y), clipped. Set bits
+*  take color c, clear bits are transparent.
+*
+* Parameters:  
+*   int8 x, y: 		canvas position, may be partly off the canvas
+*	Sprite *s:		1bpp image
+*	RGB c:			foreground color
+*	uint8 flags:	SPRITE_FLIP_X, SPRITE_FLIP_Y
+* 	color *matrix: 	pointer to the matrix buffer
+*
+*******************************************************************************/
+void drawSprite1(int8 x, int8 y, const Sprite *s, RGB c, uint8 flags, color *matrix)
 {
-  fillRect(0, 0, 32, 16, c, matrix);
+	Blit b;
+	int16 row, last;
+	uint8 stride = (s->width + 7u) / 8u, k;
+	const uint8 *src;
+	uint32 bits, mirror;
+
+	if(!blitStart(&b, x, s) || !blitRows(y, s, &row, &last))
+	{
+		return;
+	}
+	b.colors = &c;
+	b.ink[0] = inkOf(c);
+
+	for(; row <= last; row++)
+	{
+		src = &s->data[(uint16)((flags & SPRITE_FLIP_Y) ? s->height - 1 - row : row) * stride];
+		bits = 0;
+		for(k = 0; k < stride; k++)
+		{
+			bits |= (uint32)src[k] << (8u * k);
+		}
+		if(flags & SPRITE_FLIP_X)
+		{
+			for(mirror = 0, k = 0; k < s->width; k++, bits >>= 1)
+			{
+				mirror = (mirror << 1) | (bits & 1u);
+			}
+			bits = mirror;
+		}
+		bits &= b.visible;
+		if(bits != 0u)
+		{
+			blitRow(&b, y + row, bits, 0, matrix);
+		}
+	}
 }
 
-void drawTriangle(int8 x0, int8 y0,int8 x1, int8 y1,
-						int8 x2, int8 y2, RGB c, color *matrix) 
+/*******************************************************************************
+* Function Name: drawSprite4
+********************************************************************************
+*
+* Summary:
+*  Draws a 4bpp sprite with its top left corner at (x,y), clipped. Each
+*  index picks a color from 'palette'; the transparent one is skipped.
+*
+* Parameters:  
+*   int8 x, y: 			canvas position, may be partly off the canvas
+*	Sprite *s:			4bpp image
+*	RGB *palette:		16 colors
+*	uint8 transparent:	index left out, SPRITE_NO_TRANSPARENT for none
+*	uint8 flags:		SPRITE_FLIP_X, SPRITE_FLIP_Y
+* 	color *matrix: 		pointer to the matrix buffer
+*
+*******************************************************************************/
+void drawSprite4(int8 x, int8 y, const Sprite *s, const RGB *palette, uint8 transparent, uint8 flags, color *matrix)
 {
-  drawLine(x0, y0, x1, y1, c, matrix);
-  drawLine(x1, y1, x2, y2, c, matrix);
-  drawLine(x2, y2, x0, y0, c, matrix);
+	Blit b;
+	int16 row, last;
+	uint8 stride = (s->width + 1u) / 2u, k, n;
+	uint8 index[SPRITE_MAX_WIDTH];
+	const uint8 *src;
+	uint32 opaque;
+
+	if(!blitStart(&b, x, s) || !blitRows(y, s, &row, &last))
+	{
+		return;
+	}
+	b.colors = palette;
+	for(k = 0; k < 16u; k++)
+	{
+		b.ink[k] = inkOf(palette[k]);
+	}
+
+	for(; row <= last; row++)
+	{
+		src = &s->data[(uint16)((flags & SPRITE_FLIP_Y) ? s->height - 1 - row : row) * stride];
+		opaque = 0;
+		for(k = 0; k < s->width; k++)
+		{
+			n = (flags & SPRITE_FLIP_X) ? s->width - 1u - k : k;
+			n = (n & 1u) ? (src[n >> 1] >> 4) : (src[n >> 1] & 0x0Fu);
+			index[k] = n;
+			if(n != transparent)
+			{
+				opaque |= 1uL << k;
+			}
+		}
+		opaque &= b.visible;
+		if(opaque != 0u)
+		{
+			blitRow(&b, y + row, opaque, index, matrix);
+		}
+	}
 }
 
 void drawOne(int8 x0, int8 y0,RGB c, color *matrix) 
@@ -524,32 +2147,29 @@ void drawHex(uint8 num,int8 x0, int8 y0,RGB c, color *matrix)
 
 void drawblock(int8 blockLoc, int8 h, RGB c, color *matrix)
 {
-	int i = 0;
 	RGB black;
 	black.r = 0;
 	black.g = 0;
 	black.b = 0;
-	blockLoc = blockLoc*4;
-	int8 maxHeight = 15;
-	if(blockLoc>28)
+	int16 x = (int16)blockLoc*BLOCK_WIDTH;
+	int8 maxHeight = CANVAS_HEIGHT - 1;
+	if(x>CANVAS_WIDTH - BLOCK_WIDTH)
 	{
-		blockLoc=28;
+		x=CANVAS_WIDTH - BLOCK_WIDTH;
 	}
-	else if(blockLoc<0)
+	else if(x<0)
 	{
-		blockLoc=0;
+		x=0;
 	}
-	for(i=0;i<4;i++)
+	if(h>maxHeight)
 	{
-		drawFastVLine(blockLoc+i, 0,h, c, matrix);
+		h=maxHeight;
 	}
-	
-	for(i=0;i<4;i++)
+	/* rows 0 to h in the bar color, the rest of the column black */
+	fillRect((int8)x, 0, BLOCK_WIDTH, h + 1, c, matrix);
+	if(h != maxHeight)
 	{
-		if(h != maxHeight)
-		{
-			drawFastVLine(blockLoc+i, h+1,maxHeight, black, matrix);
-		}
+		fillRect((int8)x, h + 1, BLOCK_WIDTH, maxHeight - h, black, matrix);
 	}
 	
 }
@@ -560,15 +2180,15 @@ void fallingLine(int8 blockLoc, int8 h, RGB c, color *matrix)
 	black.r = 0;
 	black.g = 0;
 	black.b = 0;
-    int8 maxHeight = 15;
-    blockLoc = blockLoc*4;
-	if(blockLoc>28)
+    int8 maxHeight = CANVAS_HEIGHT - 1;
+    int16 x = (int16)blockLoc*BLOCK_WIDTH;
+	if(x>CANVAS_WIDTH - BLOCK_WIDTH)
 	{
-		blockLoc=28;
+		x=CANVAS_WIDTH - BLOCK_WIDTH;
 	}
-	else if(blockLoc<0)
+	else if(x<0)
 	{
-		blockLoc=0;
+		x=0;
 	}
 	/*int i = 0;
 	RGB black;
@@ -600,8 +2220,9 @@ void fallingLine(int8 blockLoc, int8 h, RGB c, color *matrix)
 			drawFastVLine(blockLoc+i, h+1,maxHeight, black, matrix);
 		}
 	}*/
+	/* drawblock takes the block number and scales it itself */
 	drawblock(blockLoc, maxHeight, black, matrix);
-    drawFastHLine(blockLoc, h, 3, c, matrix);
+    drawFastHLine((int8)x, h, BLOCK_WIDTH - 1, c, matrix);
 }
 
 int ifDataChange(uint8 *oldResult,uint16 *result)
@@ -17,15 +17,208 @@
  * Header For LED Matrix Component/Project
  ********************************************************************************/
  
-#include <CR_Addr.h>
+#ifndef LED_Matrix_h_
+#define LED_Matrix_h_
+#include <device.h>
 
-/* Few defines to simplify setting A B C and LAT */
-#define Row_Select(r)			CR_Addr_Control=(CR_Addr_Control&0xF8)|(r&0x07)
-
-#define Set_LAT					CR_Addr_Control=(CR_Addr_Control|0x08)
-#define Clear_LAT				CR_Addr_Control=(CR_Addr_Control&0xF7)			/* LAT is Addr_CR 3 */
 #define swap(a, b) 				{uint8 t = a; a = b; b = t;}
 
+/* Panel geometry. Two rows are driven at once, one in each half of the panel
+ * (R1/G1/B1 and R2/G2/B2), so the scan is 1/MATRIX_SCAN_ROWS:
+ *  32x16 1/8 scan:		32, 16, 8
+ *  32x32 1/16 scan:	32, 32, 16 - the component needs a fourth row output for D
+ *  64x32 1/16 scan:	64, 32, 16 - the 3840-byte framebuffer does not fit
+ *						the CY8C4's 4 KB next to the rest of the firmware
+ * The host tests set them with -D to build each geometry.
+ */
+#ifndef PANEL_WIDTH
+#define PANEL_WIDTH				32
+#define PANEL_HEIGHT			16
+#define MATRIX_SCAN_ROWS		8
+#endif
+
+/* Panels daisy-chained on the one HUB75 output. The refresh path only sees
+ * the chain, one MATRIX_WIDTH-column stream per row, which the ISR hands the
+ * component a FIFO chunk at a time. Every panel adds a chunk and an ISR per
+ * row and plane; what that costs in refresh rate depends on whether the
+ * shifting or the OE windows bound a row, and TLM_COUNT_FRAMES measures it.
+ * The columns shifted first end up in the panel farthest down the chain.
+ */
+#ifndef PANEL_CHAIN
+#define PANEL_CHAIN				1
+#endif
+#define MATRIX_WIDTH			(PANEL_WIDTH * PANEL_CHAIN)
+#define MATRIX_HEIGHT			PANEL_HEIGHT
+
+/* Canvas the drawing functions work in: the chained panels as a grid of
+ * CANVAS_TILES_X by CANVAS_TILES_Y tiles. drawPixel maps canvas coordinates to
+ * the chain stream, so nothing changes for the refresh.
+ *  CANVAS_ORDER:		the chain runs along tile rows (CANVAS_ROWS, horizontal)
+ *						or tile columns (CANVAS_COLUMNS, vertical) from the
+ *						top left tile
+ *  CANVAS_SERPENTINE:	1 - the chain comes back along every other row/column
+ *  CANVAS_ROTATION:	quarter turns clockwise of every panel as mounted, in
+ *						chain order; 1 and 3 need square panels
+ * Coordinates are int8, so the canvas is at most 128 pixels across. All of
+ * these can be set with -D, as the host tests do.
+ */
+#define CANVAS_ROWS				0
+#define CANVAS_COLUMNS			1
+
+#ifndef CANVAS_TILES_X
+#define CANVAS_TILES_X			1
+#endif
+#ifndef CANVAS_TILES_Y
+#define CANVAS_TILES_Y			1
+#endif
+#ifndef CANVAS_ORDER
+#define CANVAS_ORDER			CANVAS_ROWS
+#endif
+#ifndef CANVAS_SERPENTINE
+#define CANVAS_SERPENTINE		0
+#endif
+#ifndef CANVAS_ROTATION
+#define CANVAS_ROTATION			{0}
+#endif
+
+#define CANVAS_WIDTH			(PANEL_WIDTH * CANVAS_TILES_X)
+#define CANVAS_HEIGHT			(PANEL_HEIGHT * CANVAS_TILES_Y)
+/* 0 when canvas and chain coincide and drawPixel can skip the mapping */
+#define CANVAS_MAPPED			(PANEL_CHAIN > 1)
+
+#if (CANVAS_TILES_X * CANVAS_TILES_Y) != PANEL_CHAIN
+#error "CANVAS_TILES_X * CANVAS_TILES_Y must be PANEL_CHAIN"
+#endif
+
+#if (CANVAS_WIDTH > 128) || (CANVAS_HEIGHT > 128)
+#error "the canvas is limited to 128 x 128 by int8 coordinates"
+#endif
+
+/* Bytes per FIFO per row, and framebuffer lanes (8 pixels of one row each) */
+#define MATRIX_ROW_BYTES		(MATRIX_WIDTH / 8)
+#define MATRIX_LANES			(MATRIX_HEIGHT * MATRIX_ROW_BYTES)
+#define MATRIX_LANE(x, y)		((y) * MATRIX_ROW_BYTES + (x) / 8)
+/* The component shifts a row in chunks of its FIFO depth, one ISR per chunk */
+#define MATRIX_FIFO_DEPTH		4
+#define MATRIX_ROW_CHUNKS		(MATRIX_ROW_BYTES / MATRIX_FIFO_DEPTH)
+/* Spectrum bars: 8 bands across the canvas */
+#define BLOCK_WIDTH				(CANVAS_WIDTH / 8)
+
+#if (MATRIX_WIDTH % (8 * MATRIX_FIFO_DEPTH)) != 0
+#error "MATRIX_WIDTH must be a multiple of 32, a whole number of FIFO fills"
+#endif
+
+#if (MATRIX_SCAN_ROWS * 2) != MATRIX_HEIGHT
+#error "MATRIX_SCAN_ROWS must be MATRIX_HEIGHT / 2"
+#endif
+
+#if (MATRIX_SCAN_ROWS - 1) & MATRIX_SCAN_ROWS
+#error "MATRIX_SCAN_ROWS must be a power of 2"
+#endif
+
+#if (MATRIX_SCAN_ROWS - 1) & ~LED_Matrix_1_ROW_MASK
+#error "the LED_Matrix component has too few row outputs for MATRIX_SCAN_ROWS"
+#endif
+
+/* 1: the component times OE per bit plane (full 5-bit BCM, one ISR per plane)
+ * 0: the original ISR-timed refresh showing planes 1, 1, 0
+ */
+#define LED_MATRIX_HW_BCM		1
+#define BCM_PLANES				5
+/* OE units for plane 0 at full brightness, doubled for every following
+ * plane - at most 255 >> 4
+ */
+#define BCM_UNIT_MAX			15u
+
+/* 1: drawPixel keeps two more bits per channel below plane 0 and
+ * ditherService shows them as a 4-frame ordered pattern, about 7 bits of
+ * depth from 5 planes. Costs 384 bytes of RAM. Can be set with -D, as the
+ * host tests do.
+ */
+#ifndef LED_MATRIX_DITHER
+#define LED_MATRIX_DITHER		0
+#endif
+
+/* 1: drawPixel stores a 4-bit palette index per pixel (256 bytes for 32x16)
+ * instead of the bit planes (960 bytes). The refresh ISR expands each row
+ * pair into a two-row plane buffer once, at the first plane of the row, so
+ * paletteSet() recolors the whole screen from the next frame on. Can be set
+ * with -D, as the host tests do.
+ */
+#ifndef LED_MATRIX_PALETTE
+#define LED_MATRIX_PALETTE		0
+#endif
+#define PALETTE_SIZE			16u
+
+/* 1: drawing goes to a VIRTUAL_WIDTH x VIRTUAL_HEIGHT palette canvas and the
+ * panel shows a window of it at the scroll offset. The row expansion reads
+ * the window, so scrolling redraws nothing. Needs LED_MATRIX_PALETTE and
+ * costs VIRTUAL_WIDTH * VIRTUAL_HEIGHT / 2 bytes. Can be set with -D.
+ */
+#ifndef LED_MATRIX_SCROLL
+#define LED_MATRIX_SCROLL		0
+#endif
+#ifndef VIRTUAL_WIDTH
+#define VIRTUAL_WIDTH			128
+#endif
+#ifndef VIRTUAL_HEIGHT
+#define VIRTUAL_HEIGHT			16
+#endif
+
+/* what the draw calls address: the virtual canvas when scrolling */
+#if LED_MATRIX_SCROLL
+#define SURFACE_WIDTH			VIRTUAL_WIDTH
+#define SURFACE_HEIGHT			VIRTUAL_HEIGHT
+#else
+#define SURFACE_WIDTH			CANVAS_WIDTH
+#define SURFACE_HEIGHT			CANVAS_HEIGHT
+#endif
+
+/* 1 when canvas row y is the MATRIX_ROW_BYTES lanes from MATRIX_LANE(0, y)
+ * of 'matrix', so a row can be built on a copy and put back in one go: not
+ * on a chained canvas, nor in palette mode, which draws into its index buffer
+ */
+#define CANVAS_ROW_LANES		(!CANVAS_MAPPED && !LED_MATRIX_PALETTE)
+
+#if LED_MATRIX_PALETTE && !LED_MATRIX_HW_BCM
+#error "LED_MATRIX_PALETTE needs LED_MATRIX_HW_BCM"
+#endif
+
+/* the remainders live in the full plane buffer the palette mode drops */
+#if LED_MATRIX_PALETTE && LED_MATRIX_DITHER
+#error "LED_MATRIX_PALETTE and LED_MATRIX_DITHER do not mix"
+#endif
+
+#if LED_MATRIX_SCROLL && (!LED_MATRIX_PALETTE || CANVAS_MAPPED)
+#error "LED_MATRIX_SCROLL needs LED_MATRIX_PALETTE and a single panel"
+#endif
+
+/* int8 coordinates, two pixels per byte */
+#if LED_MATRIX_SCROLL && ((VIRTUAL_WIDTH > 128) || (VIRTUAL_HEIGHT > 128) || (VIRTUAL_WIDTH % 2) || \
+	(VIRTUAL_WIDTH < MATRIX_WIDTH) || (VIRTUAL_HEIGHT < MATRIX_HEIGHT))
+#error "VIRTUAL_WIDTH must be even and the virtual canvas between the panel size and 128"
+#endif
+
+/* the ISR-timed refresh is written out for one 32x16 panel */
+#if !LED_MATRIX_HW_BCM && ((MATRIX_WIDTH != 32) || (MATRIX_HEIGHT != 16))
+#error "this geometry needs LED_MATRIX_HW_BCM"
+#endif
+
+/* Lanes of 'matrix' and the first lane of the upper and lower half of scan
+ * row j. In palette mode 'matrix' holds only the row pair being refreshed.
+ */
+#if LED_MATRIX_PALETTE
+#define MATRIX_BUFFER_LANES		(2 * MATRIX_ROW_BYTES)
+#define MATRIX_UPPER(j)			0
+#define MATRIX_LOWER(j)			MATRIX_ROW_BYTES
+#define MATRIX_FB_BYTES			(SURFACE_WIDTH * SURFACE_HEIGHT / 2 + MATRIX_BUFFER_LANES * sizeof(color))
+#else
+#define MATRIX_BUFFER_LANES		MATRIX_LANES
+#define MATRIX_UPPER(j)			((j) * MATRIX_ROW_BYTES)
+#define MATRIX_LOWER(j)			(((j) + MATRIX_SCAN_ROWS) * MATRIX_ROW_BYTES)
+#define MATRIX_FB_BYTES			(MATRIX_LANES * sizeof(color))
+#endif
+
 
 
 
@@ -42,7 +235,7 @@ typedef struct
 	uint8 b[5];
 } color;
 
-/* struct to hold actual (upto 8-bit) color */
+/* struct to hold actual 8-bit color - drawPixel maps it through the gamma table */
 typedef struct
 {
 	uint8 r;
@@ -50,14 +243,74 @@ typedef struct
 	uint8 b;
 } RGB;
 
+/* Packed image for drawSprite1/drawSprite4, normally const so it stays in
+ * flash. Rows are padded to whole bytes and pixels are stored left to right
+ * from the least significant bit, like the lanes of 'matrix': 1bpp has
+ * pixel k in bit k%8 of byte k/8, 4bpp has the even pixel in the low nibble.
+ */
+typedef struct
+{
+	uint8 width;			/* 1 to SPRITE_MAX_WIDTH */
+	uint8 height;
+	const uint8 *data;
+} Sprite;
+
+#define SPRITE_MAX_WIDTH		32u
+#define SPRITE_FLIP_X			0x01u
+#define SPRITE_FLIP_Y			0x02u
+#define SPRITE_NO_TRANSPARENT	0xFFu
+
 /*******************************************************************************
 * Array to hold the matrix image - defined in main
 ********************************************************************************/
-extern color matrix[64];
+extern color matrix[MATRIX_BUFFER_LANES];
+
+/* Incremented by the refresh ISR every time it wraps back to row
+ * MATRIX_SCAN_ROWS - 1, where its downward scan starts
+ */
+extern volatile uint8 refreshFrames;
+
+/* OE window per bit plane, set by setBrightness() */
+extern uint8 bcmPeriod[BCM_PLANES];
+/* Lowest plane shown, set by setColorDepth() and taken up by the refresh ISR
+ * at the start of a frame
+ */
+extern volatile uint8 bcmFirstPlane;
 
 /*******************************************************************************
 * Function Prototypes
 ********************************************************************************/
+void setBrightness(uint8 level);
+/* Every draw call below clips to this rectangle, the whole canvas by default */
+void setClipRect(int8 x, int8 y, int8 w, int8 h);
+void resetClipRect(void);
+#if LED_MATRIX_HW_BCM
+void setColorDepth(uint8 planes);
+uint8 getColorDepth(void);
+#else
+/* the ISR-timed refresh has its fixed plane sequence */
+#define setColorDepth(planes)
+#define getColorDepth()			BCM_PLANES
+#endif
+/* before a flash row write: waits for the refresh to start a frame */
+void waitFrameStart(uint8 maxMs);
+#if LED_MATRIX_PALETTE
+void paletteSet(uint8 n, RGB c);
+void drawPixelIndex(int8 x, int8 y, uint8 n);
+void paletteExpandRow(uint8 row, color *matrix);
+#endif
+#if LED_MATRIX_SCROLL
+void scrollTo(int16 x, int16 y);
+void scrollSpeed(int16 vx, int16 vy, uint8 wrap);
+void scrollService(void);
+#else
+#define scrollService()
+#endif
+#if LED_MATRIX_DITHER
+void ditherService(color *matrix);
+#else
+#define ditherService(matrix)
+#endif
 void drawPixel(int8 x, int8 y, RGB c, color *matrix);
 void clearPixel(uint8 x, uint8 y, color *matrix);
 void clearScreen(color *matrix);
@@ -68,7 +321,14 @@ void drawFastVLine(int8 x, int8 y, int8 h, RGB c, color *matrix);
 void drawFastHLine(int8 x, int8 y, int8 h, RGB c, color *matrix);
 void fillRect(int8 x, int8 y, int8 w, int8 h, RGB c, color *matrix);
 void fillScreen(RGB c, color *matrix);
+void drawRow(int8 x, int8 y, uint8 w, const RGB *pixels, color *matrix);
+void drawRowBits(int8 y, const uint8 *bits, RGB on, RGB off, color *matrix);
 void drawTriangle(int8 x0, int8 y0,int8 x1, int8 y1,int8 x2, int8 y2, RGB c, color *matrix);
+void fillCircle(int8 x0, int8 y0, int8 r, RGB c, color *matrix);
+void fillRoundRect(int8 x, int8 y, int8 w, int8 h, int8 r, RGB c, color *matrix);
+void fillTriangle(int8 x0, int8 y0, int8 x1, int8 y1, int8 x2, int8 y2, RGB c, color *matrix);
+void drawSprite1(int8 x, int8 y, const Sprite *s, RGB c, uint8 flags, color *matrix);
+void drawSprite4(int8 x, int8 y, const Sprite *s, const RGB *palette, uint8 transparent, uint8 flags, color *matrix);
 void drawOne(int8 x0, int8 y0,RGB c, color *matrix);
 void drawTwo(int8 x0, int8 y0,RGB c, color *matrix);
 void drawColon(int8 x0, int8 y0,RGB c, color *matrix);
@@ -95,4 +355,6 @@ int anyDataDecrease(uint8 *oldResult,uint16 *result);
 void max(uint16 *max,uint16 *result);
 void scaleResult(uint8 *scaledResult,uint8 *oldResult);
 void fallingLine(int8 blockLoc, int8 h, RGB c, color *matrix);
+
+#endif
 //[] END OF FILE
@@ -11,32 +11,50 @@
 */
 #include "`$INSTANCE_NAME`.h"
 
-void `$INSTANCE_NAME`_Start()
+/* Sets or clears the given AUX_CTL bits in all three datapaths */
+static void `$INSTANCE_NAME`_AuxCtl(uint8 mask, uint8 set)
 {
 	uint8 interruptState;
 
-//	/* Enter critical section - AUX_CTL is shared by multiple hardware Components */
-//	interruptState = CyEnterCriticalSection();
-//
-//	#if `$FIFO_0_AlternateLevelReport` > 0
-//		`$INSTANCE_NAME`_AUX_CTL_A_REG |= (`$INSTANCE_NAME`_F0_LEVEL_MODE_1 << `$INSTANCE_NAME`_F0_LEVEL_SHIFT);
-//	#endif
-//	
-//	#if `$FIFO_1_AlternateLevelReport` > 0
-//		`$INSTANCE_NAME`_AUX_CTL_A_REG |= (`$INSTANCE_NAME`_F1_LEVEL_MODE_1 << `$INSTANCE_NAME`_F1_LEVEL_SHIFT);
-//	#endif
-//	
-//	#if `$FIFO_0_SingleBufferMode` > 0
-//		`$INSTANCE_NAME`_AUX_CTL_A_REG |= (`$INSTANCE_NAME`_F0_SINGLE_BUFFER_ENABLE << `$INSTANCE_NAME`_F0_SINGLE_BUFFER_SHIFT);
-//	#endif
-//	
-//	#if `$FIFO_1_SingleBufferMode` > 0
-//		`$INSTANCE_NAME`_AUX_CTL_A_REG |= (`$INSTANCE_NAME`_F1_SINGLE_BUFFER_ENABLE << `$INSTANCE_NAME`_F1_SINGLE_BUFFER_SHIFT);
-//	#endif
-	
+	/* Enter critical section - AUX_CTL is shared by multiple hardware Components */
+	interruptState = CyEnterCriticalSection();
+
+	if(set)
+	{
+		`$INSTANCE_NAME`_AUX_CTL_REG_0 |= mask;
+		`$INSTANCE_NAME`_AUX_CTL_REG_1 |= mask;
+		`$INSTANCE_NAME`_AUX_CTL_REG_2 |= mask;
+	}
+	else
+	{
+		`$INSTANCE_NAME`_AUX_CTL_REG_0 &= (uint8)~mask;
+		`$INSTANCE_NAME`_AUX_CTL_REG_1 &= (uint8)~mask;
+		`$INSTANCE_NAME`_AUX_CTL_REG_2 &= (uint8)~mask;
+	}
+
 	/* Exit critical section */
 	CyExitCriticalSection(interruptState);
-	
+}
+
+void `$INSTANCE_NAME`_Start()
+{
+	uint8 interruptState;
+
+	/* level mode 0 for F0 and F1: "not full" until all four bytes are in */
+	`$INSTANCE_NAME`_AuxCtl(`$INSTANCE_NAME`_F0_LEVEL_MASK | `$INSTANCE_NAME`_F1_LEVEL_MASK, 0u);
+
+	`$INSTANCE_NAME`_AuxCtl(`$INSTANCE_NAME`_F0_SINGLE_BUFFER_MASK | `$INSTANCE_NAME`_F1_SINGLE_BUFFER_MASK,
+		`$INSTANCE_NAME`_FIFO_SINGLE_BUFFER);
+
+	/* the row address counters run from here on: the first latch selects
+	 * row_counter's period. Aux control is shared, as in AuxCtl().
+	 */
+	`$INSTANCE_NAME`_RestartRows();
+	interruptState = CyEnterCriticalSection();
+	`$INSTANCE_NAME`_ROW_AUX_CTL_REG |= `$INSTANCE_NAME`_CNT_START;
+	`$INSTANCE_NAME`_PLANE_AUX_CTL_REG |= `$INSTANCE_NAME`_CNT_START;
+	CyExitCriticalSection(interruptState);
+
 	return;
 }
 
@@ -42,6 +42,11 @@
 //#define `$INSTANCE_NAME`_F0_F1_PTR		((reg16 *) `$INSTANCE_NAME`_datapath_0_u0__F0_F1_REG)
 #define `$INSTANCE_NAME`_F0_F1_REG_0		(*(reg16 *) `$INSTANCE_NAME`_datapath_0_u0__F0_F1_REG)
 
+// AUX CTL register definitions
+#define `$INSTANCE_NAME`_AUX_CTL_REG_0			(*(reg8 *) `$INSTANCE_NAME`_datapath_0_u0__DP_AUX_CTL_REG)
+#define `$INSTANCE_NAME`_AUX_CTL_REG_1			(*(reg8 *) `$INSTANCE_NAME`_datapath_1_u0__DP_AUX_CTL_REG)
+#define `$INSTANCE_NAME`_AUX_CTL_REG_2			(*(reg8 *) `$INSTANCE_NAME`_datapath_2_u0__DP_AUX_CTL_REG)
+
 // AUX CTL definitions
 //  ----------------- MASKS ----------------------
 #define `$INSTANCE_NAME`_F1_LEVEL_MASK				(0x08u)
@@ -71,6 +76,49 @@
 #define `$INSTANCE_NAME`_WriteControl(value)		CY_SET_REG8(`$INSTANCE_NAME`_ControlReg_1__CONTROL_REG, value)
 #define `$INSTANCE_NAME`_ReadControl(value)			CY_SGET_REG8(`$INSTANCE_NAME`_ControlReg_1__CONTROL_REG)
 
+// ----------------- CONTROL BITS ----------------
+#define `$INSTANCE_NAME`_CTRL_ENABLE				(0x01u)		// clock enable
+#define `$INSTANCE_NAME`_CTRL_OE					(0x02u)		// OE level when not in hardware OE mode
+#define `$INSTANCE_NAME`_CTRL_OE_START				(0x04u)		// pulse: start an OE window
+#define `$INSTANCE_NAME`_CTRL_OE_HW					(0x08u)		// OE timed by hardware
+#define `$INSTANCE_NAME`_CTRL_ROW_MORE			(0x20u)		// the row goes on after the bytes queued now
+
+// ----------------- FIFO CONFIGURATION ----------
+// Applied to all six FIFOs by Start().  They run in level mode 0: datapath 0's F1 reports "not full"
+// until all FIFO_DEPTH of its bytes are in, and the component holds a row (or chunk) back until then.
+// Firmware fills the other five FIFOs first and F1_REG_0 last, which is the FIFO the component watches.
+#define `$INSTANCE_NAME`_FIFO_SINGLE_BUFFER			`$INSTANCE_NAME`_F1_SINGLE_BUFFER_DISABLE
+
+// ----------------- ROW LENGTH ------------------
+// a longer row is written in chunks of at most FIFO_DEPTH bytes per FIFO, with CTRL_ROW_MORE set for
+// every chunk but the last, written once the chunk's bytes are in.  done then also rises after each of those chunks; the row carries on
+// once the FIFOs are full again.
+#define `$INSTANCE_NAME`_FIFO_DEPTH					(4u)
+
+// ----------------- HARDWARE OE -----------------
+// one OE period unit is 2^OE_PRESCALE component clocks (OE_PRESCALE in the Verilog,
+// loaded into datapath_3 D1 at reset); the period is datapath_3 D0
+#define `$INSTANCE_NAME`_OE_PRESCALE				(2u)
+#define `$INSTANCE_NAME`_WriteOEPeriod(value)		CY_SET_REG8(`$INSTANCE_NAME`_datapath_3_u0__D0_REG, value)
+// light the latched row for the period last written with WriteOEPeriod()
+#define `$INSTANCE_NAME`_StartOE()					`$INSTANCE_NAME`_WriteControl(`$INSTANCE_NAME`_CTRL_ENABLE | \
+													`$INSTANCE_NAME`_CTRL_OE_HW | `$INSTANCE_NAME`_CTRL_OE_START)
+
+// ----------------- ROW ADDRESS -----------------
+// A, B, C come out on State_0..2, row_counter's count.  The component steps it at the latch of the first plane
+// of every row, the planes being counted by plane_counter, so rows are scanned downwards from rows - 1.  Both
+// are count7s, started by Start().  WriteRows() and WritePlanes() set the scan and the planes per row, taken up
+// at the next row; RestartRows() makes the next latch the first plane of row rows - 1.  The counters only move
+// at a latch: write them after one, before the FIFOs for the next are full.
+#define `$INSTANCE_NAME`_ROW_MASK					(0x07u)		// A, B, C
+#define `$INSTANCE_NAME`_CNT_START					(0x20u)		// count7 enable, in its aux control register
+#define `$INSTANCE_NAME`_ROW_AUX_CTL_REG			(*(reg8 *) `$INSTANCE_NAME`_row_counter__CONTROL_AUX_CTL_REG)
+#define `$INSTANCE_NAME`_PLANE_AUX_CTL_REG			(*(reg8 *) `$INSTANCE_NAME`_plane_counter__CONTROL_AUX_CTL_REG)
+#define `$INSTANCE_NAME`_WriteRows(rows)			CY_SET_REG8(`$INSTANCE_NAME`_row_counter__PERIOD_REG, (rows) - 1u)
+#define `$INSTANCE_NAME`_WritePlanes(planes)		CY_SET_REG8(`$INSTANCE_NAME`_plane_counter__PERIOD_REG, (planes) - 1u)
+#define `$INSTANCE_NAME`_RestartRows()				do { CY_SET_REG8(`$INSTANCE_NAME`_row_counter__COUNT_REG, 0u); \
+													CY_SET_REG8(`$INSTANCE_NAME`_plane_counter__COUNT_REG, 0u); } while(0)
+
 #define `$INSTANCE_NAME`_WriteF0(value)				CY_SET_REG8(`$INSTANCE_NAME`_F0_PTR, (uint8)value )
 #define `$INSTANCE_NAME`_WriteF1(value)				CY_SET_REG8(`$INSTANCE_NAME`_F1_PTR, (uint8)value )
 
@@ -67,15 +67,70 @@ wire f1_empty, f1_notfull, so_0, so_1, so_2, ClockOutFromEnBlock, reset;
 /* 8-bits of control register instantiated in Verilog */
 wire [7:0] control_1;
 
-/* 3-bit counter */
+/* 3-bit counter - columns of the current byte still to come after this one */
 reg [2:0] count8;
 
-/* Output Enable (OE) is controlled by the bit[1] of ControlReg_1 (controlled in software) */
-assign oe = control_1[1];
+/* The column pipeline takes two clocks per column: A1 is shifted into pend_*,
+ * then A0 is shifted straight to r1/g1/b1 while pend_* moves to r2/g2/b2.
+ * o_clk rises on the A1 cycle for the column set up on the A0 cycle before,
+ * so data always leads the clock edge by one UDB clock.
+ * primed: a column is on the outputs waiting for its o_clk edge
+ */
+reg pend_r2, pend_g2, pend_b2;
+reg primed;
+
+/* A row longer than the FIFO depth (chained panels) is shifted in chunks of
+ * up to 4 bytes per FIFO. The shifter keeps reloading while F1 holds data and
+ * only counts columns; the row ends where the FIFOs run dry.
+ * control_1[5]:	1 = more of this row follows the bytes queued now. done then
+ *					follows f1_empty, rising as soon as the last byte of the chunk
+ *					has left the FIFOs, so firmware refills them while it shifts
+ *					and the row carries straight on. Should the FIFOs still be dry
+ *					at the end of the byte, the shifter waits in STATE_7 until they
+ *					are full instead of latching. Firmware writes the bit after
+ *					filling each chunk, set for all but the last of a row: until
+ *					then the previous chunk's setting keeps a shifter that has run
+ *					dry waiting rather than latching half a row.
+ */
+wire row_more = control_1[5];
+
+/* Output Enable (OE) generator
+ * control_1[1]:	OE level in software mode
+ * control_1[2]:	pulse bit - starts a display window of D0 units
+ * control_1[3]:	1 = hardware mode, OE is driven by the window counter
+ * The window is counted by datapath_3 alone, so it takes no PLD macrocells:
+ * A0 counts the units down from D0 and A1 the clocks of each unit down from
+ * D1, 2^OE_PRESCALE - 1 after reset. Its own zero detects select the next
+ * operation (cs_addr = {z1, z0, start}), and z0 - A0 at zero - is the dark
+ * phase. In hardware mode the next latch is held off until the window has run
+ * out, so rows are only ever latched while dark. OE on the panel is active low.
+ */
+localparam OE_PRESCALE = 2;
+
+wire oe_start = control_1[2];
+wire oe_hw = control_1[3];
+wire oe_dark, oe_tick;
+
+assign oe = oe_hw ? oe_dark : control_1[1];
+
+/* Row address, counted by two count7s, so it takes no PLD macrocells either.
+ * Both are clocked once per latch through latch_clock, on the clock edge that
+ * ends lat:
+ * plane_counter:	counts the planes of a row down from its period (planes - 1)
+ * row_counter:		steps while plane_counter is at terminal count, which is at
+ *					the latch of the first plane of every row, and drives A, B, C
+ *					on State_0..2 (the port names are kept so the symbol stays)
+ * Both count down, so rows are scanned from row_counter's period down to 0.
+ * The address changes while the row that was on display is dark - the latch
+ * waits for that - and before firmware starts the next OE window. Firmware
+ * sets both periods and restarts both counts between two latches, once a frame.
+ */
+wire latch_clock, plane_tc;
+wire [6:0] row;
 
-assign State_0 = State[0];
-assign State_1 = State[1];
-assign State_2 = State[2];
+assign State_0 = row[0];
+assign State_1 = row[1];
+assign State_2 = row[2];
 
 assign reset = resetHW;
 
@@ -87,45 +142,116 @@ cy_psoc3_udb_clock_enable_v1_0 #(.sync_mode(`TRUE ))
                         /* input */ .enable(control_1[0])
                         );
 	
-/* Instance of Control Register in direct mode */						
-cy_psoc3_control #(.cy_force_order(`TRUE ), .cy_ctrl_mode_1(8'b00000000), .cy_ctrl_mode_0(8'b00000000), .cy_init_value(0), .cy_ext_reset(0))
+/* Instance of Control Register in direct mode, bit 2 (oe_start) in pulse mode */						
+cy_psoc3_control #(.cy_force_order(`TRUE ), .cy_ctrl_mode_1(8'b00000100), .cy_ctrl_mode_0(8'b00000100), .cy_init_value(0), .cy_ext_reset(0))
     ControlReg_1 (
-//                /* input          */ .clock(clock),
+                  /* input          */ .clock(ClockOutFromEnBlock),
                   /* input          */ .reset(reset),
                   /* output [07:00] */ .control(control_1)
                   );         
 
+/* Instance of UDB Clock Enable for the row address counters, one clock per latch */
+cy_psoc3_udb_clock_enable_v1_0 #(.sync_mode(`TRUE ))
+    latch_clock_block (
+                        /* output */.clock_out(latch_clock),
+                        /* input */ .clock_in(clock),
+                        /* input */ .enable(lat)
+                        );
+
+/* Planes of the row, see above: terminal count before the first plane's latch */
+cy_psoc3_count7 #(.cy_period(7'd0), .cy_route_ld(`FALSE), .cy_route_en(`FALSE))
+    plane_counter (
+                   /* input          */ .clock(latch_clock),
+                   /* input          */ .reset(reset),
+                   /* input          */ .load(1'b0),
+                   /* input          */ .enable(1'b1),
+                   /* output [06:00] */ .count(),
+                   /* output         */ .tc(plane_tc)
+                   );
+
+/* Row address, see above: A, B, C are count[2:0] */
+cy_psoc3_count7 #(.cy_period(7'd7), .cy_route_ld(`FALSE), .cy_route_en(`TRUE))
+    row_counter (
+                 /* input          */ .clock(latch_clock),
+                 /* input          */ .reset(reset),
+                 /* input          */ .load(1'b0),
+                 /* input          */ .enable(plane_tc),
+                 /* output [06:00] */ .count(row),
+                 /* output         */ .tc()
+                 );
+
 always @ (posedge ClockOutFromEnBlock)
 begin
 	if(reset)
 	begin
 		State <= STATE_3;
 		count8 <= 3'b111;
+		primed <= 0;
 	end
 	else
 	begin
 		case(State)
-			STATE_0:				// reload both A0 and A1
+			STATE_0:				// reload both A0 and A1 for the first byte of the row or chunk
 			begin
-				State <= STATE_1;
+				State <= STATE_2;
 				count8 <= 3'b111;
+				primed <= 0;
 			end
 			
-			STATE_1:				// shift A0
+			STATE_1,				// shift A0
+			STATE_5:				// shift A0, reload A0 from F0 (last column of a byte, more to come)
 			begin
 				r1 <= so_0;
 				g1 <= so_1;
 				b1 <= so_2;
-				State <= STATE_2;
-				o_clk <=0;
+				r2 <= pend_r2;
+				g2 <= pend_g2;
+				b2 <= pend_b2;
+				o_clk <= 0;
+				primed <= 1;
+				count8 <= count8 - 1;
+				done <= row_more & f1_empty;	// chunk drained, more of the row to come
+				
+				if(count8 == 3'b000)	// last column of this byte
+				begin
+					if(State == STATE_5)
+					begin
+						State <= STATE_2;	// A0/A1 already hold the next byte - no reload cycle
+					end
+					else if(row_more)
+					begin
+						State <= STATE_7;	// end of a chunk not refilled in time: clock out the last column, wait
+					end
+					else
+					begin
+						State <= STATE_6;	// no more bytes: clock out the last column
+					end
+				end
+				else if((count8 == 3'b001) && !f1_empty)
+				begin
+					State <= STATE_4;	// next column is the last one, and there is another byte waiting
+				end
+				else
+				begin
+					State <= STATE_2;
+				end
 			end
 			
-			STATE_2:				// shift A1
+			STATE_2,				// shift A1
+			STATE_4:				// shift A1, reload A1 from F1
 			begin
-				r2 <= so_0;
-				g2 <= so_1;
-				b2 <= so_2;
-				State <= STATE_4;
+				pend_r2 <= so_0;
+				pend_g2 <= so_1;
+				pend_b2 <= so_2;
+				o_clk <= primed;		// clock out the previous column
+				if(State == STATE_4)
+				begin
+					State <= STATE_5;
+				end
+				else
+				begin
+					State <= STATE_1;
+				end
 			end
 			
 			STATE_3:				// done
@@ -146,42 +272,35 @@ begin
 				end
 			end
 			
-			STATE_4:				// VERILOG only state - clock out the value
+			STATE_6:				// VERILOG only state - clock out the last column of the row, then latch
 			begin
-				o_clk <= 1;
-				if(count8 == 3'b000)	// after 8 shifts
+				o_clk <= primed;		// last o_clk edge first, lat no earlier than the clock after it
+				primed <= 0;
+				if(primed || (oe_hw && !oe_dark))
 				begin
-					if(f1_empty)	// if f1 is empty, wait for CPU to write 4 bytes to F0 and F1
-					begin
-						done <=  1;	// signal the firmware/ISR to begin filling the FIFO!
-						lat <= 1;	// pass data to output
-						State <= STATE_3;
-					end
-					else			// f1 is not empty - there are more bytes in the FIFO to be shifted out
-					begin
-						State <= STATE_0;
-					end
+					State <= STATE_6;	// previous row is still on display - latch once it is dark
 				end
 				else
 				begin
-					State <= STATE_1;
+					done <=  1;			// signal the firmware/ISR to begin filling the FIFO!
+					lat <= 1;			// pass data to output
+					State <= STATE_3;
 				end
-				count8 <= count8 - 1;
-			end
-			
-			STATE_5:						// unused
-			begin
-				State <= STATE_3;
 			end
 			
-			STATE_6:						// unused
+			STATE_7:				// VERILOG only state - between two chunks of a row
 			begin
-				State <= STATE_3;
-			end
-			
-			STATE_7:						// unused
-			begin
-				State <= STATE_3;
+				o_clk <= primed;		// clock out the last column of the chunk, then hold low
+				primed <= 0;
+				if(f1_notfull)
+				begin
+					State <= STATE_7;
+				end
+				else
+				begin
+					State <= STATE_0;
+					done <= 0;
+				end
 			end
 			
 		endcase
@@ -208,14 +327,14 @@ cy_psoc3_dp8 #(.a0_init_a(A0_init_a), .a1_init_a(A1_init_a), .d0_init_a(D0_init_
     `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
     `CS_CMP_SEL_CFGA, /*CFGRAM3:      Done*/
-    `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
-    `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
+    `CS_ALU_OP_PASS, `CS_SRCA_A1, `CS_SRCB_D0,
+    `CS_SHFT_OP___SR, `CS_A0_SRC_NONE, `CS_A1_SRC___F1,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
-    `CS_CMP_SEL_CFGA, /*CFGRAM4:            */
+    `CS_CMP_SEL_CFGA, /*CFGRAM4:        Shift A1 right out, reload A1*/
     `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
-    `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
+    `CS_SHFT_OP___SR, `CS_A0_SRC___F0, `CS_A1_SRC_NONE,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
-    `CS_CMP_SEL_CFGA, /*CFGRAM5:            */
+    `CS_CMP_SEL_CFGA, /*CFGRAM5:        Shift A0 right out, reload A0*/
     `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
     `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
@@ -287,14 +406,14 @@ cy_psoc3_dp8 #(.a0_init_a(A0_init_a), .a1_init_a(A1_init_a), .d0_init_a(D0_init_
     `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
     `CS_CMP_SEL_CFGA, /*CFGRAM3:      Done*/
-    `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
-    `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
+    `CS_ALU_OP_PASS, `CS_SRCA_A1, `CS_SRCB_D0,
+    `CS_SHFT_OP___SR, `CS_A0_SRC_NONE, `CS_A1_SRC___F1,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
-    `CS_CMP_SEL_CFGA, /*CFGRAM4:            */
+    `CS_CMP_SEL_CFGA, /*CFGRAM4:        Shift A1 right out, reload A1*/
     `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
-    `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
+    `CS_SHFT_OP___SR, `CS_A0_SRC___F0, `CS_A1_SRC_NONE,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
-    `CS_CMP_SEL_CFGA, /*CFGRAM5:            */
+    `CS_CMP_SEL_CFGA, /*CFGRAM5:        Shift A0 right out, reload A0*/
     `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
     `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
@@ -366,14 +485,14 @@ cy_psoc3_dp8 #(.a0_init_a(A0_init_a), .a1_init_a(A1_init_a), .d0_init_a(D0_init_
     `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
     `CS_CMP_SEL_CFGA, /*CFGRAM3:      Done*/
-    `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
-    `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
+    `CS_ALU_OP_PASS, `CS_SRCA_A1, `CS_SRCB_D0,
+    `CS_SHFT_OP___SR, `CS_A0_SRC_NONE, `CS_A1_SRC___F1,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
-    `CS_CMP_SEL_CFGA, /*CFGRAM4:            */
+    `CS_CMP_SEL_CFGA, /*CFGRAM4:        Shift A1 right out, reload A1*/
     `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
-    `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
+    `CS_SHFT_OP___SR, `CS_A0_SRC___F0, `CS_A1_SRC_NONE,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
-    `CS_CMP_SEL_CFGA, /*CFGRAM5:            */
+    `CS_CMP_SEL_CFGA, /*CFGRAM5:        Shift A0 right out, reload A0*/
     `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
     `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
     `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
@@ -424,6 +543,86 @@ cy_psoc3_dp8 #(.a0_init_a(A0_init_a), .a1_init_a(A1_init_a), .d0_init_a(D0_init_
         /*  output                  */  .f1_bus_stat(),
         /*  output                  */  .f1_blk_stat()
 );
+
+/* OE window counter, see above: D0 = window in units, D1 = clocks per unit - 1 */
+cy_psoc3_dp8 #(.a0_init_a(0), .a1_init_a(0), .d0_init_a(0), 
+.d1_init_a((1 << OE_PRESCALE) - 1), 
+.cy_dpconfig_a(
+{
+    `CS_ALU_OP__DEC, `CS_SRCA_A1, `CS_SRCB_D0,
+    `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC__ALU,
+    `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
+    `CS_CMP_SEL_CFGA, /*CFGRAM0:        Lit, count the unit down*/
+    `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
+    `CS_SHFT_OP_PASS, `CS_A0_SRC___D0, `CS_A1_SRC___D1,
+    `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
+    `CS_CMP_SEL_CFGA, /*CFGRAM1:        Start: A0 = D0, A1 = D1*/
+    `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
+    `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
+    `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
+    `CS_CMP_SEL_CFGA, /*CFGRAM2:        Dark*/
+    `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
+    `CS_SHFT_OP_PASS, `CS_A0_SRC___D0, `CS_A1_SRC___D1,
+    `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
+    `CS_CMP_SEL_CFGA, /*CFGRAM3:        Start: A0 = D0, A1 = D1*/
+    `CS_ALU_OP__DEC, `CS_SRCA_A0, `CS_SRCB_D0,
+    `CS_SHFT_OP_PASS, `CS_A0_SRC__ALU, `CS_A1_SRC___D1,
+    `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
+    `CS_CMP_SEL_CFGA, /*CFGRAM4:        Lit, unit over: count the window down, A1 = D1*/
+    `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
+    `CS_SHFT_OP_PASS, `CS_A0_SRC___D0, `CS_A1_SRC___D1,
+    `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
+    `CS_CMP_SEL_CFGA, /*CFGRAM5:        Start: A0 = D0, A1 = D1*/
+    `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
+    `CS_SHFT_OP_PASS, `CS_A0_SRC_NONE, `CS_A1_SRC_NONE,
+    `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
+    `CS_CMP_SEL_CFGA, /*CFGRAM6:        Dark*/
+    `CS_ALU_OP_PASS, `CS_SRCA_A0, `CS_SRCB_D0,
+    `CS_SHFT_OP_PASS, `CS_A0_SRC___D0, `CS_A1_SRC___D1,
+    `CS_FEEDBACK_DSBL, `CS_CI_SEL_CFGA, `CS_SI_SEL_CFGA,
+    `CS_CMP_SEL_CFGA, /*CFGRAM7:        Start: A0 = D0, A1 = D1*/
+    8'hFF, 8'h00,  /*CFG9:            */
+    8'hFF, 8'hFF,  /*CFG11-10:            */
+    `SC_CMPB_A1_D1, `SC_CMPA_A1_D1, `SC_CI_B_ARITH,
+    `SC_CI_A_ARITH, `SC_C1_MASK_DSBL, `SC_C0_MASK_DSBL,
+    `SC_A_MASK_DSBL, `SC_DEF_SI_0, `SC_SI_B_DEFSI,
+    `SC_SI_A_DEFSI, /*CFG13-12:            */
+    `SC_A0_SRC_ACC, `SC_SHIFT_SR, 1'h0,
+    1'h0, `SC_FIFO1_BUS, `SC_FIFO0_BUS,
+    `SC_MSB_DSBL, `SC_MSB_BIT0, `SC_MSB_NOCHN,
+    `SC_FB_NOCHN, `SC_CMP1_NOCHN,
+    `SC_CMP0_NOCHN, /*CFG15-14:            */
+    10'h00, `SC_FIFO_CLK_BUS,`SC_FIFO_CAP_FX,
+    `SC_FIFO_LEVEL,`SC_FIFO__SYNC,`SC_EXTCRC_DSBL,
+    `SC_WRK16CAT_DSBL /*CFG17-16:            */
+}
+)) datapath_3(
+        /*  input                   */  .reset(reset),
+        /*  input                   */  .clk(ClockOutFromEnBlock),
+        /*  input   [02:00]         */  .cs_addr({oe_tick, oe_dark, oe_start}),
+        /*  input                   */  .route_si(1'b0),
+        /*  input                   */  .route_ci(1'b0),
+        /*  input                   */  .f0_load(1'b0),
+        /*  input                   */  .f1_load(1'b0),
+        /*  input                   */  .d0_load(1'b0),
+        /*  input                   */  .d1_load(1'b0),
+        /*  output                  */  .ce0(),
+        /*  output                  */  .cl0(),
+        /*  output                  */  .z0(oe_dark),								// window over
+        /*  output                  */  .ff0(),
+        /*  output                  */  .ce1(),
+        /*  output                  */  .cl1(),
+        /*  output                  */  .z1(oe_tick),								// unit over
+        /*  output                  */  .ff1(),
+        /*  output                  */  .ov_msb(),
+        /*  output                  */  .co_msb(),
+        /*  output                  */  .cmsb(),
+        /*  output                  */  .so(),
+        /*  output                  */  .f0_bus_stat(),
+        /*  output                  */  .f0_blk_stat(),
+        /*  output                  */  .f1_bus_stat(),
+        /*  output                  */  .f1_blk_stat()
+);
 //`#end` -- edit above this line, do not edit this line
 endmodule
 //`#start footer` -- edit after this line, do not edit this line
@@ -0,0 +1,584 @@
+/* ========================================
+ *
+ * Self-checking testbench for LED_Matrix_v1_00, on the primitive models in
+ * cypress.v next to it. A model of the refresh ISR in main.c fills the FIFOs
+ * with random planes whenever done rises, after a random latency, and lights
+ * each latched row for a BCM window. The panel side is checked every clock:
+ *
+ * - pixel order: the columns clocked in before each latch are the bits of the
+ *   row's bytes, LSB first, byte 0 first
+ * - clk/lat/oe timing: data is steady for a clock before o_clk rises, lat
+ *   only rises with o_clk low and at least a clock after its last rising edge,
+ *   rows are only latched while OE is dark, and each window lasts exactly
+ *   period * 2^OE_PRESCALE clocks
+ * - F0/F1 reload order against a reference model of the shifter: all three
+ *   datapaths reload together, F1 never behind F0 and never more than one byte
+ *   ahead, A0/A1 only reloaded once all 8 bits are out and only shifted while
+ *   they hold some, and every byte of the row used by the latch
+ * - row address: State_0..2 only change while OE is dark, and from the latch
+ *   of a row's first plane on show that row, rows going downwards
+ * - row time: UDB clocks from the reload that starts a row to its latch,
+ *   leaving out clocks spent waiting for a chunk refill or for OE to go
+ *   dark, at most ROW_CLOCKS_MAX - a third under the 104 clocks per 32
+ *   columns of the three-clock shifter
+ *
+ * Run with the Makefile here; it prints PASS or FAIL.
+ *
+ * ========================================
+ */
+`timescale 1ns/1ps
+
+module LED_Matrix_tb;
+
+parameter ROW_BYTES = 4;		// bytes per FIFO and row: 4 per chained panel
+parameter SCAN_ROWS = 4;
+parameter PLANES = 3;
+parameter FRAMES = 2;
+parameter LATENCY_MIN = 2;		// done to the ISR's first register write, in clocks
+parameter LATENCY_MAX = 40;
+parameter WRITE_CLOCKS = 1;		// clocks per CPU register write
+parameter SEED = 1;
+
+localparam FIFO_DEPTH = 4;
+localparam CHUNKS = ROW_BYTES / FIFO_DEPTH;
+localparam COLUMNS = ROW_BYTES * 8;
+localparam OE_UNIT = 4;			// 2^OE_PRESCALE
+localparam ROWS_TOTAL = FRAMES * SCAN_ROWS * PLANES;
+localparam TIMEOUT = ROWS_TOTAL * (COLUMNS * 2 + 2000);
+localparam ROW_CLOCKS_BASE = 104;	// per FIFO load of 32 columns, three clocks a column
+localparam ROW_CLOCKS_MAX = ROW_CLOCKS_BASE * 2 / 3 * CHUNKS;
+
+/* ControlReg_1 bits, as in the API header */
+localparam [7:0] CTRL_ENABLE = 8'h01;
+localparam [7:0] CTRL_OE_START = 8'h04;
+localparam [7:0] CTRL_OE_HW = 8'h08;
+localparam [7:0] CTRL_ROW_MORE = 8'h20;
+localparam [7:0] REFRESH_CONTROL = CTRL_ENABLE | CTRL_OE_HW;
+
+reg clock;
+reg reset;
+wire r1, g1, b1, r2, g2, b2, o_clk, lat, oe, done;
+wire state_0, state_1, state_2;
+wire [2:0] row_addr = {state_2, state_1, state_0};
+
+initial
+begin
+	clock = 0;
+	forever #5 clock = ~clock;
+end
+
+LED_Matrix_v1_00 dut(
+	.b1(b1),
+	.b2(b2),
+	.done(done),
+	.g1(g1),
+	.g2(g2),
+	.lat(lat),
+	.o_clk(o_clk),
+	.oe(oe),
+	.r1(r1),
+	.r2(r2),
+	.State_0(state_0),
+	.State_1(state_1),
+	.State_2(state_2),
+	.clock(clock),
+	.resetHW(reset)
+);
+
+integer seed;
+integer errors;
+
+/* ---------------- firmware model ---------------- */
+
+/* plane bytes: ((row * PLANES + plane) * ROW_BYTES + byte) * 6 + channel,
+ * channels r/g/b of the upper half, then r/g/b of the lower half
+ */
+reg [7:0] pixels [0:SCAN_ROWS * PLANES * ROW_BYTES * 6 - 1];
+
+integer fill_row, fill_plane, fill_frame;	// plane in the FIFOs / shifter / latch, rows downwards
+integer chunk;
+integer filled;								// planes written so far
+integer exp_row, exp_plane;					// the plane the next latch must show
+integer windows [0:ROWS_TOTAL];				// lit windows started, in clocks
+integer win_head, win_tail;
+reg pending;
+
+/* OE period of a plane: short windows in frame 0, none and long ones that
+ * outlast the next row's shift in frame 1
+ */
+function integer period_of(input integer plane, input integer frame);
+begin
+	if(frame == 0)
+		period_of = 5 << plane;
+	else if(plane == 0)
+		period_of = 0;
+	else
+		period_of = 15 << plane;
+end
+endfunction
+
+task bus_cycle;
+begin
+	repeat(WRITE_CLOCKS) @(negedge clock);
+	#1;
+end
+endtask
+
+task write_control(input [7:0] value);
+begin
+	bus_cycle;
+	dut.ControlReg_1.write(value);
+end
+endtask
+
+/* F0_REG_0 .. F1_REG_0 of one byte column, F1_REG_0 last */
+task write_column(input integer base);
+begin
+	bus_cycle;
+	dut.datapath_0.write_f0(pixels[base + 0]);
+	bus_cycle;
+	dut.datapath_1.write_f0(pixels[base + 1]);
+	bus_cycle;
+	dut.datapath_2.write_f0(pixels[base + 2]);
+	bus_cycle;
+	dut.datapath_1.write_f1(pixels[base + 4]);
+	bus_cycle;
+	dut.datapath_2.write_f1(pixels[base + 5]);
+	bus_cycle;
+	dut.datapath_0.write_f1(pixels[base + 3]);
+end
+endtask
+
+/* main.c FIFO_EMPTY */
+task refresh_isr;
+	integer k;
+begin
+	if(chunk == 0)
+	begin
+		if(filled != 0)
+		begin
+			/* the plane filled last time is latched: light it */
+			if(oe !== 1'b1)
+			begin
+				$display("%0t: window started while OE is lit", $time);
+				errors = errors + 1;
+			end
+			bus_cycle;
+			dut.datapath_3.write_d0(period_of(fill_plane, fill_frame));
+			write_control(REFRESH_CONTROL | CTRL_OE_START);
+			if(period_of(fill_plane, fill_frame) != 0)
+			begin
+				windows[win_tail] = period_of(fill_plane, fill_frame) * OE_UNIT;
+				win_tail = win_tail + 1;
+			end
+
+			fill_plane = fill_plane + 1;
+			if(fill_plane == PLANES)
+			begin
+				fill_plane = 0;
+				fill_row = fill_row - 1;
+				if(fill_row < 0)
+				begin
+					fill_row = SCAN_ROWS - 1;
+					fill_frame = fill_frame + 1;
+				end
+			end
+		end
+		if(filled == ROWS_TOTAL)
+		begin
+			disable refresh_isr;		// lit the last one, nothing left to shift
+		end
+		if((fill_row == SCAN_ROWS - 1) && (fill_plane == 0))
+		begin
+			/* a frame's first plane: the row address counters start over */
+			bus_cycle;
+			dut.row_counter.write_count(0);
+			bus_cycle;
+			dut.plane_counter.write_count(0);
+		end
+		exp_row = fill_row;
+		exp_plane = fill_plane;
+		filled = filled + 1;
+	end
+
+	for(k = 0; k < FIFO_DEPTH; k = k + 1)
+	begin
+		write_column(((fill_row * PLANES + fill_plane) * ROW_BYTES + chunk * FIFO_DEPTH + k) * 6);
+	end
+	if(CHUNKS > 1)
+	begin
+		write_control(REFRESH_CONTROL | ((chunk != CHUNKS - 1) ? CTRL_ROW_MORE : 8'h00));
+	end
+	chunk = (chunk == CHUNKS - 1) ? 0 : chunk + 1;
+end
+endtask
+
+/* isr_2: rising edge of done, pending until the ISR clears it */
+always @(posedge done)
+begin
+	pending = 1;
+end
+
+initial
+begin : firmware
+	integer i, latency;
+
+	seed = SEED;
+	errors = 0;
+	pending = 0;
+	fill_row = SCAN_ROWS - 1;
+	fill_plane = 0;
+	fill_frame = 0;
+	chunk = 0;
+	filled = 0;
+	win_head = 0;
+	win_tail = 0;
+	for(i = 0; i < SCAN_ROWS * PLANES * ROW_BYTES * 6; i = i + 1)
+	begin
+		pixels[i] = $random(seed);
+	end
+
+	reset = 1;
+	dut.ControlReg_1.write(REFRESH_CONTROL);
+	/* Start(), WriteRows() and WritePlanes() */
+	dut.row_counter.write_period(SCAN_ROWS - 1);
+	dut.plane_counter.write_period(PLANES - 1);
+	dut.row_counter.start;
+	dut.plane_counter.start;
+	repeat(4) @(negedge clock);
+	reset = 0;
+
+	/* first plane, then one ISR per done edge */
+	refresh_isr;
+	forever
+	begin
+		wait(pending);
+		latency = LATENCY_MIN + {$random(seed)} % (LATENCY_MAX - LATENCY_MIN + 1);
+		repeat(latency) @(negedge clock);
+		pending = 0;
+		refresh_isr;
+	end
+end
+
+/* ---------------- panel side checks, sampled mid clock ---------------- */
+
+reg [5:0] data_q;
+reg o_clk_q, lat_q, oe_q;
+reg [2:0] row_addr_q;
+reg [5:0] shifted [0:COLUMNS - 1];
+integer column, latched, lit, clocks, last_clk_rise, shown_row;
+wire [5:0] data = {r1, g1, b1, r2, g2, b2};
+
+task check_row;
+	integer c, base;
+	reg [5:0] want;
+begin
+	if(column != COLUMNS)
+	begin
+		$display("%0t: latched %0d columns, not %0d", $time, column, COLUMNS);
+		errors = errors + 1;
+	end
+	for(c = 0; c < column && c < COLUMNS; c = c + 1)
+	begin
+		base = ((exp_row * PLANES + exp_plane) * ROW_BYTES + c / 8) * 6;
+		want = {pixels[base + 0][c % 8], pixels[base + 1][c % 8], pixels[base + 2][c % 8],
+				pixels[base + 3][c % 8], pixels[base + 4][c % 8], pixels[base + 5][c % 8]};
+		if(shifted[c] !== want)
+		begin
+			$display("%0t: row %0d plane %0d column %0d: got %b, want %b",
+				$time, exp_row, exp_plane, c, shifted[c], want);
+			errors = errors + 1;
+		end
+	end
+	column = 0;
+end
+endtask
+
+initial
+begin
+	column = 0;
+	latched = 0;
+	lit = 0;
+	clocks = 0;
+	last_clk_rise = -2;
+	o_clk_q = 0;
+	lat_q = 0;
+	oe_q = 1;
+	data_q = 0;
+	row_addr_q = row_addr;
+	shown_row = -1;
+	@(negedge reset);
+	repeat(2) @(negedge clock);
+
+	forever
+	begin
+		@(negedge clock);
+		clocks = clocks + 1;
+
+		if((o_clk === 1'b1) && (o_clk_q !== 1'b1))
+		begin
+			if(data !== data_q)
+			begin
+				$display("%0t: data changed with the o_clk edge", $time);
+				errors = errors + 1;
+			end
+			if(lat !== 1'b0)
+			begin
+				$display("%0t: o_clk edge while lat is high", $time);
+				errors = errors + 1;
+			end
+			if(column < COLUMNS)
+			begin
+				shifted[column] = data;
+			end
+			column = column + 1;
+			last_clk_rise = clocks;
+		end
+
+		if((lat === 1'b1) && (lat_q !== 1'b1))
+		begin
+			if((o_clk !== 1'b0) || (clocks - last_clk_rise < 1))
+			begin
+				$display("%0t: lat rises with o_clk", $time);
+				errors = errors + 1;
+			end
+			check_row;
+			shown_row = exp_row;
+			latched = latched + 1;
+		end
+
+		if((row_addr !== row_addr_q) && (oe !== 1'b1))
+		begin
+			$display("%0t: row address changed while OE is lit", $time);
+			errors = errors + 1;
+		end
+		if((oe === 1'b0) && (row_addr !== shown_row[2:0]))
+		begin
+			$display("%0t: OE lit on row %0d, row %0d latched", $time, row_addr, shown_row);
+			errors = errors + 1;
+		end
+
+		if((lat === 1'b1) && (oe !== 1'b1))
+		begin
+			$display("%0t: latched while OE is lit", $time);
+			errors = errors + 1;
+		end
+
+		if(oe === 1'b0)
+		begin
+			lit = lit + 1;
+		end
+		else if(oe_q === 1'b0)
+		begin
+			if(win_head == win_tail)
+			begin
+				$display("%0t: OE lit without a window started", $time);
+				errors = errors + 1;
+			end
+			else
+			begin
+				if(lit != windows[win_head])
+				begin
+					$display("%0t: OE window of %0d clocks, want %0d", $time, lit, windows[win_head]);
+					errors = errors + 1;
+				end
+				win_head = win_head + 1;
+			end
+			lit = 0;
+		end
+
+		data_q = data;
+		o_clk_q = o_clk;
+		lat_q = lat;
+		oe_q = oe;
+		row_addr_q = row_addr;
+	end
+end
+
+/* ---------------- F0/F1 reload reference model ---------------- */
+
+integer a0_bits [0:2];		// bits of the byte in A0/A1 still to shift out
+integer a1_bits [0:2];
+integer f0_pops [0:2];
+integer f1_pops [0:2];
+integer rows;
+reg ref_lat_q;
+
+task check_dp(input integer i, input a0_pop, input a1_pop, input a0_shift, input a1_shift);
+begin
+	if(a0_shift)
+	begin
+		if(a0_bits[i] == 0)
+		begin
+			$display("%0t: datapath_%0d: A0 shifted empty", $time, i);
+			errors = errors + 1;
+		end
+		else
+		begin
+			a0_bits[i] = a0_bits[i] - 1;
+		end
+	end
+	if(a1_shift)
+	begin
+		if(a1_bits[i] == 0)
+		begin
+			$display("%0t: datapath_%0d: A1 shifted empty", $time, i);
+			errors = errors + 1;
+		end
+		else
+		begin
+			a1_bits[i] = a1_bits[i] - 1;
+		end
+	end
+	if(a0_pop)
+	begin
+		if(a0_bits[i] != 0)
+		begin
+			$display("%0t: datapath_%0d: A0 reloaded with %0d bits left", $time, i, a0_bits[i]);
+			errors = errors + 1;
+		end
+		a0_bits[i] = 8;
+		f0_pops[i] = f0_pops[i] + 1;
+	end
+	if(a1_pop)
+	begin
+		if(a1_bits[i] != 0)
+		begin
+			$display("%0t: datapath_%0d: A1 reloaded with %0d bits left", $time, i, a1_bits[i]);
+			errors = errors + 1;
+		end
+		a1_bits[i] = 8;
+		f1_pops[i] = f1_pops[i] + 1;
+	end
+	if((f1_pops[i] < f0_pops[i]) || (f1_pops[i] > f0_pops[i] + 1))
+	begin
+		$display("%0t: datapath_%0d: %0d F0 and %0d F1 reloads", $time, i, f0_pops[i], f1_pops[i]);
+		errors = errors + 1;
+	end
+end
+endtask
+
+initial
+begin : reference
+	integer i;
+
+	rows = 0;
+	ref_lat_q = 0;
+	for(i = 0; i < 3; i = i + 1)
+	begin
+		a0_bits[i] = 0;
+		a1_bits[i] = 0;
+		f0_pops[i] = 0;
+		f1_pops[i] = 0;
+	end
+	@(negedge reset);
+
+	forever
+	begin
+		/* the operations the next clock edge carries out */
+		@(negedge clock);
+		if((dut.datapath_0.a0_pop !== dut.datapath_1.a0_pop) || (dut.datapath_0.a0_pop !== dut.datapath_2.a0_pop) ||
+			(dut.datapath_0.a1_pop !== dut.datapath_1.a1_pop) || (dut.datapath_0.a1_pop !== dut.datapath_2.a1_pop))
+		begin
+			$display("%0t: datapaths reload out of step", $time);
+			errors = errors + 1;
+		end
+		check_dp(0, dut.datapath_0.a0_pop, dut.datapath_0.a1_pop, dut.datapath_0.a0_shift, dut.datapath_0.a1_shift);
+		check_dp(1, dut.datapath_1.a0_pop, dut.datapath_1.a1_pop, dut.datapath_1.a0_shift, dut.datapath_1.a1_shift);
+		check_dp(2, dut.datapath_2.a0_pop, dut.datapath_2.a1_pop, dut.datapath_2.a0_shift, dut.datapath_2.a1_shift);
+
+		/* at the latch the whole row has gone through */
+		if((lat === 1'b1) && (ref_lat_q !== 1'b1))
+		begin
+			rows = rows + 1;
+			for(i = 0; i < 3; i = i + 1)
+			begin
+				if((a0_bits[i] != 0) || (a1_bits[i] != 0) ||
+					(f0_pops[i] != rows * ROW_BYTES) || (f1_pops[i] != rows * ROW_BYTES))
+				begin
+					$display("%0t: datapath_%0d at latch %0d: %0d/%0d bits left, %0d/%0d bytes reloaded, want %0d",
+						$time, i, rows, a0_bits[i], a1_bits[i], f0_pops[i], f1_pops[i], rows * ROW_BYTES);
+					errors = errors + 1;
+				end
+			end
+		end
+		ref_lat_q = lat;
+	end
+end
+
+/* ---------------- row time ---------------- */
+
+/* Clocks the shifter spends on a row, sampled like the checks above: the
+ * state the next edge carries out. Starts at the STATE_0 reload, ends with
+ * the clock that raises lat.
+ */
+integer row_clocks, row_clocks_max;
+reg row_active;
+
+initial
+begin
+	row_active = 0;
+	row_clocks = 0;
+	row_clocks_max = 0;
+	@(negedge reset);
+
+	forever
+	begin
+		@(negedge clock);
+		if(row_active && (lat === 1'b1))
+		begin
+			if(row_clocks > ROW_CLOCKS_MAX)
+			begin
+				$display("%0t: row took %0d clocks, want at most %0d", $time, row_clocks, ROW_CLOCKS_MAX);
+				errors = errors + 1;
+			end
+			row_clocks_max = (row_clocks > row_clocks_max) ? row_clocks : row_clocks_max;
+			row_active = 0;
+		end
+		if(!row_active && (dut.State === 3'h0))
+		begin
+			row_active = 1;
+			row_clocks = 0;
+		end
+		/* waiting on the ISR for the next chunk, or on the lit window */
+		if(row_active && !((dut.State === 3'h7) && (dut.primed === 1'b0)) &&
+			!((dut.State === 3'h6) && (dut.primed === 1'b0) && (oe === 1'b0)))
+		begin
+			row_clocks = row_clocks + 1;
+		end
+	end
+end
+
+/* ---------------- end of run ---------------- */
+
+initial
+begin
+	wait(latched == ROWS_TOTAL);
+	/* the last plane's window */
+	repeat(period_of(PLANES - 1, FRAMES - 1) * OE_UNIT + LATENCY_MAX + 200) @(negedge clock);
+	if(win_head != win_tail)
+	begin
+		$display("%0d OE windows never ended", win_tail - win_head);
+		errors = errors + 1;
+	end
+	errors = errors + dut.datapath_0.errors + dut.datapath_1.errors + dut.datapath_2.errors + dut.datapath_3.errors;
+	if(errors == 0)
+	begin
+		$display("PASS: %0d rows of %0d columns in at most %0d clocks (limit %0d), %0d OE windows", latched, COLUMNS,
+			row_clocks_max, ROW_CLOCKS_MAX, win_tail);
+	end
+	else
+	begin
+		$display("FAIL: %0d errors", errors);
+	end
+	$finish;
+end
+
+initial
+begin
+	#(TIMEOUT * 10);
+	$display("FAIL: stuck after %0d of %0d rows, state %0d", latched, ROWS_TOTAL, {state_2, state_1, state_0});
+	$finish;
+end
+
+endmodule
@@ -0,0 +1,445 @@
+/* ========================================
+ *
+ * Simulation stand-in for PSoC Creator's cypress.v, for LED_Matrix_tb.v only.
+ * It holds the configuration macros LED_Matrix_v1_00.v uses and behavioural
+ * models of its four primitives, as far as the component uses them:
+ *
+ * cy_psoc3_dp8:	A0/A1/D0/D1, the ALU and shifter as selected by cs_addr,
+ *					4-byte F0/F1 written by the CPU and read into A0/A1, the
+ *					z/ce/cl/ff compares, so, and the FIFO status in sync'd
+ *					level mode 0 (bus = not full, blk = empty). No chaining,
+ *					carry, CRC, FIFO output mode or D0/D1 loads from FIFOs.
+ * cy_psoc3_control:	direct and pulse mode bits.
+ * cy_psoc3_count7:	the count, its period and the routed enable and load,
+ *					counting once CNT_START is set. tc is taken to be the
+ *					decode of count 0, which the component's row address
+ *					relies on.
+ * cy_psoc3_udb_clock_enable_v1_0: a glitch-free clock gate.
+ *
+ * The CPU side of the registers is a set of tasks (write, write_f0, ...) the
+ * testbench calls hierarchically. Not for synthesis.
+ *
+ * ========================================
+ */
+`ifndef CYPRESS_V
+`define CYPRESS_V
+
+`timescale 1ns/1ps
+
+`define TRUE	1
+`define FALSE	0
+
+/* Dynamic configuration RAM, 16 bits per entry */
+`define CS_ALU_OP_PASS		3'd0
+`define CS_ALU_OP__INC		3'd1
+`define CS_ALU_OP__DEC		3'd2
+`define CS_ALU_OP__ADD		3'd3
+`define CS_ALU_OP__SUB		3'd4
+`define CS_ALU_OP__XOR		3'd5
+`define CS_ALU_OP__AND		3'd6
+`define CS_ALU_OP__OR		3'd7
+`define CS_SRCA_A0			1'd0
+`define CS_SRCA_A1			1'd1
+`define CS_SRCB_D0			2'd0
+`define CS_SRCB_D1			2'd1
+`define CS_SRCB_A0			2'd2
+`define CS_SRCB_A1			2'd3
+`define CS_SHFT_OP_PASS		2'd0
+`define CS_SHFT_OP___SL		2'd1
+`define CS_SHFT_OP___SR		2'd2
+`define CS_SHFT_OP_SWAP		2'd3
+`define CS_A0_SRC_NONE		2'd0
+`define CS_A0_SRC__ALU		2'd1
+`define CS_A0_SRC___D0		2'd2
+`define CS_A0_SRC___F0		2'd3
+`define CS_A1_SRC_NONE		2'd0
+`define CS_A1_SRC__ALU		2'd1
+`define CS_A1_SRC___D1		2'd2
+`define CS_A1_SRC___F1		2'd3
+`define CS_FEEDBACK_DSBL	1'd0
+`define CS_FEEDBACK_ENBL	1'd1
+`define CS_CI_SEL_CFGA		1'd0
+`define CS_CI_SEL_CFGB		1'd1
+`define CS_SI_SEL_CFGA		1'd0
+`define CS_SI_SEL_CFGB		1'd1
+`define CS_CMP_SEL_CFGA		1'd0
+`define CS_CMP_SEL_CFGB		1'd1
+
+/* Static configuration CFG12 - CFG17. The model assumes the settings the
+ * component uses (shift in 0, sync'd level mode FIFOs written by the bus),
+ * so only the widths of these matter.
+ */
+`define SC_CMPB_A1_D1		2'd0
+`define SC_CMPA_A1_D1		2'd0
+`define SC_CI_B_ARITH		2'd0
+`define SC_CI_A_ARITH		2'd0
+`define SC_C1_MASK_DSBL		1'd0
+`define SC_C0_MASK_DSBL		1'd0
+`define SC_A_MASK_DSBL		1'd0
+`define SC_DEF_SI_0			1'd0
+`define SC_SI_B_DEFSI		2'd0
+`define SC_SI_A_DEFSI		2'd0
+`define SC_A0_SRC_ACC		2'd0
+`define SC_SHIFT_SR			2'd0
+`define SC_FIFO1_BUS		1'd0
+`define SC_FIFO0_BUS		1'd0
+`define SC_MSB_DSBL			1'd0
+`define SC_MSB_BIT0			3'd0
+`define SC_MSB_NOCHN		1'd0
+`define SC_FB_NOCHN			1'd0
+`define SC_CMP1_NOCHN		1'd0
+`define SC_CMP0_NOCHN		1'd0
+`define SC_FIFO_CLK_BUS		1'd0
+`define SC_FIFO_CAP_FX		1'd0
+`define SC_FIFO_LEVEL		1'd0
+`define SC_FIFO__SYNC		1'd1
+`define SC_EXTCRC_DSBL		1'd0
+`define SC_WRK16CAT_DSBL	1'd0
+
+module cy_psoc3_dp8 #(
+	parameter [207:0] cy_dpconfig_a = 208'h0,
+	parameter [7:0] a0_init_a = 8'h00,
+	parameter [7:0] a1_init_a = 8'h00,
+	parameter [7:0] d0_init_a = 8'h00,
+	parameter [7:0] d1_init_a = 8'h00
+) (
+	input reset,
+	input clk,
+	input [2:0] cs_addr,
+	input route_si,
+	input route_ci,
+	input f0_load,
+	input f1_load,
+	input d0_load,
+	input d1_load,
+	output ce0,
+	output cl0,
+	output z0,
+	output ff0,
+	output ce1,
+	output cl1,
+	output z1,
+	output ff1,
+	output ov_msb,
+	output co_msb,
+	output cmsb,
+	output so,
+	output reg f0_bus_stat,
+	output reg f0_blk_stat,
+	output reg f1_bus_stat,
+	output reg f1_blk_stat
+);
+
+reg [7:0] a0, a1, d0, d1;
+reg [7:0] f0 [0:3];
+reg [7:0] f1 [0:3];
+reg [1:0] f0_rd, f0_wr, f1_rd, f1_wr;
+reg [2:0] f0_level, f1_level;
+integer errors;
+
+initial
+begin
+	a0 = a0_init_a;
+	a1 = a1_init_a;
+	d0 = d0_init_a;
+	d1 = d1_init_a;
+	f0_rd = 0;
+	f0_wr = 0;
+	f1_rd = 0;
+	f1_wr = 0;
+	f0_level = 0;
+	f1_level = 0;
+	f0_bus_stat = 1;
+	f0_blk_stat = 1;
+	f1_bus_stat = 1;
+	f1_blk_stat = 1;
+	errors = 0;
+end
+
+/* CFGRAM entry cs_addr, entry 0 being the first in the concatenation */
+wire [15:0] cfg = cy_dpconfig_a[207 - 16*cs_addr -: 16];
+wire [2:0] alu_op = cfg[15:13];
+wire srca_sel = cfg[12];
+wire [1:0] srcb_sel = cfg[11:10];
+wire [1:0] shft_op = cfg[9:8];
+wire [1:0] a0_src = cfg[7:6];
+wire [1:0] a1_src = cfg[5:4];
+
+/* what this cycle does, for the testbench's reference checks */
+wire a0_pop = (a0_src == `CS_A0_SRC___F0);
+wire a1_pop = (a1_src == `CS_A1_SRC___F1);
+wire a0_shift = (srca_sel == `CS_SRCA_A0) && (shft_op == `CS_SHFT_OP___SR);	// a bit of A0 out on so
+wire a1_shift = (srca_sel == `CS_SRCA_A1) && (shft_op == `CS_SHFT_OP___SR);
+
+wire [7:0] srca = srca_sel ? a1 : a0;
+reg [7:0] srcb, alu, shifted;
+reg shift_out;
+
+always @*
+begin
+	case(srcb_sel)
+		`CS_SRCB_D0:	srcb = d0;
+		`CS_SRCB_D1:	srcb = d1;
+		`CS_SRCB_A0:	srcb = a0;
+		default:		srcb = a1;
+	endcase
+	case(alu_op)
+		`CS_ALU_OP_PASS:	alu = srca;
+		`CS_ALU_OP__INC:	alu = srca + 8'd1;
+		`CS_ALU_OP__DEC:	alu = srca - 8'd1;
+		`CS_ALU_OP__ADD:	alu = srca + srcb;
+		`CS_ALU_OP__SUB:	alu = srca - srcb;
+		`CS_ALU_OP__XOR:	alu = srca ^ srcb;
+		`CS_ALU_OP__AND:	alu = srca & srcb;
+		default:			alu = srca | srcb;
+	endcase
+	/* shift in is 0 (SC_DEF_SI_0) */
+	case(shft_op)
+		`CS_SHFT_OP___SL:
+		begin
+			shifted = {alu[6:0], 1'b0};
+			shift_out = alu[7];
+		end
+		`CS_SHFT_OP___SR:
+		begin
+			shifted = {1'b0, alu[7:1]};
+			shift_out = alu[0];
+		end
+		`CS_SHFT_OP_SWAP:
+		begin
+			shifted = {alu[3:0], alu[7:4]};
+			shift_out = 1'b0;
+		end
+		default:
+		begin
+			shifted = alu;
+			shift_out = 1'b0;
+		end
+	endcase
+end
+
+assign so = shift_out;
+assign z0 = (a0 == 8'h00);
+assign z1 = (a1 == 8'h00);
+assign ff0 = (a0 == 8'hFF);
+assign ff1 = (a1 == 8'hFF);
+assign ce0 = (a0 == d0);
+assign cl0 = (a0 < d0);
+assign ce1 = (a1 == d1);
+assign cl1 = (a1 < d1);
+assign ov_msb = 1'b0;
+assign co_msb = 1'b0;
+assign cmsb = 1'b0;
+
+/* reset is not modelled: the component holds its state machine in reset instead */
+always @(posedge clk)
+begin
+	/* sync'd status: the FIFOs as they were before this edge */
+	f0_bus_stat <= (f0_level != 3'd4);
+	f0_blk_stat <= (f0_level == 3'd0);
+	f1_bus_stat <= (f1_level != 3'd4);
+	f1_blk_stat <= (f1_level == 3'd0);
+
+	case(a0_src)
+		`CS_A0_SRC__ALU:	a0 <= shifted;
+		`CS_A0_SRC___D0:	a0 <= d0;
+		`CS_A0_SRC___F0:
+		begin
+			if(f0_level == 3'd0)
+			begin
+				$display("%m: %0t: F0 read while empty", $time);
+				errors = errors + 1;
+			end
+			a0 <= f0[f0_rd];
+			f0_rd = f0_rd + 2'd1;
+			f0_level = f0_level - 3'd1;
+		end
+		default:;
+	endcase
+
+	case(a1_src)
+		`CS_A1_SRC__ALU:	a1 <= shifted;
+		`CS_A1_SRC___D1:	a1 <= d1;
+		`CS_A1_SRC___F1:
+		begin
+			if(f1_level == 3'd0)
+			begin
+				$display("%m: %0t: F1 read while empty", $time);
+				errors = errors + 1;
+			end
+			a1 <= f1[f1_rd];
+			f1_rd = f1_rd + 2'd1;
+			f1_level = f1_level - 3'd1;
+		end
+		default:;
+	endcase
+end
+
+/* CPU side */
+task write_f0(input [7:0] value);
+begin
+	if(f0_level == 3'd4)
+	begin
+		$display("%m: %0t: F0 written while full", $time);
+		errors = errors + 1;
+	end
+	else
+	begin
+		f0[f0_wr] = value;
+		f0_wr = f0_wr + 2'd1;
+		f0_level = f0_level + 3'd1;
+	end
+end
+endtask
+
+task write_f1(input [7:0] value);
+begin
+	if(f1_level == 3'd4)
+	begin
+		$display("%m: %0t: F1 written while full", $time);
+		errors = errors + 1;
+	end
+	else
+	begin
+		f1[f1_wr] = value;
+		f1_wr = f1_wr + 2'd1;
+		f1_level = f1_level + 3'd1;
+	end
+end
+endtask
+
+task write_d0(input [7:0] value);
+begin
+	d0 = value;
+end
+endtask
+
+task write_d1(input [7:0] value);
+begin
+	d1 = value;
+end
+endtask
+
+endmodule
+
+module cy_psoc3_control #(
+	parameter cy_force_order = 0,
+	parameter [7:0] cy_ctrl_mode_1 = 8'h00,
+	parameter [7:0] cy_ctrl_mode_0 = 8'h00,
+	parameter [7:0] cy_init_value = 8'h00,
+	parameter cy_ext_reset = 0
+) (
+	input clock,
+	input reset,
+	output [7:0] control
+);
+
+/* mode {1, 0} = 11 is pulse mode: a 1 written shows for one clock */
+localparam [7:0] PULSE = cy_ctrl_mode_1 & cy_ctrl_mode_0;
+
+reg [7:0] level, armed, pulse;
+
+initial
+begin
+	level = cy_init_value & ~PULSE;
+	armed = 8'h00;
+	pulse = 8'h00;
+end
+
+always @(posedge clock)
+begin
+	pulse <= armed;
+	armed = 8'h00;
+end
+
+assign control = level | pulse;
+
+task write(input [7:0] value);
+begin
+	level = value & ~PULSE;
+	armed = armed | (value & PULSE);
+end
+endtask
+
+endmodule
+
+module cy_psoc3_count7 #(
+	parameter [6:0] cy_period = 7'h7F,
+	parameter cy_route_ld = 0,
+	parameter cy_route_en = 0
+) (
+	input clock,
+	input reset,
+	input load,
+	input enable,
+	output reg [6:0] count,
+	output tc
+);
+
+reg [6:0] period;
+reg started;
+
+initial
+begin
+	period = cy_period;
+	count = cy_period;
+	started = 0;
+end
+
+assign tc = (count == 7'd0);
+
+/* reset is not modelled, as for the datapath */
+always @(posedge clock)
+begin
+	if(started && (!cy_route_en || enable))
+	begin
+		count <= ((cy_route_ld && load) || (count == 7'd0)) ? period : count - 7'd1;
+	end
+end
+
+/* CPU side: PERIOD_REG, COUNT_REG and CNT_START in the aux control register */
+task write_period(input [6:0] value);
+begin
+	period = value;
+end
+endtask
+
+task write_count(input [6:0] value);
+begin
+	count = value;
+end
+endtask
+
+task start;
+begin
+	started = 1;
+end
+endtask
+
+endmodule
+
+module cy_psoc3_udb_clock_enable_v1_0 #(
+	parameter sync_mode = `TRUE
+) (
+	output clock_out,
+	input clock_in,
+	input enable
+);
+
+reg enabled;
+
+initial
+begin
+	enabled = 0;
+end
+
+always @(negedge clock_in)
+begin
+	enabled <= enable;
+end
+
+assign clock_out = clock_in & enabled;
+
+endmodule
+
+`endif
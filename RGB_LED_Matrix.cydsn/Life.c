@@ -0,0 +1,220 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include "Life.h"
+#include "Telemetry.h"
+#include "Timebase.h"
+
+#if LIFE_ENABLE
+
+static uint32 field[CANVAS_HEIGHT];
+static uint16 birthRule = LIFE_BIRTH;
+static uint16 surviveRule = LIFE_SURVIVE;
+static uint8 lifeFlags = LIFE_WRAP;
+
+static uint32 randomState = 0x2545F491u;
+static uint32 lastStep = 0;
+static uint32 history[2];			/* hashes of the last two generations */
+static uint8 stale = 0;
+
+/* Sets the rule: masks of LIFE_COUNT(n), LIFE_WRAP in flags for a torus */
+void lifeRule(uint16 birth, uint16 survive, uint8 flags)
+{
+	birthRule = birth;
+	surviveRule = survive;
+	lifeFlags = flags;
+}
+
+/* xorshift32 */
+static uint32 lifeRandom(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+/* A random field, about 3 cells in 8 alive */
+void lifeSeed(void)
+{
+	uint8 y;
+
+	randomState ^= timebaseMillis();
+	if(randomState == 0u)
+	{
+		randomState = 1u;
+	}
+	for(y = 0; y < CANVAS_HEIGHT; y++)
+	{
+		field[y] = lifeRandom() & (lifeRandom() | lifeRandom());
+	}
+	stale = 0;
+}
+
+void lifeSet(int8 x, int8 y, uint8 alive)
+{
+	if((x >= 0) && (x < CANVAS_WIDTH) && (y >= 0) && (y < CANVAS_HEIGHT))
+	{
+		field[y] = alive ? (field[y] | ((uint32)1u << x)) : (field[y] & ~((uint32)1u << x));
+	}
+}
+
+/* Next state of row 'mid' between 'up' and 'down'. edge is all ones to
+ * wrap the row ends round, 0 for dead cells past them.
+ */
+static uint32 lifeRow(uint32 up, uint32 mid, uint32 down, uint32 edge)
+{
+	uint32 w, e, upOnes, upTwos, downOnes, downTwos, midOnes, midTwos;
+	uint32 ones, twos, fours, eights, carry, t, eq, next = 0;
+	uint16 rules = birthRule | surviveRule;
+	uint8 n;
+
+	/* the three cells above each cell, a 2-bit sum by a full adder */
+	w = (up << 1) | ((up >> 31) & edge);
+	e = (up >> 1) | ((up << 31) & edge);
+	upOnes = w ^ up ^ e;
+	upTwos = (w & up) | (e & (w ^ up));
+	/* below */
+	w = (down << 1) | ((down >> 31) & edge);
+	e = (down >> 1) | ((down << 31) & edge);
+	downOnes = w ^ down ^ e;
+	downTwos = (w & down) | (e & (w ^ down));
+	/* either side, a half adder */
+	w = (mid << 1) | ((mid >> 31) & edge);
+	e = (mid >> 1) | ((mid << 31) & edge);
+	midOnes = w ^ e;
+	midTwos = w & e;
+
+	/* the three sums into count bits 1, 2, 4 and 8 */
+	ones = upOnes ^ downOnes ^ midOnes;
+	carry = (upOnes & downOnes) | (midOnes & (upOnes ^ downOnes));
+	t = upTwos ^ downTwos ^ midTwos;
+	fours = (upTwos & downTwos) | (midTwos & (upTwos ^ downTwos));
+	twos = t ^ carry;
+	t &= carry;
+	eights = fours & t;
+	fours ^= t;
+
+	for(n = 0; n <= 8u; n++)
+	{
+		if(!(rules & LIFE_COUNT(n)))
+		{
+			continue;
+		}
+		eq = ((n & 1u) ? ones : ~ones) & ((n & 2u) ? twos : ~twos) &
+			((n & 4u) ? fours : ~fours) & ((n & 8u) ? eights : ~eights);
+		if(birthRule & LIFE_COUNT(n))
+		{
+			next |= eq & ~mid;
+		}
+		if(surviveRule & LIFE_COUNT(n))
+		{
+			next |= eq & mid;
+		}
+	}
+	return next;
+}
+
+/*******************************************************************************
+* Function Name: lifeStep
+********************************************************************************
+*
+* Summary:
+*  Advances the field one generation, in place: each row is replaced once
+*  the row below it has been read, keeping the original of the row above.
+*  Timed as TLM_STAT_LIFE.
+*
+*******************************************************************************/
+void lifeStep(void)
+{
+	uint32 edge = (lifeFlags & LIFE_WRAP) ? 0xFFFFFFFFu : 0u;
+	uint32 first = field[0], above = field[CANVAS_HEIGHT - 1] & edge, mid, below;
+	uint8 y;
+
+	TELEMETRY_STAMP(stepStart);
+	for(y = 0; y < CANVAS_HEIGHT; y++)
+	{
+		mid = field[y];
+		below = (y < CANVAS_HEIGHT - 1) ? field[y + 1] : (first & edge);
+		field[y] = lifeRow(above, mid, below, edge);
+		above = mid;
+	}
+	TELEMETRY_RECORD(TLM_STAT_LIFE, stepStart);
+}
+
+/* Every cell, as alive or dead, straight from the row words */
+void lifeDraw(RGB alive, RGB dead, color *matrix)
+{
+	uint8 y, bits[4];
+
+	for(y = 0; y < CANVAS_HEIGHT; y++)
+	{
+		bits[0] = (uint8)field[y];
+		bits[1] = (uint8)(field[y] >> 8);
+		bits[2] = (uint8)(field[y] >> 16);
+		bits[3] = (uint8)(field[y] >> 24);
+		drawRowBits((int8)y, bits, alive, dead, matrix);
+	}
+}
+
+/*******************************************************************************
+* Function Name: lifeService
+********************************************************************************
+*
+* Summary:
+*  Every LIFE_GENERATION_MS, steps and draws the field. A field that has
+*  died out or settled into still lifes and blinkers - the same as one or
+*  two generations back - for LIFE_STALE_GENERATIONS is seeded again.
+*
+* Parameters:
+*   RGB alive:		color of the live cells, the rest are black
+* 	color *matrix: 	pointer to the matrix buffer
+*
+*******************************************************************************/
+void lifeService(RGB alive, color *matrix)
+{
+	static const RGB black = {0u, 0u, 0u};
+	uint32 now = timebaseMillis(), hash = 0;
+	uint8 y;
+
+	if(now - lastStep < LIFE_GENERATION_MS)
+	{
+		return;
+	}
+	lastStep = now;
+	lifeStep();
+
+	for(y = 0; y < CANVAS_HEIGHT; y++)
+	{
+		hash = ((hash << 5) | (hash >> 27)) ^ field[y];
+	}
+	if((hash == history[0]) || (hash == history[1]))
+	{
+		if(++stale >= LIFE_STALE_GENERATIONS)
+		{
+			lifeSeed();
+		}
+	}
+	else
+	{
+		stale = 0;
+	}
+	history[1] = history[0];
+	history[0] = hash;
+
+	lifeDraw(alive, black, matrix);
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,68 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef Life_h_
+#define Life_h_
+#include <device.h>
+#include <LED_Matrix.h>
+
+/* Cellular automaton as main loop mode 6. Leave at 0 to keep it out. Can
+ * be set with -D, as the host tests do.
+ */
+#ifndef LIFE_ENABLE
+#define LIFE_ENABLE					0
+#endif
+
+#if LIFE_ENABLE && (CANVAS_WIDTH != 32)
+#error "LIFE_ENABLE keeps a canvas row in one uint32"
+#endif
+
+/*******************************************************************************
+* Life
+*
+*  The field is CANVAS_HEIGHT uint32 rows, cell x in bit x like the lanes of
+*  'matrix'. A generation counts the neighbors of a whole row at once: the
+*  eight neighbor words are added bit-sliced, with full adders, into four
+*  count words (1s, 2s, 4s, 8s), and the rule picks the counts that give
+*  birth or survival. No loop runs per cell.
+*
+*  Rules are masks of neighbor counts, LIFE_COUNT(n) for each count n:
+*  Conway's B3/S23 is birth LIFE_COUNT(3), survival LIFE_COUNT(2) |
+*  LIFE_COUNT(3).
+********************************************************************************/
+#define LIFE_COUNT(n)				(1u << (n))
+
+/* Rule at start-up */
+#define LIFE_BIRTH					LIFE_COUNT(3)
+#define LIFE_SURVIVE				(LIFE_COUNT(2) | LIFE_COUNT(3))
+
+/* Flags */
+#define LIFE_WRAP					0x01u	/* toroidal: the edges are neighbors */
+
+/* Time per generation in lifeService */
+#define LIFE_GENERATION_MS			120u
+/* Generations a still or blinking field stays before lifeService reseeds */
+#define LIFE_STALE_GENERATIONS		40u
+
+#if LIFE_ENABLE
+void lifeRule(uint16 birth, uint16 survive, uint8 flags);
+void lifeSeed(void);
+void lifeSet(int8 x, int8 y, uint8 alive);
+void lifeStep(void);
+void lifeDraw(RGB alive, RGB dead, color *matrix);
+void lifeService(RGB alive, color *matrix);
+#else
+#define lifeSeed()
+#define lifeService(alive, matrix)
+#endif
+
+#endif
+//[] END OF FILE
@@ -0,0 +1,273 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include "Settings.h"
+#include "Timebase.h"
+
+/* Longest wait for the refresh ISR to start a new frame before a row write.
+ * A frame takes well under a millisecond, so this only runs out with the
+ * refresh stopped.
+ */
+#define SETTINGS_FRAME_WAIT_MS		10u
+
+#define PACK_COLOR(r, g, b)			((uint16)((r) >> 3) | ((uint16)((g) >> 3) << 5) | ((uint16)((b) >> 3) << 10))
+#define UNPACK(v)					(uint8)((((v) & 0x1Fu) << 3) | (((v) & 0x1Fu) >> 2))
+
+/* Reserved rows, read only through SETTINGS_FLASH (see AnimStore.c) */
+static const uint8 settingsFlash[SETTINGS_ROWS * CY_FLASH_SIZEOF_ROW] CY_ALIGN(CY_FLASH_SIZEOF_ROW) = {0u};
+#define SETTINGS_FLASH				((const volatile uint8 *)settingsFlash)
+
+static const uint16 settingsDefault[SETTINGS_COUNT] =
+{
+	3u,						/* SETTING_MODE - clock */
+	64u,					/* SETTING_BRIGHTNESS - a quarter, the panel is bright */
+	SETTINGS_HOUR_24,		/* SETTING_HOUR_FORMAT */
+	PACK_COLOR(255, 0, 0),
+	PACK_COLOR(255, 255, 0),
+	PACK_COLOR(0, 0, 255),
+	PACK_COLOR(0, 255, 255),
+	PACK_COLOR(255, 0, 255),
+	PACK_COLOR(255, 255, 255),
+	PACK_COLOR(255, 128, 128),
+	PACK_COLOR(0, 255, 0),
+	BCM_PLANES				/* SETTING_COLOR_DEPTH */
+};
+
+static uint16 cache[SETTINGS_COUNT];
+static uint16 dirtyMask = 0;
+static uint32 lastChange = 0;
+static uint8 generation = 0;
+
+/* Live row: SETTINGS_ROWS while flash holds no valid row yet */
+static uint8 liveRow = SETTINGS_ROWS;
+static uint16 liveSeq = 0;
+
+/* CRC-8, polynomial 0x07, one byte at a time */
+static uint8 crc8(uint8 crc, uint8 data)
+{
+	uint8 i;
+
+	crc ^= data;
+	for(i = 0; i < 8u; i++)
+	{
+		crc = (crc & 0x80u) ? (uint8)((crc << 1) ^ 0x07u) : (uint8)(crc << 1);
+	}
+	return crc;
+}
+
+static uint32 rowOffset(uint8 row)
+{
+	return (uint32)row * CY_FLASH_SIZEOF_ROW;
+}
+
+/* Header and values end here, the CRC follows */
+static uint32 rowEnd(uint8 count)
+{
+	return SETTINGS_ROW_HEADER_SIZE + 2u * (uint32)count;
+}
+
+static uint8 rowValid(uint8 row)
+{
+	uint32 offset = rowOffset(row), end = rowEnd(SETTINGS_FLASH[offset + 3u]), i;
+	uint8 crc = 0xFFu;
+
+	if((SETTINGS_FLASH[offset] != 'G') || (SETTINGS_FLASH[offset + 1u] != 'S') ||
+	   (SETTINGS_FLASH[offset + 2u] != SETTINGS_VERSION) || (end >= CY_FLASH_SIZEOF_ROW))
+	{
+		return 0;
+	}
+	for(i = 0; i < end; i++)
+	{
+		crc = crc8(crc, SETTINGS_FLASH[offset + i]);
+	}
+	return crc == SETTINGS_FLASH[offset + end];
+}
+
+static uint16 rowRead16(uint8 row, uint32 pos)
+{
+	return (uint16)SETTINGS_FLASH[rowOffset(row) + pos] | ((uint16)SETTINGS_FLASH[rowOffset(row) + pos + 1u] << 8);
+}
+
+/*******************************************************************************
+* Function Name: settingsStart
+********************************************************************************
+*
+* Summary:
+*  Loads the defaults, then the values of the newest valid row from flash
+*  into the RAM cache. Call once at startup, before any settingsGet().
+*
+*******************************************************************************/
+void settingsStart(void)
+{
+	uint8 row, count, k;
+
+	for(k = 0; k < SETTINGS_COUNT; k++)
+	{
+		cache[k] = settingsDefault[k];
+	}
+
+	for(row = 0; row < SETTINGS_ROWS; row++)
+	{
+		if(rowValid(row) && ((liveRow == SETTINGS_ROWS) || ((int16)(rowRead16(row, 4u) - liveSeq) > 0)))
+		{
+			liveRow = row;
+			liveSeq = rowRead16(row, 4u);
+		}
+	}
+	if(liveRow == SETTINGS_ROWS)
+	{
+		return;
+	}
+
+	count = SETTINGS_FLASH[rowOffset(liveRow) + 3u];
+	for(k = 0; (k < count) && (k < SETTINGS_COUNT); k++)
+	{
+		cache[k] = rowRead16(liveRow, rowEnd(k));
+	}
+}
+
+uint16 settingsGet(uint8 key)
+{
+	return (key < SETTINGS_COUNT) ? cache[key] : 0u;
+}
+
+/*******************************************************************************
+* Function Name: settingsSet
+********************************************************************************
+*
+* Summary:
+*  Updates the cache. The flash copy follows SETTINGS_FLUSH_DELAY_MS after the
+*  last change, from settingsService().
+*
+* Return:
+*   1 if the value changed, 0 if it was already set or the key is unknown
+*
+*******************************************************************************/
+uint8 settingsSet(uint8 key, uint16 value)
+{
+	if((key >= SETTINGS_COUNT) || (cache[key] == value))
+	{
+		return 0;
+	}
+	cache[key] = value;
+	dirtyMask |= (uint16)(1u << key);
+	lastChange = timebaseMillis();
+	generation++;
+	return 1;
+}
+
+/* Bumped on every change, so callers can cheaply spot that they need to reload */
+uint8 settingsGeneration(void)
+{
+	return generation;
+}
+
+void settingsGetColor(uint8 n, RGB *c)
+{
+	uint16 v = settingsGet(SETTING_COLOR0 + n);
+
+	c->r = UNPACK(v);
+	c->g = UNPACK(v >> 5);
+	c->b = UNPACK(v >> 10);
+}
+
+void settingsSetColor(uint8 n, RGB c)
+{
+	if(n < SETTING_COLORS)
+	{
+		settingsSet(SETTING_COLOR0 + n, PACK_COLOR(c.r, c.g, c.b));
+	}
+}
+
+/*******************************************************************************
+* Function Name: settingsFlush
+********************************************************************************
+*
+* Summary:
+*  Writes every value now, into the row after the live one, if any changed.
+*
+* Return:
+*   CySysFlashWriteRow() status, CYRET_SUCCESS when nothing was pending
+*
+*******************************************************************************/
+cystatus settingsFlush(void)
+{
+	uint8 rowData[CY_FLASH_SIZEOF_ROW];
+	uint8 k, row, crc = 0xFFu;
+	uint16 seq = liveSeq + 1u;
+	uint32 i, end = rowEnd(SETTINGS_COUNT), flashRow;
+	cystatus status;
+
+	if(dirtyMask == 0u)
+	{
+		return CYRET_SUCCESS;
+	}
+
+	for(i = 0; i < CY_FLASH_SIZEOF_ROW; i++)
+	{
+		rowData[i] = 0xFFu;
+	}
+	rowData[0] = 'G';
+	rowData[1] = 'S';
+	rowData[2] = SETTINGS_VERSION;
+	rowData[3] = SETTINGS_COUNT;
+	rowData[4] = (uint8)seq;
+	rowData[5] = (uint8)(seq >> 8);
+	for(k = 0; k < SETTINGS_COUNT; k++)
+	{
+		rowData[rowEnd(k)] = (uint8)cache[k];
+		rowData[rowEnd(k) + 1u] = (uint8)(cache[k] >> 8);
+	}
+	for(i = 0; i < end; i++)
+	{
+		crc = crc8(crc, rowData[i]);
+	}
+	rowData[end] = crc;
+
+	row = (liveRow + 1u) % SETTINGS_ROWS;
+	flashRow = (((uint32)settingsFlash - CY_FLASH_BASE) / CY_FLASH_SIZEOF_ROW) + row;
+
+	waitFrameStart(SETTINGS_FRAME_WAIT_MS);
+	status = CySysFlashWriteRow(flashRow, rowData);
+	if(status == CYRET_SUCCESS)
+	{
+		liveRow = row;
+		liveSeq = seq;
+		dirtyMask = 0;
+	}
+	return status;
+}
+
+/*******************************************************************************
+* Function Name: settingsService
+********************************************************************************
+*
+* Summary:
+*  Flushes pending changes once they have settled. Call from the main loop.
+*
+*******************************************************************************/
+void settingsService(void)
+{
+	uint32 now = timebaseMillis();
+
+	if((dirtyMask != 0u) && ((now - lastChange) >= SETTINGS_FLUSH_DELAY_MS))
+	{
+		if(settingsFlush() != CYRET_SUCCESS)
+		{
+			/* try again after another delay */
+			lastChange = now;
+		}
+	}
+}
+
+/* [] END OF FILE */
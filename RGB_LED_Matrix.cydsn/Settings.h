@@ -0,0 +1,63 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef Settings_h_
+#define Settings_h_
+#include <device.h>
+#include <LED_Matrix.h>
+
+/*******************************************************************************
+* Persistent settings, a copy of every value rotated over SETTINGS_ROWS
+* reserved flash rows
+*
+*  Row layout (all fields little endian):
+*   0  'G','S'
+*   2  uint8  layout version (SETTINGS_VERSION)
+*   3  uint8  values stored - keys added since take their defaults
+*   4  uint16 sequence number - the valid row with the newest one is live
+*   6  uint16 values, one per key
+*   then   uint8 CRC-8 of everything before it
+*
+*  PSoC 4 flash is erased and programmed a whole row at a time, so every
+*  flush costs a row however little changed. Each one goes into the row after
+*  the live one, which spreads the wear over all SETTINGS_ROWS rows and leaves
+*  the previous copy intact should a reset hit mid-write.
+********************************************************************************/
+#define SETTINGS_ROWS				4u
+#define SETTINGS_VERSION			1u
+#define SETTINGS_ROW_HEADER_SIZE	6u
+
+/* A change is written once nothing else has changed for this long */
+#define SETTINGS_FLUSH_DELAY_MS		5000u
+
+/* Keys */
+#define SETTING_MODE				0u
+#define SETTING_BRIGHTNESS			1u		/* 0 - 255 */
+#define SETTING_HOUR_FORMAT			2u		/* SETTINGS_HOUR_24 or SETTINGS_HOUR_12 */
+#define SETTING_COLOR0				3u		/* 8 colors, top 5 bits of each 8-bit channel: b<<10 | g<<5 | r */
+#define SETTING_COLORS				8u
+#define SETTING_COLOR_DEPTH			(SETTING_COLOR0 + SETTING_COLORS)	/* bit planes shown, 1 - 5 */
+#define SETTINGS_COUNT				(SETTING_COLOR_DEPTH + 1u)
+
+#define SETTINGS_HOUR_24			0u
+#define SETTINGS_HOUR_12			1u
+
+void settingsStart(void);
+uint16 settingsGet(uint8 key);
+uint8 settingsSet(uint8 key, uint16 value);
+uint8 settingsGeneration(void);
+void settingsGetColor(uint8 n, RGB *c);
+void settingsSetColor(uint8 n, RGB c);
+void settingsService(void);
+cystatus settingsFlush(void);
+
+#endif
+//[] END OF FILE
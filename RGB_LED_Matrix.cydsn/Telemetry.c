@@ -0,0 +1,258 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include <core_cm0_psoc4.h>
+#include "Telemetry.h"
+#include <LED_Matrix.h>
+
+#if TELEMETRY_ENABLE
+
+/* Fill pattern used to find the stack high-water mark */
+#define STACK_PAINT					0xA5u
+/* Bytes below the live stack pointer left alone while painting */
+#define STACK_PAINT_GUARD			32u
+
+/* Provided by cm0gcc.ld */
+extern uint8 __cy_stack_limit[];
+
+TelemetryStat telemetryStats[TLM_STAT_COUNT];
+uint32 telemetryCounters[TLM_COUNTER_COUNT];
+
+static uint32 windowStart = 0;
+static uint32 lastSend = 0;
+static uint8 periodic = 0;
+
+/* The snapshot line goes out a few fields at a time from here, so its length
+ * costs no stack: up to four numbers with separators, the line end and '\0'
+ */
+static char8 piece[4u * 11u + 3u];
+
+static void clearStat(TelemetryStat *s)
+{
+	s->count = 0;
+	s->min = 0xFFFFFFFFu;
+	s->max = 0;
+	s->sum = 0;
+}
+
+/* Fills the unused part of the stack so telemetrySend() can see how deep it got */
+static void stackPaint(void)
+{
+	uint8 *p = __cy_stack_limit;
+	uint8 *sp = (uint8 *)__get_MSP() - STACK_PAINT_GUARD;
+
+	while(p < sp)
+	{
+		*p++ = STACK_PAINT;
+	}
+}
+
+static uint32 stackFree(void)
+{
+	uint8 *p = __cy_stack_limit;
+	uint32 unused = 0;
+
+	while(*p++ == STACK_PAINT)
+	{
+		unused++;
+	}
+	return unused;
+}
+
+/* Appends the decimal form of 'value' and a separator to 'buf' */
+static char8 *putDec(char8 *buf, uint32 value, char8 sep)
+{
+	char8 tmp[10];
+	uint8 n = 0;
+
+	do
+	{
+		tmp[n++] = (char8)('0' + (value % 10u));
+		value /= 10u;
+	} while(value != 0u);
+
+	while(n > 0u)
+	{
+		*buf++ = tmp[--n];
+	}
+	*buf++ = sep;
+	return buf;
+}
+
+/*******************************************************************************
+* Function Name: telemetryStart
+********************************************************************************
+*
+* Summary:
+*  Paints the stack and clears all statistics. Call first thing in main(),
+*  after timebaseStart().
+*
+*******************************************************************************/
+void telemetryStart(void)
+{
+	uint8 i;
+
+	stackPaint();
+	for(i = 0; i < TLM_STAT_COUNT; i++)
+	{
+		clearStat(&telemetryStats[i]);
+	}
+	for(i = 0; i < TLM_COUNTER_COUNT; i++)
+	{
+		telemetryCounters[i] = 0;
+	}
+	windowStart = timebaseMillis();
+	lastSend = windowStart;
+}
+
+/*******************************************************************************
+* Function Name: telemetryRecord
+********************************************************************************
+*
+* Summary:
+*  Adds one sample to a timing statistic. Called from ISRs, so it only does
+*  compares and adds.
+*
+* Parameters:
+*   uint8 id: 		one of the TLM_STAT_ defines
+*	uint32 cycles: 	measured duration in SYSCLK cycles
+*
+*******************************************************************************/
+void telemetryRecord(uint8 id, uint32 cycles)
+{
+	TelemetryStat *s = &telemetryStats[id];
+	uint8 interruptState = CyEnterCriticalSection();
+
+	s->count++;
+	s->sum += cycles;
+	if(cycles < s->min)
+	{
+		s->min = cycles;
+	}
+	if(cycles > s->max)
+	{
+		s->max = cycles;
+	}
+
+	CyExitCriticalSection(interruptState);
+}
+
+/* Terminates 'piece' at 'end' and sends it */
+static void sendPiece(char8 *end)
+{
+	*end = '\0';
+	hostLinkPutString(piece);
+}
+
+/*******************************************************************************
+* Function Name: telemetrySend
+********************************************************************************
+*
+* Summary:
+*  Sends one snapshot line and starts a new measurement window. Format:
+*  TLM,<sysclk Hz>,<window ms>,<free stack>,<framebuffer bytes>,<bytes saved>,
+*  <counters...>,{<n>,<min>,<avg>,<max>}...
+*  Bytes saved is what the palette mode spares against the full bit plane
+*  buffer, 0 without it and negative when a virtual canvas costs more.
+*  A statistic with no samples reports 0 for min/avg/max.
+*  Each counter and statistic is copied and reset on its own as the line goes
+*  out, so the window of a value ends when it is sent rather than all at once.
+*
+*******************************************************************************/
+void telemetrySend(void)
+{
+	TelemetryStat stat;
+	uint32 now, window, counter;
+	char8 *p;
+	uint8 i, interruptState;
+
+	now = timebaseMillis();
+	window = now - windowStart;
+	windowStart = now;
+	lastSend = now;
+
+	p = piece;
+	*p++ = 'T'; *p++ = 'L'; *p++ = 'M'; *p++ = ',';
+	p = putDec(p, CYDEV_BCLK__SYSCLK__HZ, ',');
+	p = putDec(p, window, ',');
+	sendPiece(p);
+
+	p = putDec(piece, stackFree(), ',');
+	p = putDec(p, MATRIX_FB_BYTES, ',');
+	if(MATRIX_FB_BYTES > MATRIX_LANES * sizeof(color))
+	{
+		/* a virtual canvas can cost more than it saves */
+		*p++ = '-';
+		p = putDec(p, MATRIX_FB_BYTES - MATRIX_LANES * sizeof(color), ',');
+	}
+	else
+	{
+		p = putDec(p, MATRIX_LANES * sizeof(color) - MATRIX_FB_BYTES, ',');
+	}
+	sendPiece(p);
+
+	/* Take each value and reset it in one go, so ISR updates land in the next window */
+	for(i = 0; i < TLM_COUNTER_COUNT; i++)
+	{
+		interruptState = CyEnterCriticalSection();
+		counter = telemetryCounters[i];
+		telemetryCounters[i] = 0;
+		CyExitCriticalSection(interruptState);
+
+		sendPiece(putDec(piece, counter, ','));
+	}
+	for(i = 0; i < TLM_STAT_COUNT; i++)
+	{
+		interruptState = CyEnterCriticalSection();
+		stat = telemetryStats[i];
+		clearStat(&telemetryStats[i]);
+		CyExitCriticalSection(interruptState);
+
+		if(stat.count == 0u)
+		{
+			stat.min = 0;
+		}
+		p = putDec(piece, stat.count, ',');
+		p = putDec(p, stat.min, ',');
+		p = putDec(p, (stat.count != 0u) ? (stat.sum / stat.count) : 0u, ',');
+		p = putDec(p, stat.max, ',');
+		if(i == TLM_STAT_COUNT - 1u)
+		{
+			p[-1] = '\r';
+			*p++ = '\n';
+		}
+		sendPiece(p);
+	}
+}
+
+/* Sends the periodic snapshot when it is due */
+void telemetryService(void)
+{
+	if(periodic && ((timebaseMillis() - lastSend) >= TELEMETRY_PERIOD_MS))
+	{
+		telemetrySend();
+	}
+}
+
+void telemetrySetPeriodic(uint8 enable)
+{
+	periodic = enable;
+}
+
+uint8 telemetryGetPeriodic(void)
+{
+	return periodic;
+}
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,96 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef Telemetry_h_
+#define Telemetry_h_
+#include <device.h>
+#include "Timebase.h"
+#include "HostLink.h"
+#include "Compositor.h"
+
+/* Set to 1 to compile the telemetry hooks in. At 0 every TELEMETRY_* macro
+ * below expands to nothing, so the ISRs and main loop are untouched.
+ * Snapshots go out over the host link, so it needs HOSTLINK_ENABLE too.
+ */
+#define TELEMETRY_ENABLE			0
+
+#if TELEMETRY_ENABLE && !HOSTLINK_ENABLE
+#error "TELEMETRY_ENABLE needs HOSTLINK_ENABLE"
+#endif
+
+/* Period of the unsolicited snapshot when periodic mode is on */
+#define TELEMETRY_PERIOD_MS			1000u
+
+/* Timing statistics - min/avg/max in SYSCLK cycles */
+#define TLM_STAT_REFRESH_ISR		0u		/* FIFO_EMPTY execution time */
+#define TLM_STAT_I2C				1u		/* one RTC transaction */
+#define TLM_STAT_ANIM_DECODE		2u		/* decoding one animation frame from flash */
+#define TLM_STAT_DITHER				3u		/* one ditherService phase step */
+#define TLM_STAT_ROW_EXPAND			4u		/* paletteExpandRow, inside FIFO_EMPTY */
+#define TLM_STAT_GLYPH				5u		/* one drawString character */
+#define TLM_STAT_EFFECT				6u		/* one effectService frame */
+#define TLM_STAT_LIFE				7u		/* one lifeStep generation */
+#define TLM_STAT_LAYER0				8u		/* one layer of a compositorService pass, one slot per layer */
+#define TLM_LAYERS					COMPOSITOR_LAYERS
+#define TLM_STAT_LOOP_MODE0			(TLM_STAT_LAYER0 + TLM_LAYERS)	/* main loop iteration, one slot per mode */
+#define TLM_LOOP_MODES				7u
+#define TLM_STAT_COUNT				(TLM_STAT_LOOP_MODE0 + TLM_LOOP_MODES)
+
+/* Event counters - reset with every snapshot, so they read as rates */
+#define TLM_COUNT_FRAMES			0u		/* complete refresh frames */
+#define TLM_COUNT_EOC				1u		/* eoc_isr calls */
+#define TLM_COUNT_ADC_DROPPED		2u		/* ADC frames overwritten before main read them */
+#define TLM_COUNT_DL_DRAWN			3u		/* display list items replayed */
+#define TLM_COUNT_DL_SKIPPED		4u		/* display list items a render left alone */
+#define TLM_COUNTER_COUNT			5u
+
+typedef struct
+{
+	uint32 count;
+	uint32 min;
+	uint32 max;
+	uint32 sum;
+} TelemetryStat;
+
+#if TELEMETRY_ENABLE
+
+extern TelemetryStat telemetryStats[TLM_STAT_COUNT];
+extern uint32 telemetryCounters[TLM_COUNTER_COUNT];
+
+void telemetryStart(void);
+void telemetryRecord(uint8 id, uint32 cycles);
+void telemetrySend(void);
+void telemetryService(void);
+void telemetrySetPeriodic(uint8 enable);
+uint8 telemetryGetPeriodic(void);
+
+#define TELEMETRY_STAMP(t)			uint32 t = timebaseCycles()
+#define TELEMETRY_RECORD(id, t)		telemetryRecord((id), timebaseCycles() - (t))
+#define TELEMETRY_COUNT(id)			(telemetryCounters[(id)]++)
+#define TELEMETRY_ADD(id, n)		(telemetryCounters[(id)] += (n))
+
+#else
+
+#define telemetryStart()
+#define telemetrySend()
+#define telemetryService()
+#define telemetrySetPeriodic(enable)
+#define telemetryGetPeriodic()		0u
+
+#define TELEMETRY_STAMP(t)
+#define TELEMETRY_RECORD(id, t)
+#define TELEMETRY_COUNT(id)
+#define TELEMETRY_ADD(id, n)
+
+#endif
+
+#endif
+//[] END OF FILE
@@ -0,0 +1,77 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include <core_cm0_psoc4.h>
+#include "Timebase.h"
+
+/* SysTick is system exception 15 in the vector table */
+#define TIMEBASE_SYSTICK_VECTOR		15u
+
+static volatile uint32 ticks = 0;
+
+CY_ISR(SysTick_ISR)
+{
+	ticks++;
+}
+
+/*******************************************************************************
+* Function Name: timebaseStart
+********************************************************************************
+*
+* Summary:
+*  Hooks the SysTick vector and starts a 1 ms tick from SYSCLK
+*
+*******************************************************************************/
+void timebaseStart(void)
+{
+	CyIntSetSysVector(TIMEBASE_SYSTICK_VECTOR, SysTick_ISR);
+	(void)SysTick_Config(TIMEBASE_CYCLES_PER_TICK);
+}
+
+uint32 timebaseMillis(void)
+{
+	return ticks;
+}
+
+/*******************************************************************************
+* Function Name: timebaseCycles
+********************************************************************************
+*
+* Summary:
+*  Returns a free-running SYSCLK cycle count. Safe to call from any ISR: if the
+*  counter has reloaded but the tick is still pending (we are running at a
+*  higher priority), the missing tick is added here.
+*
+* Return:
+*   uint32 cycle timestamp, wraps every 2^32 cycles
+*
+*******************************************************************************/
+uint32 timebaseCycles(void)
+{
+	uint32 ms, val;
+
+	do
+	{
+		ms = ticks;
+		val = SysTick->VAL;
+	} while(ms != ticks);
+
+	if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && (val > (TIMEBASE_CYCLES_PER_TICK / 2u)))
+	{
+		ms++;
+	}
+
+	return (ms * TIMEBASE_CYCLES_PER_TICK) + ((TIMEBASE_CYCLES_PER_TICK - 1u) - val);
+}
+
+/* [] END OF FILE */
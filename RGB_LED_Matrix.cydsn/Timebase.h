@@ -0,0 +1,29 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef Timebase_h_
+#define Timebase_h_
+#include <device.h>
+
+/* SysTick runs off SYSCLK and interrupts once per millisecond.
+ * The millisecond count plus the SysTick down-counter give a free-running
+ * cycle timestamp that needs no TCPWM or UDB resources.
+ */
+#define TIMEBASE_TICK_HZ			1000u
+#define TIMEBASE_CYCLES_PER_TICK	(CYDEV_BCLK__SYSCLK__HZ / TIMEBASE_TICK_HZ)
+#define TIMEBASE_CYCLES_PER_US		(CYDEV_BCLK__SYSCLK__HZ / 1000000u)
+
+void timebaseStart(void);
+uint32 timebaseMillis(void);
+uint32 timebaseCycles(void);
+
+#endif
+//[] END OF FILE
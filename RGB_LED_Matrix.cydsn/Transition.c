@@ -0,0 +1,281 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <device.h>
+#include "Transition.h"
+#include "Timebase.h"
+
+#if TRANSITION_ENABLE
+
+volatile uint8 transitionActive = 0;
+
+static color previous[MATRIX_LANES];		/* outgoing frame */
+/* Per panel row: the row of 'matrix' and of 'previous' shown there, and per
+ * lane the pixels taken from 'matrix'
+ */
+static uint8 inRow[MATRIX_HEIGHT];
+static uint8 outRow[MATRIX_HEIGHT];
+static uint8 mask[MATRIX_LANES];
+
+static uint8 kind;
+static uint16 duration;
+static uint8 target;				/* brightness to fade around and restore */
+static uint32 started;
+static uint16 lastLevel;
+
+/* Threshold of every pixel of an 8x8 tile, 0 - 63: lower ones switch first */
+static const uint8 bayer8[8][8] =
+{
+	{ 0, 32,  8, 40,  2, 34, 10, 42},
+	{48, 16, 56, 24, 50, 18, 58, 26},
+	{12, 44,  4, 36, 14, 46,  6, 38},
+	{60, 28, 52, 20, 62, 30, 54, 22},
+	{ 3, 35, 11, 43,  1, 33,  9, 41},
+	{51, 19, 59, 27, 49, 17, 57, 25},
+	{15, 47,  7, 39, 13, 45,  5, 37},
+	{63, 31, 55, 23, 61, 29, 53, 21}
+};
+
+/*******************************************************************************
+* Function Name: transitionStart
+********************************************************************************
+*
+* Summary:
+*  Takes what 'matrix' holds now as the outgoing frame and starts a
+*  transition to whatever is drawn into it from here on. Starting again
+*  while one runs takes the frame drawn so far as the outgoing one.
+*
+* Parameters:
+*   uint8 kind:			TRANSITION_*
+*	uint16 ms:			length
+*	uint8 brightness:	the current setBrightness level, for TRANSITION_FADE
+*
+*******************************************************************************/
+void transitionStart(uint8 kind_, uint16 ms, uint8 brightness)
+{
+	uint16 i;
+	uint8 k, *dst, *src;
+
+	if(transitionActive && (kind == TRANSITION_FADE))
+	{
+		setBrightness(target);
+	}
+	transitionActive = 0;
+	if((kind_ == TRANSITION_CUT) || (ms == 0u))
+	{
+		return;
+	}
+
+	for(i = 0; i < MATRIX_LANES; i++)
+	{
+		dst = (uint8 *)&previous[i];
+		src = (uint8 *)&matrix[i];
+		for(k = 0; k < sizeof(color); k++)
+		{
+			dst[k] = src[k];
+		}
+		mask[i] = 0;
+	}
+	for(k = 0; k < MATRIX_HEIGHT; k++)
+	{
+		inRow[k] = k;
+		outRow[k] = k;
+	}
+
+	kind = kind_;
+	duration = ms;
+	target = brightness;
+	started = timebaseMillis();
+	lastLevel = 0;
+	transitionActive = 1;
+}
+
+/* Lane masks of a vertical edge: columns below 'edge' from 'matrix' */
+static void wipeMasks(uint8 edge)
+{
+	uint8 lane, y, m;
+
+	for(lane = 0; lane < MATRIX_ROW_BYTES; lane++)
+	{
+		if(edge >= (lane + 1u) * 8u)
+		{
+			m = 0xFFu;
+		}
+		else if(edge <= lane * 8u)
+		{
+			m = 0;
+		}
+		else
+		{
+			m = (uint8)((1u << (edge - lane * 8u)) - 1u);
+		}
+		for(y = 0; y < MATRIX_HEIGHT; y++)
+		{
+			mask[MATRIX_LANE(lane * 8u, y)] = m;
+		}
+	}
+}
+
+/* Pixels with a tile threshold below 'level' (0 - 64) from 'matrix'. A
+ * lane is one tile wide, so a row's lanes share its mask.
+ */
+static void dissolveMasks(uint8 level)
+{
+	uint8 y, x, m, lane;
+
+	for(y = 0; y < MATRIX_HEIGHT; y++)
+	{
+		for(x = 0, m = 0; x < 8u; x++)
+		{
+			if(bayer8[y & 7u][x] < level)
+			{
+				m |= (uint8)(1u << x);
+			}
+		}
+		for(lane = 0; lane < MATRIX_ROW_BYTES; lane++)
+		{
+			mask[MATRIX_LANE(lane * 8u, y)] = m;
+		}
+	}
+}
+
+/* Rows moved 'offset' towards row 0, the incoming frame following on */
+static void slideRows(uint8 offset)
+{
+	uint8 y, lane, m;
+
+	for(y = 0; y < MATRIX_HEIGHT; y++)
+	{
+		if(y + offset < MATRIX_HEIGHT)
+		{
+			outRow[y] = y + offset;
+			m = 0;
+		}
+		else
+		{
+			inRow[y] = y + offset - MATRIX_HEIGHT;
+			m = 0xFFu;
+		}
+		for(lane = 0; lane < MATRIX_ROW_BYTES; lane++)
+		{
+			mask[MATRIX_LANE(lane * 8u, y)] = m;
+		}
+	}
+}
+
+/*******************************************************************************
+* Function Name: transitionService
+********************************************************************************
+*
+* Summary:
+*  Brings the masks and rows the refresh ISR mixes by up to the time elapsed,
+*  in 256 steps over the transition, and ends it once the time is up. Call
+*  every main loop pass.
+*
+*******************************************************************************/
+void transitionService(void)
+{
+	uint32 elapsed;
+	uint16 level;
+
+	if(!transitionActive)
+	{
+		return;
+	}
+	elapsed = timebaseMillis() - started;
+	if(elapsed >= duration)
+	{
+		transitionActive = 0;
+		if(kind == TRANSITION_FADE)
+		{
+			setBrightness(target);
+		}
+		return;
+	}
+	level = (uint16)((elapsed << 8) / duration);
+	if(level == lastLevel)
+	{
+		return;
+	}
+	lastLevel = level;
+
+	switch(kind)
+	{
+		case TRANSITION_WIPE:
+			wipeMasks((uint8)((level * MATRIX_WIDTH) >> 8));
+			break;
+		case TRANSITION_SLIDE:
+			slideRows((uint8)((level * MATRIX_HEIGHT) >> 8));
+			break;
+		case TRANSITION_DISSOLVE:
+			dissolveMasks((uint8)((level + 3u) >> 2));
+			break;
+		case TRANSITION_FADE:
+			/* out to black on the old frame, then back up on the new */
+			if(level < 128u)
+			{
+				setBrightness((uint8)(((uint16)target * (127u - level)) / 127u));
+			}
+			else
+			{
+				if(mask[0] == 0u)
+				{
+					wipeMasks(MATRIX_WIDTH);
+				}
+				setBrightness((uint8)(((uint16)target * (level - 128u)) / 127u));
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/*******************************************************************************
+* Function Name: transitionShift
+********************************************************************************
+*
+* Summary:
+*  The refresh ISR's FIFO fill while a transition runs: MATRIX_FIFO_DEPTH
+*  lanes of one plane of both halves of scan row 'row', mixed.
+*
+* Parameters:
+*   uint8 row: 		scan row, 0 to MATRIX_SCAN_ROWS - 1
+*	uint8 lane:		first lane of the chunk within the row
+*	uint8 plane:	bit plane
+*
+*******************************************************************************/
+void transitionShift(uint8 row, uint8 lane, uint8 plane)
+{
+	const color *inUpper = &matrix[MATRIX_LANE(0, inRow[row]) + lane];
+	const color *outUpper = &previous[MATRIX_LANE(0, outRow[row]) + lane];
+	const color *inLower = &matrix[MATRIX_LANE(0, inRow[row + MATRIX_SCAN_ROWS]) + lane];
+	const color *outLower = &previous[MATRIX_LANE(0, outRow[row + MATRIX_SCAN_ROWS]) + lane];
+	const uint8 *maskUpper = &mask[MATRIX_LANE(0, row) + lane];
+	const uint8 *maskLower = &mask[MATRIX_LANE(0, row + MATRIX_SCAN_ROWS) + lane];
+	uint8 k, mu, ml;
+
+	for(k = 0; k < MATRIX_FIFO_DEPTH; k++)
+	{
+		mu = maskUpper[k];
+		ml = maskLower[k];
+		LED_Matrix_1_F0_REG_0 = (uint8)((inUpper[k].r[plane] & mu) | (outUpper[k].r[plane] & ~mu));
+		LED_Matrix_1_F0_REG_1 = (uint8)((inUpper[k].g[plane] & mu) | (outUpper[k].g[plane] & ~mu));
+		LED_Matrix_1_F0_REG_2 = (uint8)((inUpper[k].b[plane] & mu) | (outUpper[k].b[plane] & ~mu));
+		LED_Matrix_1_F1_REG_1 = (uint8)((inLower[k].g[plane] & ml) | (outLower[k].g[plane] & ~ml));
+		LED_Matrix_1_F1_REG_2 = (uint8)((inLower[k].b[plane] & ml) | (outLower[k].b[plane] & ~ml));
+		LED_Matrix_1_F1_REG_0 = (uint8)((inLower[k].r[plane] & ml) | (outLower[k].r[plane] & ~ml));
+	}
+}
+
+#endif
+
+/* [] END OF FILE */
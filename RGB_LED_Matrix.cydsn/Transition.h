@@ -0,0 +1,61 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef Transition_h_
+#define Transition_h_
+#include <device.h>
+#include <LED_Matrix.h>
+
+/* Timed transitions between modes instead of a cut. Costs a second plane
+ * buffer, MATRIX_LANES * 15 bytes, so leave at 0 unless the RAM is there.
+ */
+#define TRANSITION_ENABLE			0
+
+#if TRANSITION_ENABLE && (LED_MATRIX_PALETTE || !LED_MATRIX_HW_BCM)
+#error "TRANSITION_ENABLE needs LED_MATRIX_HW_BCM and the full plane buffer"
+#endif
+
+/*******************************************************************************
+* Transitions
+*
+*  transitionStart() keeps a copy of 'matrix' as the outgoing frame; the new
+*  mode goes on drawing into 'matrix' as usual. Until the time is up the
+*  refresh ISR shifts out a mix of the two, plane byte by plane byte:
+*  (incoming & mask) | (outgoing & ~mask), each panel row read from a row of
+*  either frame. transitionService() sets the masks and rows from the time
+*  elapsed, so the length does not depend on how fast the mode draws.
+*
+*  Wipes and slides follow the rows and columns of the panel chain, which
+*  are the canvas's unless CANVAS_MAPPED.
+********************************************************************************/
+#define TRANSITION_CUT				0u
+#define TRANSITION_WIPE				1u		/* edge across the columns from column 0 */
+#define TRANSITION_SLIDE			2u		/* incoming pushes outgoing towards row 0 */
+#define TRANSITION_DISSOLVE			3u		/* pixels switch over in 8x8 ordered-dither order */
+#define TRANSITION_FADE				4u		/* brightness down on outgoing, up on incoming */
+
+/* What main uses on a mode change */
+#define TRANSITION_KIND				TRANSITION_DISSOLVE
+#define TRANSITION_MS				400u
+
+#if TRANSITION_ENABLE
+extern volatile uint8 transitionActive;
+
+void transitionStart(uint8 kind, uint16 ms, uint8 brightness);
+void transitionService(void);
+void transitionShift(uint8 row, uint8 lane, uint8 plane);
+#else
+#define transitionStart(kind, ms, brightness)
+#define transitionService()
+#endif
+
+#endif
+//[] END OF FILE
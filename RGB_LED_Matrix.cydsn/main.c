@@ -1,35 +1,192 @@
+#include <string.h>
 #include <device.h>
 #include <LED_Matrix.h>
 #include "I2CDriver.h"
+#include "Telemetry.h"
+#include "AnimStore.h"
+#include "Settings.h"
+#include "Buttons.h"
+#include "Compositor.h"
+#include "DisplayList.h"
+#include "Effects.h"
+#include "Life.h"
+#include "Transition.h"
 
 uint8 j = 0, pwm_count = 0;
 uint8 bit_shift;
 uint16 adcMax[8]={0,0,0,0,0,0,0,0};
-color matrix[16*4];
+color matrix[MATRIX_BUFFER_LANES];
+volatile uint8 refreshFrames = 0;
 
 int mode = 3;
+#if LIFE_ENABLE
+#define LAST_MODE	6
+#elif EFFECTS_ENABLE
+#define LAST_MODE	5
+#else
+#define LAST_MODE	4
+#endif
 CY_ISR(PB_ISR)
 {
-	if(mode == 0)
+	buttonEdge();
+}
+
+/* Mode after 'm' on a short press - the animation only when one is stored,
+ * the effects and Life only with EFFECTS_ENABLE and LIFE_ENABLE
+ */
+int nextMode(int m)
+{
+	if(m == 0)
 	{
-		mode=1;
+		return 1;
 	}
-	else if(mode==1)
+	else if(m==1)
 	{
-		mode=2;
+		return 2;
 	}
-    else if(mode==2)
+    else if(m==2)
 	{
-		mode=3;
+		return 3;
 	}
+    else if(m==3 && animValid())
+    {
+        return 4;
+    }
+#if EFFECTS_ENABLE
+    else if(m==3 || m==4)
+    {
+        return 5;
+    }
+#endif
+#if LIFE_ENABLE
+    else if(m>=3 && m<=5)
+    {
+        return 6;
+    }
+#endif
     else
     {
-        mode=0;   
+        return 0;   
     }
 }
 
+#if MATRIX_FIFO_DEPTH != LED_Matrix_1_FIFO_DEPTH
+#error "MATRIX_FIFO_DEPTH does not match the LED_Matrix component's FIFOs"
+#endif
+
+#if LED_MATRIX_HW_BCM
+/* lowest plane of the frame being refreshed - bcmFirstPlane as of its start */
+uint8 firstPlane = 0;
+
+#if MATRIX_ROW_CHUNKS > 1
+/* FIFO-sized chunk of the row the ISR fills next */
+uint8 chunk = 0;
+#endif
+
+/* ControlReg_1 while the component refreshes, OE_START and ROW_MORE aside */
+#define REFRESH_CONTROL		(LED_Matrix_1_CTRL_ENABLE | LED_Matrix_1_CTRL_OE_HW)
+
 CY_ISR(FIFO_EMPTY)
 {
+	color *upper, *lower;
+	uint8 k;
+#if MATRIX_ROW_CHUNKS > 1 || TRANSITION_ENABLE
+	uint8 lane = 0;
+#endif
+
+	TELEMETRY_STAMP(isrStart);
+
+	*isr_2_INTC_CLR_PD = isr_2__INTC_MASK;
+
+#if MATRIX_ROW_CHUNKS > 1
+	/* the first chunk of a row is requested at the latch, the others
+	 * mid-row as soon as the previous chunk has left the FIFOs
+	 */
+	if(chunk == 0)
+#endif
+	{
+		/* The plane shifted in last time has just been latched (the component
+		 * waits for the previous window to end first) and the component has
+		 * moved the row address to it: light it for its weight.
+		 */
+		LED_Matrix_1_WriteOEPeriod(bcmPeriod[bit_shift]);
+		LED_Matrix_1_StartOE();
+
+		/* then shift the next plane in while this one is on display */
+		bit_shift++;
+		if(bit_shift == BCM_PLANES)
+		{
+			bit_shift = firstPlane;
+			
+			/* rows go downwards, as the component's row counter counts */
+			if(j == 0)
+			{
+				j = MATRIX_SCAN_ROWS;
+				refreshFrames++;
+				TELEMETRY_COUNT(TLM_COUNT_FRAMES);
+				
+				/* depth and brightness only ever change between frames */
+				firstPlane = bcmFirstPlane;
+				bit_shift = firstPlane;
+				
+				/* the counters only move at a latch and the next one is this
+				 * plane's: both start over there, at row MATRIX_SCAN_ROWS - 1,
+				 * and the plane counter takes up the new depth with it
+				 */
+				LED_Matrix_1_WritePlanes(BCM_PLANES - firstPlane);
+				LED_Matrix_1_RestartRows();
+			}
+			j--;
+#if LED_MATRIX_PALETTE
+			/* the previous row is fully latched and its longest plane is
+			 * lit, so its half of the buffer is free for this one
+			 */
+			paletteExpandRow(j, matrix);
+#endif
+		}
+	}
+
+	/* F1_REG_0 last in every column of bytes: the shifter reloads mid-row as
+	 * soon as it holds data
+	 */
+	upper = &matrix[MATRIX_UPPER(j)];
+	lower = &matrix[MATRIX_LOWER(j)];
+#if MATRIX_ROW_CHUNKS > 1
+	lane = chunk*MATRIX_FIFO_DEPTH;
+	upper += lane;
+	lower += lane;
+#endif
+#if TRANSITION_ENABLE
+	if(transitionActive)
+	{
+		transitionShift(j, lane, bit_shift);
+	}
+	else
+#endif
+	for(k = 0; k < MATRIX_FIFO_DEPTH; k++)
+	{
+		LED_Matrix_1_F0_REG_0 = (uint8)upper[k].r[bit_shift];
+		LED_Matrix_1_F0_REG_1 = (uint8)upper[k].g[bit_shift];
+		LED_Matrix_1_F0_REG_2 = (uint8)upper[k].b[bit_shift];
+		LED_Matrix_1_F1_REG_1 = (uint8)lower[k].g[bit_shift];
+		LED_Matrix_1_F1_REG_2 = (uint8)lower[k].b[bit_shift];
+		LED_Matrix_1_F1_REG_0 = (uint8)lower[k].r[bit_shift];
+	}
+#if MATRIX_ROW_CHUNKS > 1
+	/* the component latches the row after the chunk written without ROW_MORE.
+	 * Only clear it once the chunk is in: a shifter that has run dry meanwhile
+	 * would take the end of the previous chunk for the end of the row.
+	 */
+	LED_Matrix_1_WriteControl(REFRESH_CONTROL | ((chunk != MATRIX_ROW_CHUNKS - 1) ? LED_Matrix_1_CTRL_ROW_MORE : 0u));
+	chunk = (chunk == MATRIX_ROW_CHUNKS - 1) ? 0 : chunk + 1;
+#endif
+
+	TELEMETRY_RECORD(TLM_STAT_REFRESH_ISR, isrStart);
+}
+#else
+CY_ISR(FIFO_EMPTY)
+{
+	TELEMETRY_STAMP(isrStart);
 
 	*isr_2_INTC_CLR_PD = isr_2__INTC_MASK;
 	
@@ -45,12 +202,16 @@ CY_ISR(FIFO_EMPTY)
 	{
 		bit_shift = 0;
 		pwm_count = 0;
-		j++;
 		
-		if(j == 8)
+		/* rows go downwards, as the component's row counter counts */
+		if(j == 0)
 		{
-			j = 0;
+			j = 8;
+			refreshFrames++;
+			TELEMETRY_COUNT(TLM_COUNT_FRAMES);
+			LED_Matrix_1_RestartRows();
 		}
+		j--;
 	}
 
 	LED_Matrix_1_F0_REG_0 = (uint8)matrix[0 + j*4].r[bit_shift];
@@ -83,11 +244,12 @@ CY_ISR(FIFO_EMPTY)
 	LED_Matrix_1_F1_REG_0 = (uint8)matrix[2 + (j+8)*4].r[bit_shift];
 
 	LED_Matrix_1_WriteControl(0x03);
-	
-	Row_Select(j);
 
 	LED_Matrix_1_F1_REG_0 = (uint8)matrix[3 + (j+8)*4].r[bit_shift];
+
+	TELEMETRY_RECORD(TLM_STAT_REFRESH_ISR, isrStart);
 }
+#endif
 uint8 dataReady = 0;
 uint16 result[8] = {0,0,0,0,0,0,0,0};
 uint8 oldResult[8] = {0,0,0,0,0,0,0,0};
@@ -112,10 +274,264 @@ CY_ISR(eoc_isr)
 			result[w] = 0;
 		}
 	}
+	TELEMETRY_COUNT(TLM_COUNT_EOC);
+	if(dataReady == 1)
+	{
+		/* main loop never picked up the previous conversion */
+		TELEMETRY_COUNT(TLM_COUNT_ADC_DROPPED);
+	}
 	dataReady = 1;
 	
 }
 
+#if COMPOSITOR_ENABLE
+/* Clock mode on layers: the level bars under the time, and a banner over
+ * both when a setting changes. The panel is mounted upside down (compare
+ * printTime), so the text layers are turned round.
+ */
+#define CLOCK_TEXT_TOP			4
+#define CLOCK_TEXT_ROWS			8u
+#define CLOCK_BANNER_MS			1500u
+
+uint8 barPixels[LAYER_BYTES(LAYER_4BPP, CANVAS_HEIGHT)];
+uint8 timePixels[LAYER_BYTES(LAYER_1BPP, CLOCK_TEXT_ROWS)];
+uint8 bannerPixels[LAYER_BYTES(LAYER_1BPP, CLOCK_TEXT_ROWS)];
+RGB barColors[16];
+RGB timeColors[2];
+const RGB bannerColors[2] = {{0, 0, 96}, {255, 255, 255}};
+uint16 timeShown = 0xFFFF;			/* BCD hour and minute on the layer */
+uint32 bannerStart = 0;
+uint8 bannerOn = 0;
+
+/* Bars dimmed to a quarter so the time stands out */
+void clockLayersColor(const RGB *colors)
+{
+	uint8 i;
+
+	for(i = 0; i < 8; i++)
+	{
+		barColors[1 + i].r = colors[i].r >> 2;
+		barColors[1 + i].g = colors[i].g >> 2;
+		barColors[1 + i].b = colors[i].b >> 2;
+	}
+	timeColors[1] = colors[2];
+	layerTouch(LAYER_BACKGROUND);
+	layerTouch(LAYER_CONTENT);
+}
+
+void clockLayersStart(const RGB *colors)
+{
+	layerInit(LAYER_BACKGROUND, LAYER_4BPP, barPixels, 0, CANVAS_HEIGHT, barColors, 0, 0);
+	layerInit(LAYER_CONTENT, LAYER_1BPP, timePixels, CLOCK_TEXT_TOP, CLOCK_TEXT_ROWS, timeColors, 0,
+		LAYER_ROTATE_180);
+	layerInit(LAYER_OVERLAY, LAYER_1BPP, bannerPixels, CLOCK_TEXT_TOP, CLOCK_TEXT_ROWS, bannerColors,
+		LAYER_NO_KEY, LAYER_ROTATE_180);
+	layerClear(LAYER_BACKGROUND, 0);
+	layerClear(LAYER_CONTENT, 0);
+	layerShow(LAYER_OVERLAY, 0);
+	timeShown = 0xFFFF;
+	clockLayersColor(colors);
+}
+
+void clockBanner(const char8 *text)
+{
+	layerClear(LAYER_OVERLAY, 0);
+	layerString(LAYER_OVERLAY, (CANVAS_WIDTH - measureString(text, &font5x7)) / 2, 0, text, &font5x7, 1);
+	layerShow(LAYER_OVERLAY, 1);
+	bannerStart = timebaseMillis();
+	bannerOn = 1;
+}
+
+/* Redraws only the layers whose content changed */
+void clockLayersUpdate(const PCF8583 *rtc)
+{
+	char8 text[6];
+	uint8 i, k = 0;
+
+	if(dataReady == 1)
+	{
+		dataReady = 0;
+		if(ifDataChange(&oldResult[0], &result[0]) == 1)
+		{
+			for(i = 0; i < 8; i++)
+			{
+				oldResult[i] = ((uint8)(result[i] >> 6)) & 0x1F;
+			}
+			scaleResult(&scaledResult[0], &oldResult[0]);
+			for(i = 0; i < 8; i++)
+			{
+				/* rows 0 to h in bar i, like drawblock */
+				layerFillRect(LAYER_BACKGROUND, i*BLOCK_WIDTH, 0, BLOCK_WIDTH, scaledResult[i] + 1, 1 + i);
+				layerFillRect(LAYER_BACKGROUND, i*BLOCK_WIDTH, scaledResult[i] + 1, BLOCK_WIDTH, CANVAS_HEIGHT, 0);
+			}
+		}
+	}
+
+	if((((uint16)rtc->hour << 8) | rtc->minute) != timeShown)
+	{
+		timeShown = ((uint16)rtc->hour << 8) | rtc->minute;
+		if(rtc->hour >> 4)
+		{
+			text[k++] = '0' + (rtc->hour >> 4);
+		}
+		text[k++] = '0' + (rtc->hour & 0x0F);
+		text[k++] = ':';
+		text[k++] = '0' + (rtc->minute >> 4);
+		text[k++] = '0' + (rtc->minute & 0x0F);
+		text[k] = 0;
+		layerClear(LAYER_CONTENT, 0);
+		layerString(LAYER_CONTENT, (CANVAS_WIDTH - measureString(text, &font5x7)) / 2, 0, text, &font5x7, 1);
+	}
+
+	if(bannerOn && ((timebaseMillis() - bannerStart) >= CLOCK_BANNER_MS))
+	{
+		bannerOn = 0;
+		layerShow(LAYER_OVERLAY, 0);
+	}
+}
+#elif DISPLAY_LIST_ENABLE
+/* Clock mode as printTime's digits on the display list: only the digits
+ * that changed, and the colon blinking, cost a redraw of their rows.
+ */
+uint8 clockItems[5];				/* hour tens, hour, colon, minute tens, minute */
+
+void clockListStart(RGB c)
+{
+	clockItems[0] = dlDigit(24, 2, 1, c);
+	clockItems[1] = dlDigit(18, 2, 0, c);
+	clockItems[2] = dlDigit(15, 2, DL_DIGIT_COLON, c);
+	clockItems[3] = dlDigit(7, 2, 0, c);
+	clockItems[4] = dlDigit(1, 2, 0, c);
+}
+
+void clockListColor(RGB c)
+{
+	uint8 i;
+
+	for(i = 0; i < 5; i++)
+	{
+		dlSetColor(clockItems[i], c);
+	}
+}
+
+/* The same digits printTime would draw */
+void clockListUpdate(const PCF8583 *rtc)
+{
+	dlShow(clockItems[0], (rtc->hour >> 4) != 0);
+	dlSetDigit(clockItems[1], rtc->hour & 0x0F);
+	dlShow(clockItems[2], (rtc->sec % 2) == 0);
+	dlSetDigit(clockItems[3], rtc->minute >> 4);
+	dlSetDigit(clockItems[4], rtc->minute & 0x0F);
+}
+#else
+/* Clock mode straight onto the matrix, without the display list or layers.
+ * Only the digits that changed are redrawn, and like compositorService only
+ * at the first pass after the refresh wraps to row 0. On a single panel each
+ * row of them is built on a copy and put back in one go, so the scan never
+ * catches a digit blank.
+ */
+#define CLOCK_DIGITS			5u
+#define CLOCK_NONE				0xFFu	/* digit or colon not shown */
+
+/* hour tens, hour, colon, minute tens, minute, where printTime puts them */
+const int8 clockX[CLOCK_DIGITS] = {24, 18, 15, 7, 1};
+uint8 clockShown[CLOCK_DIGITS];
+uint8 clockAll = 1;					/* the whole matrix to redraw, e.g. after another mode */
+uint8 clockFrame = 0;
+#if CANVAS_ROW_LANES
+color clockRow[MATRIX_ROW_BYTES];
+#endif
+
+int16 clockRight(uint8 n)
+{
+	return clockX[n] + ((n == 2u) ? 2 : DL_DIGIT_WIDTH) - 1;
+}
+
+void clockDraw(const PCF8583 *rtc, RGB c, color *matrix)
+{
+	static const RGB black = {0u, 0u, 0u};
+	uint8 want[CLOCK_DIGITS], n;
+	int16 left = CANVAS_WIDTH, right = -1, top = CANVAS_HEIGHT, bottom = -1, y;
+	color *dst = matrix;
+#if CANVAS_ROW_LANES
+	uint8 first, lanes;
+#endif
+
+	if(refreshFrames == clockFrame)
+	{
+		return;
+	}
+	clockFrame = refreshFrames;
+
+	/* what printTime would draw */
+	want[0] = (rtc->hour >> 4) ? 1u : CLOCK_NONE;
+	want[1] = rtc->hour & 0x0F;
+	want[2] = ((rtc->sec % 2) == 0) ? DL_DIGIT_COLON : CLOCK_NONE;
+	want[3] = rtc->minute >> 4;
+	want[4] = rtc->minute & 0x0F;
+	for(n = 0; n < CLOCK_DIGITS; n++)
+	{
+		if(clockAll || (want[n] != clockShown[n]))
+		{
+			left = (clockX[n] < left) ? clockX[n] : left;
+			right = (clockRight(n) > right) ? clockRight(n) : right;
+			/* the colon's dots are rows 3 to 8 of the digits' 13 */
+			top = (n == 2u) ? ((top < 5) ? top : 5) : 2;
+			bottom = (n == 2u) ? ((bottom > 10) ? bottom : 10) : 2 + DL_DIGIT_HEIGHT - 1;
+			clockShown[n] = want[n];
+		}
+	}
+	if(clockAll)
+	{
+		left = 0;
+		right = CANVAS_WIDTH - 1;
+		top = 0;
+		bottom = CANVAS_HEIGHT - 1;
+		clockAll = 0;
+	}
+	if(left > right)
+	{
+		return;
+	}
+#if CANVAS_ROW_LANES
+	first = (uint8)(left / 8);
+	lanes = (uint8)(right / 8 - first + 1);
+#endif
+
+	for(y = top; y <= bottom; y++)
+	{
+#if CANVAS_ROW_LANES
+		/* the draw calls index lanes from the top of the matrix: this base
+		 * puts row y on the copy, and the clip keeps them there
+		 */
+		memcpy(&clockRow[first], &matrix[MATRIX_LANE(0, y) + first], lanes * sizeof(color));
+		dst = clockRow - MATRIX_LANE(0, y);
+#endif
+		setClipRect((int8)left, (int8)y, (int8)(right - left + 1), 1);
+		fillRect((int8)left, (int8)y, (int8)(right - left + 1), 1, black, dst);
+		for(n = 0; n < CLOCK_DIGITS; n++)
+		{
+			if((clockShown[n] == CLOCK_NONE) || (clockRight(n) < left) || (clockX[n] > right))
+			{
+				continue;
+			}
+			if(n == 2u)
+			{
+				drawColon(clockX[n], 2, c, dst);
+			}
+			else
+			{
+				drawHex(clockShown[n], clockX[n], 2, c, dst);
+			}
+		}
+#if CANVAS_ROW_LANES
+		memcpy(&matrix[MATRIX_LANE(0, y) + first], &clockRow[first], lanes * sizeof(color));
+#endif
+	}
+	resetClipRect();
+}
+#endif
+
 
 int main()
 {	
@@ -125,6 +541,10 @@ int main()
 	black.b = 0;
 	int i = 0;
 	RGB white;
+	timebaseStart();
+	settingsStart();
+	telemetryStart();
+	hostLinkStart();
     RTC_Start();
 	PCF8583 rtc;
     uint8 I2C_Status;
@@ -138,43 +558,36 @@ int main()
 	white.b = 0;
 	
 	RGB lotsOfColors[8];
-	lotsOfColors[0].r = 1;
-	lotsOfColors[0].g = 0;
-	lotsOfColors[0].b = 0;
-	
-	lotsOfColors[1].r = 1;
-	lotsOfColors[1].g = 1;
-	lotsOfColors[1].b = 0;
-	
-	lotsOfColors[2].r = 0;
-	lotsOfColors[2].g = 0;
-	lotsOfColors[2].b = 1;
-	
-	lotsOfColors[3].r = 0;
-	lotsOfColors[3].g = 1;
-	lotsOfColors[3].b = 1;
-	
-	lotsOfColors[4].r = 1;
-	lotsOfColors[4].g = 0;
-	lotsOfColors[4].b = 1;
-	
-	lotsOfColors[5].r = 1;
-	lotsOfColors[5].g = 1;
-	lotsOfColors[5].b = 1;
-	
-	lotsOfColors[6].r = 2;
-	lotsOfColors[6].g = 1;
-	lotsOfColors[6].b = 1;
-	
-	lotsOfColors[7].r = 0;
-	lotsOfColors[7].g = 2;
-	lotsOfColors[7].b = 0;
+	uint8 settingsSeen = settingsGeneration();
+	for(i=0;i<8;i++)
+	{
+		settingsGetColor(i, &lotsOfColors[i]);
+#if LED_MATRIX_PALETTE
+		paletteSet(8 + i, lotsOfColors[i]);
+#endif
+	}
+#if COMPOSITOR_ENABLE
+	clockLayersStart(lotsOfColors);
+#elif DISPLAY_LIST_ENABLE
+	clockListStart(lotsOfColors[2]);
+#endif
 	
 	clearScreen(matrix);
 	
 	LED_Matrix_1_Start();
+	setBrightness(settingsGet(SETTING_BRIGHTNESS));
+	setColorDepth(settingsGet(SETTING_COLOR_DEPTH));
 	
+	LED_Matrix_1_WriteRows(MATRIX_SCAN_ROWS);
+#if LED_MATRIX_HW_BCM
+	/* the first ISR goes straight on to the first row of a frame */
+	bit_shift = BCM_PLANES - 1;
+	LED_Matrix_1_WriteControl(REFRESH_CONTROL);
+#else
+	/* three latches a row: planes 1, 1, 0 */
+	LED_Matrix_1_WritePlanes(3);
 	LED_Matrix_1_WriteControl(0x03);
+#endif
 
 	isr_2_StartEx(FIFO_EMPTY);
 	ADC_Start();
@@ -186,10 +599,108 @@ int main()
 	CyGlobalIntEnable;
 	int dataChange = 0;
     int trial = 0;
+    
+    mode = settingsGet(SETTING_MODE);
+    if(mode > LAST_MODE || (mode == 4 && !animValid()) || (mode == 5 && !EFFECTS_ENABLE))
+    {
+        mode = 3;
+    }
+    int lastMode = mode;
+    if(mode == 4)
+    {
+        animPlayStart();
+    }
    
 	for(;;)
     { 	
+		TELEMETRY_STAMP(loopStart);
 		CyDelay(1);
+		buttonService();
+		switch(buttonGetEvent())
+		{
+			case BUTTON_EVENT_SHORT:
+				mode = nextMode(mode);
+				break;
+			case BUTTON_EVENT_DOUBLE:
+				/* step back: the mode whose successor is the current one */
+				i = 0;
+				while(i < LAST_MODE && nextMode(i) != mode)
+				{
+					i++;
+				}
+				mode = i;
+				break;
+			case BUTTON_EVENT_LONG:
+				if(mode == 3)
+				{
+					settingsSet(SETTING_HOUR_FORMAT, !settingsGet(SETTING_HOUR_FORMAT));
+#if COMPOSITOR_ENABLE
+					clockBanner((settingsGet(SETTING_HOUR_FORMAT) == SETTINGS_HOUR_12) ? "12H" : "24H");
+#endif
+				}
+				else if(mode == 5)
+				{
+					effectNext();
+				}
+				else if(mode == 6)
+				{
+					lifeSeed();
+				}
+				else
+				{
+					/* 255, 127, 63, 31, 15, back to 255 */
+					settingsSet(SETTING_BRIGHTNESS, (settingsGet(SETTING_BRIGHTNESS) > 15) ? (settingsGet(SETTING_BRIGHTNESS) >> 1) : 255);
+				}
+				break;
+			default:
+				break;
+		}
+		if(mode != lastMode)
+		{
+			lastMode = mode;
+			settingsSet(SETTING_MODE, mode);
+			/* the outgoing mode's frame stays up while the new one draws */
+			transitionStart(TRANSITION_KIND, TRANSITION_MS, settingsGet(SETTING_BRIGHTNESS));
+			if(mode == 4)
+			{
+				animPlayStart();
+			}
+			if(mode == 6)
+			{
+				lifeSeed();
+			}
+			if(mode == 3)
+			{
+				/* the other modes draw over the whole matrix */
+				compositorRefresh();
+				dlRefresh();
+#if !COMPOSITOR_ENABLE && !DISPLAY_LIST_ENABLE
+				clockAll = 1;
+#endif
+			}
+		}
+		if(settingsGeneration() != settingsSeen)
+		{
+			settingsSeen = settingsGeneration();
+			for(i=0;i<8;i++)
+			{
+				settingsGetColor(i, &lotsOfColors[i]);
+#if LED_MATRIX_PALETTE
+				/* recolors what is on screen before the next redraw */
+				paletteSet(8 + i, lotsOfColors[i]);
+#endif
+			}
+#if COMPOSITOR_ENABLE
+			clockLayersColor(lotsOfColors);
+#elif DISPLAY_LIST_ENABLE
+			clockListColor(lotsOfColors[2]);
+#else
+			clockAll = 1;
+#endif
+			setBrightness(settingsGet(SETTING_BRIGHTNESS));
+			setColorDepth(settingsGet(SETTING_COLOR_DEPTH));
+			trial = 0;
+		}
 		if(mode == 0)
         {
     		if(dataReady == 1)
@@ -260,24 +771,58 @@ int main()
                         drawblock(i,0,lotsOfColors[i],matrix);
                         if(scaledResult[i]>2)
                         {
-                            drawFastHLine(i*4, scaledResult[i], 3,lotsOfColors[i], matrix);
+                            drawFastHLine(i*BLOCK_WIDTH, scaledResult[i], BLOCK_WIDTH - 1,lotsOfColors[i], matrix);
                         }
                         else
                         {
-                            drawFastHLine(i*4, 1, 3,lotsOfColors[i], matrix);
+                            drawFastHLine(i*BLOCK_WIDTH, 1, BLOCK_WIDTH - 1,lotsOfColors[i], matrix);
                         }
     				}
     			}
     		}
         }  
+        else if(mode==4)
+        {
+           animPlayService(matrix);
+           trial = 0;
+        }
+        else if(mode==5)
+        {
+           effectService(matrix);
+           trial = 0;
+        }
+        else if(mode==6)
+        {
+           lifeService(lotsOfColors[3], matrix);
+           trial = 0;
+        }
         else
         {
            RTC_Enable();
-           clearScreen(matrix); 
+           TELEMETRY_STAMP(i2cStart);
            I2C_Status = getTime(&rtc);
-           printTime(rtc.hour,rtc.minute,rtc.sec,lotsOfColors[2], matrix);
+           TELEMETRY_RECORD(TLM_STAT_I2C, i2cStart);
+           if(settingsGet(SETTING_HOUR_FORMAT) == SETTINGS_HOUR_12)
+           {
+               rtc.hour = bcdTo12Hour(rtc.hour);
+           }
+#if COMPOSITOR_ENABLE
+           clockLayersUpdate(&rtc);
+           compositorService(matrix);
+#elif DISPLAY_LIST_ENABLE
+           clockListUpdate(&rtc);
+           dlRender(matrix);
+#else
+           clockDraw(&rtc, lotsOfColors[2], matrix);
+#endif
            trial = 0;
         }
+		TELEMETRY_RECORD(TLM_STAT_LOOP_MODE0 + mode, loopStart);
+		ditherService(matrix);
+		transitionService();
+		scrollService();
+		hostLinkService();
+		settingsService();
 	}
 }
 
@@ -0,0 +1,63 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* What main.c, Timebase.c and the generated code provide on the target */
+
+#include <device.h>
+#include <LED_Matrix.h>
+#include "test.h"
+
+color matrix[MATRIX_BUFFER_LANES];
+volatile uint8 refreshFrames = 0;
+
+reg8 hostFifo[6];
+uint8 hostButtonPin = 1;
+uint32 hostMillis = 0;
+unsigned testFailures = 0;
+
+uint32 timebaseMillis(void)
+{
+	return hostMillis;
+}
+
+uint32 timebaseCycles(void)
+{
+	return hostMillis * 48000u;
+}
+
+uint8 CyEnterCriticalSection(void)
+{
+	return 0;
+}
+
+void CyExitCriticalSection(uint8 savedIntrStatus)
+{
+	(void)savedIntrStatus;
+}
+
+#if !LED_MATRIX_PALETTE
+RGB hostPixel(uint8 x, uint8 y)
+{
+	const color *lane = &matrix[MATRIX_LANE(x, y)];
+	uint8 i, bit = (uint8)(1u << (x % 8u));
+	RGB p = {0, 0, 0};
+
+	for(i = 0; i < BCM_PLANES; i++)
+	{
+		p.r |= (uint8)(((lane->r[i] & bit) ? 1u : 0u) << i);
+		p.g |= (uint8)(((lane->g[i] & bit) ? 1u : 0u) << i);
+		p.b |= (uint8)(((lane->b[i] & bit) ? 1u : 0u) << i);
+	}
+	return p;
+}
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,58 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* Host stand-in for the generated device.h/project.h: the Cypress types at
+ * their PSoC4 widths and the few registers and calls the modules under test
+ * touch, as plain variables and functions defined in host.c.
+ */
+#ifndef DEVICE_H
+#define DEVICE_H
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t		uint8;
+typedef uint16_t	uint16;
+typedef uint32_t	uint32;
+typedef int8_t		int8;
+typedef int16_t		int16;
+typedef int32_t		int32;
+typedef char		char8;
+typedef volatile uint8	reg8;
+typedef volatile uint32	reg32;
+typedef uint32		cystatus;
+
+#define CYRET_SUCCESS			(0x00u)
+#define CYRET_BAD_PARAM			(0x01u)
+
+#define CY_SET_REG8(addr, value)	(*(reg8 *)(addr) = (uint8)(value))
+#define CY_GET_REG8(addr)			(*(reg8 *)(addr))
+
+uint8 CyEnterCriticalSection(void);
+void CyExitCriticalSection(uint8 savedIntrStatus);
+
+/* the component's FIFOs, one byte each: what was written last */
+extern reg8 hostFifo[6];
+#define LED_Matrix_1_F0_REG_0		(hostFifo[0])
+#define LED_Matrix_1_F0_REG_1		(hostFifo[1])
+#define LED_Matrix_1_F0_REG_2		(hostFifo[2])
+#define LED_Matrix_1_F1_REG_0		(hostFifo[3])
+#define LED_Matrix_1_F1_REG_1		(hostFifo[4])
+#define LED_Matrix_1_F1_REG_2		(hostFifo[5])
+
+/* four row address outputs, so the 1/16 scan geometries build too */
+#define LED_Matrix_1_ROW_MASK		0x0Fu
+
+/* the button pin */
+extern uint8 hostButtonPin;
+#define P0_2_Read()					(hostButtonPin)
+
+#endif
+/* [] END OF FILE */
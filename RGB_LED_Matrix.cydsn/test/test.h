@@ -0,0 +1,63 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+#ifndef test_h_
+#define test_h_
+#include <stdio.h>
+#include <time.h>
+#include <device.h>
+#include <LED_Matrix.h>
+
+/* host.c: timebaseMillis() returns hostMillis, P0_2_Read() hostButtonPin */
+extern uint32 hostMillis;
+extern uint8 hostButtonPin;
+extern unsigned testFailures;
+
+#if !LED_MATRIX_PALETTE
+/* Plane values (0 - 31) of pixel x, y of 'matrix', in chain coordinates */
+RGB hostPixel(uint8 x, uint8 y);
+#endif
+
+/* Counts and reports a failed check, and carries on */
+#define CHECK(cond, ...) \
+	do { \
+		if(!(cond)) \
+		{ \
+			testFailures++; \
+			printf("%s:%d: %s: ", __FILE__, __LINE__, #cond); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+		} \
+	} while(0)
+
+/* "32x16": the geometry a test was built for */
+#define TEST_STR_(x)		#x
+#define TEST_STR(x)			TEST_STR_(x)
+#define TEST_GEOMETRY		TEST_STR(PANEL_WIDTH) "x" TEST_STR(PANEL_HEIGHT)
+
+/* main's return value, with a PASS/FAIL line for the Makefile */
+#define TEST_RESULT(name) \
+	(printf("%s: %s\n", testFailures ? "FAIL" : "PASS", name), testFailures ? 1 : 0)
+
+/* Benchmarks time on the host, in nanoseconds. They compare code paths
+ * against each other and catch regressions; the M0 figure scales with them
+ * but has to be measured on the target (timebaseCycles, telemetry).
+ */
+static inline double benchNs(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+#endif
+/* [] END OF FILE */
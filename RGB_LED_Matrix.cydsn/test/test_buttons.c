@@ -0,0 +1,213 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* buttonProcess driven with synthetic level sequences, one sample per ms,
+ * around the debounce, long press and double click thresholds.
+ */
+
+#include <device.h>
+#include "Buttons.h"
+#include "test.h"
+
+#define MAX_EVENTS		8
+
+static uint32 now = 0;
+static uint8 got[MAX_EVENTS];
+static uint32 gotTime[MAX_EVENTS];
+static uint8 gotCount;
+
+/* Holds 'level' for 'ms' samples, collecting the events as they come */
+static void hold(uint8 level, uint32 ms)
+{
+	uint8 e;
+
+	while(ms--)
+	{
+		buttonProcess(now, level);
+		while((e = buttonGetEvent()) != BUTTON_EVENT_NONE)
+		{
+			if(gotCount < MAX_EVENTS)
+			{
+				got[gotCount] = e;
+				gotTime[gotCount] = now;
+			}
+			gotCount++;
+		}
+		now++;
+	}
+}
+
+/* Released long enough for every gesture to finish, events forgotten */
+static void idle(void)
+{
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_LONG_MS + BUTTON_DOUBLE_MS);
+	gotCount = 0;
+}
+
+/* Chatter: 'n' changes 'ms' apart, ending on 'level' */
+static void bounce(uint8 level, uint8 n, uint32 ms)
+{
+	while(n--)
+	{
+		hold((uint8)((n & 1u) ? !level : level), ms);
+	}
+}
+
+/* The single event a sequence should have produced, at time 'at' */
+static void expect(const char *name, uint8 event, uint32 at)
+{
+	CHECK(gotCount == 1u, "%s: %u events", name, gotCount);
+	if(gotCount >= 1u)
+	{
+		CHECK(got[0] == event, "%s: event %u, want %u", name, got[0], event);
+		CHECK(gotTime[0] == at, "%s: at %u, want %u", name, gotTime[0], at);
+	}
+}
+
+static void expectNone(const char *name)
+{
+	CHECK(gotCount == 0u, "%s: %u events, first %u", name, gotCount, got[0]);
+}
+
+int main(void)
+{
+	uint32 t;
+
+	/* debounce: the level must still be there BUTTON_DEBOUNCE_MS after the
+	 * change, so the threshold is BUTTON_DEBOUNCE_MS + 1 samples
+	 */
+	idle();
+	hold(1, BUTTON_DEBOUNCE_MS);
+	idle();
+	expectNone("press under debounce");
+
+	/* a short press once the double click window after the debounced
+	 * release has run out
+	 */
+	idle();
+	hold(1, BUTTON_DEBOUNCE_MS + 1u);
+	t = now;
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	expect("press at debounce", BUTTON_EVENT_SHORT, t + BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS);
+
+	/* a release glitch under the debounce does not end the press */
+	idle();
+	hold(1, 100);
+	hold(0, BUTTON_DEBOUNCE_MS);
+	hold(1, 100);
+	t = now;
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	expect("release glitch", BUTTON_EVENT_SHORT, t + BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS);
+
+	/* long press: the debounced press has to last BUTTON_LONG_MS, one
+	 * sample less is a short press; the long press is reported while
+	 * held, with nothing more on release
+	 */
+	idle();
+	hold(1, BUTTON_LONG_MS);
+	t = now;
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	expect("under long threshold", BUTTON_EVENT_SHORT, t + BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS);
+
+	idle();
+	t = now;
+	hold(1, BUTTON_LONG_MS + 1u);
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	expect("long press", BUTTON_EVENT_LONG, t + BUTTON_DEBOUNCE_MS + BUTTON_LONG_MS);
+
+	idle();
+	hold(1, 5000);
+	hold(0, 1000);
+	expect("held 5 s", BUTTON_EVENT_LONG, now - 6000u + BUTTON_DEBOUNCE_MS + BUTTON_LONG_MS);
+
+	/* double click: the second press may start up to BUTTON_DOUBLE_MS after
+	 * the first release, one ms later it is two short presses
+	 */
+	idle();
+	hold(1, 100);
+	hold(0, BUTTON_DOUBLE_MS);
+	hold(1, 100);
+	t = now;
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	expect("double click at window", BUTTON_EVENT_DOUBLE, t + BUTTON_DEBOUNCE_MS);
+
+	idle();
+	hold(1, 100);
+	hold(0, BUTTON_DOUBLE_MS + 1u);
+	hold(1, 100);
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	CHECK((gotCount == 2u) && (got[0] == BUTTON_EVENT_SHORT) && (got[1] == BUTTON_EVENT_SHORT),
+		"double click past window: %u events", gotCount);
+
+	/* a long second press of a double click is still a double click */
+	idle();
+	hold(1, 100);
+	hold(0, 100);
+	hold(1, BUTTON_LONG_MS + 100u);
+	t = now;
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	expect("double click, long second press", BUTTON_EVENT_DOUBLE, t + BUTTON_DEBOUNCE_MS);
+
+	/* contact bounce on both edges, every change inside the debounce time:
+	 * one short press, timed from the last change
+	 */
+	idle();
+	bounce(1, 7, 4);
+	hold(1, 100);
+	bounce(0, 7, 4);
+	t = now - 4u;
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	expect("bounce", BUTTON_EVENT_SHORT, t + BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS);
+
+	/* a bouncing second press settling just inside the double click
+	 * window, and just outside it
+	 */
+	idle();
+	hold(1, 100);
+	hold(0, BUTTON_DOUBLE_MS - 24u);
+	bounce(1, 7, 4);
+	hold(1, 100);
+	t = now;
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	expect("bounce into double click", BUTTON_EVENT_DOUBLE, t + BUTTON_DEBOUNCE_MS);
+
+	idle();
+	hold(1, 100);
+	hold(0, BUTTON_DOUBLE_MS - 23u);
+	bounce(1, 7, 4);
+	hold(1, 100);
+	hold(0, BUTTON_DEBOUNCE_MS + BUTTON_DOUBLE_MS + 10u);
+	CHECK((gotCount == 2u) && (got[0] == BUTTON_EVENT_SHORT) && (got[1] == BUTTON_EVENT_SHORT),
+		"bounce past double click: %u events", gotCount);
+
+	/* the ISR path: the press edge is queued with its time, the release
+	 * is only seen by sampling
+	 */
+	idle();
+	hostMillis = now;
+	hostButtonPin = BUTTON_PRESSED_LEVEL;
+	buttonEdge();
+	for(t = now + 100u; hostMillis < t; hostMillis++)
+	{
+		buttonService();
+	}
+	hostButtonPin = !BUTTON_PRESSED_LEVEL;
+	for(t = now + 1000u; hostMillis < t; hostMillis++)
+	{
+		buttonService();
+	}
+	CHECK(buttonGetEvent() == BUTTON_EVENT_SHORT, "edge queue: no short press");
+	CHECK(buttonGetEvent() == BUTTON_EVENT_NONE, "edge queue: extra event");
+
+	return TEST_RESULT("buttons");
+}
+
+/* [] END OF FILE */
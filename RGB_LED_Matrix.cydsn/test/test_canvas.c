@@ -0,0 +1,222 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* Built once per chain layout (PANEL_CHAIN, CANVAS_TILES_X/Y, CANVAS_ORDER,
+ * CANVAS_SERPENTINE, CANVAS_ROTATION from the Makefile). Every pixel of the
+ * chain stream is traced back to where its panel is mounted on the canvas;
+ * drawPixel there lights it and nothing else, and what the primitives draw
+ * reads back in canvas coordinates, clipped at the canvas edge.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "test.h"
+
+#if !CANVAS_MAPPED
+#error "build with PANEL_CHAIN > 1"
+#endif
+
+#define W		CANVAS_WIDTH
+#define H		CANVAS_HEIGHT
+
+static const uint8 rotation[PANEL_CHAIN] = CANVAS_ROTATION;
+static const RGB white = {255, 255, 255};
+static const RGB black = {0, 0, 0};
+
+/* Chain stream pixel sx, sy to the canvas pixel it shows: the panel's place
+ * along the chain, its tile, then the panel turned as mounted
+ */
+static void chainToCanvas(uint8 sx, uint8 sy, uint8 *cx, uint8 *cy)
+{
+	uint8 pos = PANEL_CHAIN - 1u - sx / PANEL_WIDTH;
+	uint8 px = sx % PANEL_WIDTH, py = sy, tx, ty, lx, ly;
+
+#if CANVAS_ORDER == CANVAS_ROWS
+	ty = pos / CANVAS_TILES_X;
+	tx = pos % CANVAS_TILES_X;
+	if(CANVAS_SERPENTINE && (ty & 1u))
+	{
+		tx = CANVAS_TILES_X - 1u - tx;
+	}
+#else
+	tx = pos / CANVAS_TILES_Y;
+	ty = pos % CANVAS_TILES_Y;
+	if(CANVAS_SERPENTINE && (tx & 1u))
+	{
+		ty = CANVAS_TILES_Y - 1u - ty;
+	}
+#endif
+	/* a panel turned a quarter clockwise shows its top row down the right
+	 * hand edge of its tile
+	 */
+	switch(rotation[pos] & 3u)
+	{
+		case 1:
+			lx = PANEL_HEIGHT - 1u - py;
+			ly = px;
+			break;
+		case 2:
+			lx = PANEL_WIDTH - 1u - px;
+			ly = PANEL_HEIGHT - 1u - py;
+			break;
+		case 3:
+			lx = py;
+			ly = PANEL_WIDTH - 1u - px;
+			break;
+		default:
+			lx = px;
+			ly = py;
+			break;
+	}
+	*cx = (uint8)(tx * PANEL_WIDTH + lx);
+	*cy = (uint8)(ty * PANEL_HEIGHT + ly);
+}
+
+/* The matrix read back in canvas coordinates, red plane values */
+static uint8 shown[H][W];
+static uint8 want[H][W];
+
+static void readCanvas(void)
+{
+	uint8 sx, sy, cx, cy;
+
+	memset(shown, 0, sizeof(shown));
+	for(sy = 0; sy < MATRIX_HEIGHT; sy++)
+	{
+		for(sx = 0; sx < MATRIX_WIDTH; sx++)
+		{
+			chainToCanvas(sx, sy, &cx, &cy);
+			shown[cy][cx] = hostPixel(sx, sy).r;
+		}
+	}
+}
+
+static void wantRect(int16 x, int16 y, int16 w, int16 h, uint8 v)
+{
+	int16 i, j;
+
+	for(j = y; j < y + h; j++)
+	{
+		for(i = x; i < x + w; i++)
+		{
+			if((i >= 0) && (i < W) && (j >= 0) && (j < H))
+			{
+				want[j][i] = v;
+			}
+		}
+	}
+}
+
+static uint32 seed = 29;
+
+static int16 range(int16 lo, int16 hi)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return (int16)(lo + (int16)(seed % (uint32)(hi - lo + 1)));
+}
+
+int main(void)
+{
+	uint8 sx, sy, cx, cy, hit[H][W];
+	uint16 n, lit;
+	int16 x, y, w, h;
+
+	printf("chain of %u %ux%u panels as %ux%u tiles, %s%s, canvas %ux%u\n", PANEL_CHAIN, PANEL_WIDTH,
+		PANEL_HEIGHT, CANVAS_TILES_X, CANVAS_TILES_Y, (CANVAS_ORDER == CANVAS_ROWS) ? "rows" : "columns",
+		CANVAS_SERPENTINE ? " serpentine" : "", W, H);
+
+	/* every chain pixel shows one canvas pixel and every canvas pixel is
+	 * shown once: drawPixel there lights that chain pixel alone
+	 */
+	memset(hit, 0, sizeof(hit));
+	for(sy = 0; sy < MATRIX_HEIGHT; sy++)
+	{
+		for(sx = 0; sx < MATRIX_WIDTH; sx++)
+		{
+			chainToCanvas(sx, sy, &cx, &cy);
+			CHECK((cx < W) && (cy < H) && !hit[cy][cx], "chain %u,%u traces to canvas %u,%u twice or off it",
+				sx, sy, cx, cy);
+			if((cx >= W) || (cy >= H))
+			{
+				continue;
+			}
+			hit[cy][cx] = 1;
+			clearScreen(matrix);
+			drawPixel((int8)cx, (int8)cy, white, matrix);
+			readCanvas();
+			for(lit = 0, y = 0; y < H; y++)
+			{
+				for(x = 0; x < W; x++)
+				{
+					lit += (shown[y][x] != 0u);
+				}
+			}
+			CHECK((hostPixel(sx, sy).r == 31u) && (lit == 1u), "canvas %u,%u lights %u pixels, not chain %u,%u",
+				cx, cy, lit, sx, sy);
+			if(testFailures > 10u)
+			{
+				return TEST_RESULT("canvas");
+			}
+		}
+	}
+
+	/* rectangles and lines across the tile seams and off the canvas, and
+	 * clearPixel, read back where they were drawn
+	 */
+	clearScreen(matrix);
+	memset(want, 0, sizeof(want));
+	for(n = 0; n < 3000u; n++)
+	{
+		x = range(-8, W);
+		y = range(-8, H);
+		w = range(1, 24);
+		h = range(1, 24);
+		switch(range(0, 3))
+		{
+			case 0:
+				fillRect((int8)x, (int8)y, (int8)w, (int8)h, (n & 1u) ? white : black, matrix);
+				wantRect(x, y, w, h, (n & 1u) ? 31u : 0u);
+				break;
+			case 1:
+				drawFastHLine((int8)x, (int8)y, (int8)w, white, matrix);
+				wantRect(x, y, w + 1, 1, 31u);
+				break;
+			case 2:
+				drawFastVLine((int8)x, (int8)y, (int8)h, white, matrix);
+				wantRect(x, y, 1, h + 1, 31u);
+				break;
+			default:
+				if((x >= 0) && (y >= 0))
+				{
+					clearPixel((uint8)x, (uint8)y, matrix);
+					wantRect(x, y, 1, 1, 0u);
+				}
+				break;
+		}
+		readCanvas();
+		if(memcmp(shown, want, sizeof(want)) != 0)
+		{
+			CHECK(0, "draw %u at %d,%d %dx%d does not read back in canvas coordinates", n, x, y, w, h);
+			break;
+		}
+	}
+	fillScreen(white, matrix);
+	readCanvas();
+	memset(want, 31, sizeof(want));
+	CHECK(memcmp(shown, want, sizeof(want)) == 0, "fillScreen misses canvas pixels");
+
+	return TEST_RESULT("canvas " TEST_STR(CANVAS_TILES_X) "x" TEST_STR(CANVAS_TILES_Y) " of " TEST_GEOMETRY);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,282 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* Built with COMPOSITOR_ENABLE. compositorService against the layers stacked
+ * pixel by pixel, for random bands of 1 and 4 bpp, keyed and opaque, turned
+ * round with LAYER_ROTATE_180 or not, shown and hidden, changed a few pixels
+ * at a time; a frame with nothing marked leaves the matrix alone; then the
+ * time to recompose the whole canvas.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "Compositor.h"
+#include "test.h"
+
+#if !COMPOSITOR_ENABLE
+#error "build with -DCOMPOSITOR_ENABLE=1"
+#endif
+
+#define W		CANVAS_WIDTH
+#define H		CANVAS_HEIGHT
+
+/* What the test set up on each layer, and the value of every pixel of it */
+typedef struct
+{
+	uint8 bpp;
+	int8 top;
+	uint8 rows;
+	uint8 key;
+	uint8 flags;
+	uint8 visible;
+	RGB palette[16];
+	uint8 value[H][W];
+} Mirror;
+
+static Mirror mirror[COMPOSITOR_LAYERS];
+static uint8 pixels[COMPOSITOR_LAYERS][LAYER_BYTES(LAYER_4BPP, H)];
+static color ref[MATRIX_LANES];
+
+static uint32 seed = 31;
+
+static int16 range(int16 lo, int16 hi)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return (int16)(lo + (int16)(seed % (uint32)(hi - lo + 1)));
+}
+
+static RGB anyColor(void)
+{
+	RGB c;
+
+	c.r = (uint8)range(0, 255);
+	c.g = (uint8)range(0, 255);
+	c.b = (uint8)range(0, 255);
+	return c;
+}
+
+/* The canvas the layers make, black where none shows, drawn pixel by pixel */
+static void stackFromScratch(color *m)
+{
+	int16 x, y, r;
+	uint8 n, v;
+	const Mirror *l;
+
+	clearScreen(m);
+	for(y = 0; y < H; y++)
+	{
+		for(x = 0; x < W; x++)
+		{
+			for(n = 0; n < COMPOSITOR_LAYERS; n++)
+			{
+				l = &mirror[n];
+				r = y - l->top;
+				if(!l->visible || (r < 0) || (r >= l->rows))
+				{
+					continue;
+				}
+				/* upside down: the band's last row at its top, right to left */
+				v = (l->flags & LAYER_ROTATE_180) ? l->value[l->rows - 1 - r][W - 1 - x] : l->value[r][x];
+				if(v != l->key)
+				{
+					drawPixel((int8)x, (int8)y, l->palette[v], m);
+				}
+			}
+		}
+	}
+}
+
+/* layerInit through the mirror, with a new palette and all pixels 0 */
+static void setLayer(uint8 n, uint8 bpp, int8 top, uint8 rows, uint8 key, uint8 flags)
+{
+	Mirror *l = &mirror[n];
+	uint8 i;
+
+	l->bpp = bpp;
+	l->top = top;
+	l->rows = rows;
+	l->key = key;
+	l->flags = flags;
+	l->visible = 1;
+	for(i = 0; i < (1u << bpp); i++)
+	{
+		l->palette[i] = anyColor();
+	}
+	/* layerInit keeps what the buffer holds */
+	memset(pixels[n], 0, sizeof(pixels[n]));
+	memset(l->value, 0, sizeof(l->value));
+	layerInit(n, bpp, pixels[n], top, rows, l->palette, key, flags);
+}
+
+static void newLayer(uint8 n)
+{
+	uint8 bpp = (range(0, 1) != 0) ? LAYER_4BPP : LAYER_1BPP;
+
+	setLayer(n, bpp, (int8)range(-4, H - 1), (uint8)range(1, H),
+		(range(0, 3) == 0) ? LAYER_NO_KEY : (uint8)range(0, (1 << bpp) - 1),
+		(range(0, 1) != 0) ? LAYER_ROTATE_180 : 0u);
+}
+
+/* One random change to layer n through the layer* calls */
+static void changeLayer(uint8 n)
+{
+	Mirror *l = &mirror[n];
+	int16 x, y, w, h, i, j;
+	uint8 v = (uint8)range(0, (1 << l->bpp) - 1);
+
+	switch(range(0, 9))
+	{
+		case 0:
+			newLayer(n);
+			break;
+		case 1:
+			layerClear(n, v);
+			memset(l->value, v, sizeof(l->value));
+			break;
+		case 2:
+			l->visible = !l->visible;
+			layerShow(n, l->visible);
+			break;
+		case 3:
+			l->palette[v] = anyColor();
+			layerTouch(n);
+			break;
+		case 4:
+		case 5:
+			x = range(-4, W + 4);
+			y = range(-4, H + 4);
+			w = range(0, 12);
+			h = range(0, 6);
+			layerFillRect(n, (int8)x, (int8)y, (int8)w, (int8)h, v);
+			for(j = y; j < y + h; j++)
+			{
+				for(i = x; i < x + w; i++)
+				{
+					if((i >= 0) && (i < W) && (j >= 0) && (j < l->rows))
+					{
+						l->value[j][i] = v;
+					}
+				}
+			}
+			break;
+		default:
+			x = range(-2, W + 1);
+			y = range(-2, l->rows + 1);
+			layerPixel(n, (int8)x, (int8)y, v);
+			if((x >= 0) && (x < W) && (y >= 0) && (y < l->rows))
+			{
+				l->value[y][x] = v;
+			}
+			break;
+	}
+}
+
+/* compositorService at the start of the next refresh frame */
+static void compose(void)
+{
+	refreshFrames++;
+	compositorService(matrix);
+}
+
+int main(void)
+{
+	uint16 n, k, i;
+	uint8 keyed = 0, rotated = 0, bpp = 0;
+	double t0, t;
+
+	/* an opaque band over the whole canvas covers whatever was on the
+	 * matrix after a refresh; rows no layer covers are not the compositor's
+	 */
+	setLayer(0, LAYER_4BPP, 0, H, LAYER_NO_KEY, 0);
+	for(i = 1; i < COMPOSITOR_LAYERS; i++)
+	{
+		newLayer((uint8)i);
+	}
+	for(i = 0; i < sizeof(matrix); i++)
+	{
+		((uint8 *)matrix)[i] = (uint8)range(0, 255);
+	}
+	compositorRefresh();
+	compose();
+	stackFromScratch(ref);
+	CHECK(memcmp(matrix, ref, sizeof(ref)) == 0, "compositorRefresh left pixels of what was there");
+
+	for(n = 0; n < 5000u; n++)
+	{
+		for(k = (uint16)range(1, 4); k > 0u; k--)
+		{
+			changeLayer((uint8)range(0, COMPOSITOR_LAYERS - 1));
+		}
+		compose();
+		stackFromScratch(ref);
+		if(memcmp(matrix, ref, sizeof(ref)) != 0)
+		{
+			CHECK(0, "change %u: compositorService differs from stacking the layers pixel by pixel", n);
+			if(testFailures > 10u)
+			{
+				break;
+			}
+		}
+		/* what the random runs went through */
+		for(i = 0; i < COMPOSITOR_LAYERS; i++)
+		{
+			keyed |= mirror[i].visible && (mirror[i].key != LAYER_NO_KEY);
+			rotated |= mirror[i].visible && (mirror[i].flags & LAYER_ROTATE_180);
+			bpp |= mirror[i].visible ? mirror[i].bpp : 0u;
+		}
+	}
+	CHECK(keyed && rotated && (bpp == (LAYER_1BPP | LAYER_4BPP)), "random layers missed keyed, rotated or a depth");
+
+	/* a whole band of the key over another layer shows that layer */
+	setLayer(0, LAYER_1BPP, 0, H, LAYER_NO_KEY, 0);
+	layerClear(0, 1);
+	setLayer(1, LAYER_4BPP, 2, 5, 7, LAYER_ROTATE_180);
+	layerClear(1, 7);
+	layerShow(2, 0);
+	compose();
+	clearScreen(ref);
+	fillRect(0, 0, W, H, mirror[0].palette[1], ref);
+	CHECK(memcmp(matrix, ref, sizeof(ref)) == 0, "a band of the key hides the layer under it");
+
+	/* nothing marked: the matrix is left alone, even a pixel drawn over it */
+	drawPixel(3, 3, anyColor(), matrix);
+	memcpy(ref, matrix, sizeof(ref));
+	compose();
+	CHECK(memcmp(matrix, ref, sizeof(ref)) == 0, "a frame with nothing marked changed the matrix");
+
+	/* host figure for the whole canvas with every layer showing; the M0
+	 * figures are the TLM_STAT_LAYER0 + n telemetry stats
+	 */
+	for(i = 0; i < COMPOSITOR_LAYERS; i++)
+	{
+		newLayer((uint8)i);
+		for(k = 0; k < 40u; k++)
+		{
+			changeLayer((uint8)i);
+		}
+		layerShow((uint8)i, 1);
+	}
+	t0 = benchNs();
+	for(n = 0; n < 20000u; n++)
+	{
+		compositorRefresh();
+		compose();
+	}
+	t = (benchNs() - t0) / 20000u;
+	printf("compositorService %ux%u, %u layers: %.0f ns per full recompose\n", W, H, COMPOSITOR_LAYERS, t);
+
+	return TEST_RESULT("compositor");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,371 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* dlRender against the whole list drawn from scratch, for random lists and
+ * random changes to them; clock mode's digits against printTime; an
+ * unchanged list leaving the matrix alone; then the time per frame.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "DisplayList.h"
+#include "test.h"
+
+static color ref[MATRIX_LANES];
+
+static uint32 seed = 13;
+
+static int16 range(int16 lo, int16 hi)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return (int16)(lo + (int16)(seed % (uint32)(hi - lo + 1)));
+}
+
+static RGB anyColor(void)
+{
+	RGB c;
+
+	c.r = (uint8)range(1, 255);
+	c.g = (uint8)range(0, 255);
+	c.b = (uint8)range(0, 255);
+	return c;
+}
+
+/* What the test put on the list, to draw it again from scratch */
+typedef struct
+{
+	uint8 used;
+	uint8 type;
+	uint8 visible;
+	int8 x, y, x1, y1;
+	uint8 arg;
+	RGB c;
+} Mirror;
+
+#define T_RECT		0u
+#define T_LINE		1u
+#define T_TEXT		2u
+#define T_DIGIT		3u
+
+static Mirror mirror[DL_MAX_ITEMS];
+static const char8 *texts[3] = {"12:34", "Tue", "T.7"};
+
+static void drawFromScratch(color *m)
+{
+	uint8 n;
+
+	clearScreen(m);
+	for(n = 0; n < DL_MAX_ITEMS; n++)
+	{
+		const Mirror *it = &mirror[n];
+
+		if(!it->used || !it->visible)
+		{
+			continue;
+		}
+		switch(it->type)
+		{
+			case T_RECT:
+				fillRect(it->x, it->y, it->x1, it->y1, it->c, m);
+				break;
+			case T_LINE:
+				drawLine(it->x, it->y, it->x1, it->y1, it->c, m);
+				break;
+			case T_TEXT:
+				drawString(it->x, it->y, texts[it->arg], &font5x7, it->c, m);
+				break;
+			default:
+				if(it->arg == DL_DIGIT_COLON)
+				{
+					drawColon(it->x, it->y, it->c, m);
+				}
+				else
+				{
+					drawHex(it->arg, it->x, it->y, it->c, m);
+				}
+				break;
+		}
+	}
+}
+
+/* dlRender at the start of the next refresh frame */
+static void render(void)
+{
+	refreshFrames++;
+	dlRender(matrix);
+}
+
+static void addItem(void)
+{
+	Mirror m;
+	uint8 h;
+
+	m.used = 1;
+	m.visible = 1;
+	m.type = (uint8)range(0, 3);
+	m.x = (int8)range(-8, CANVAS_WIDTH);
+	m.y = (int8)range(-8, CANVAS_HEIGHT);
+	m.x1 = (int8)range(-8, CANVAS_WIDTH);
+	m.y1 = (int8)range(-8, CANVAS_HEIGHT);
+	m.c = anyColor();
+	switch(m.type)
+	{
+		case T_RECT:
+			m.x1 = (int8)range(0, 12);
+			m.y1 = (int8)range(0, 12);
+			h = dlRect(m.x, m.y, m.x1, m.y1, m.c);
+			break;
+		case T_LINE:
+			h = dlLine(m.x, m.y, m.x1, m.y1, m.c);
+			break;
+		case T_TEXT:
+			m.arg = (uint8)range(0, 2);
+			h = dlText(m.x, m.y, texts[m.arg], &font5x7, m.c);
+			break;
+		default:
+			m.arg = (uint8)range(0, DL_DIGIT_COLON);
+			h = dlDigit(m.x, m.y, m.arg, m.c);
+			break;
+	}
+	if(h != DL_NO_HANDLE)
+	{
+		mirror[h] = m;
+	}
+}
+
+/* One random change to a random item through the dl* calls */
+static void changeItem(void)
+{
+	uint8 h = (uint8)range(0, DL_MAX_ITEMS - 1);
+	Mirror *m = &mirror[h];
+	int8 x, y;
+
+	if(!m->used)
+	{
+		addItem();
+		return;
+	}
+	switch(range(0, 4))
+	{
+		case 0:
+			dlRemove(h);
+			m->used = 0;
+			break;
+		case 1:
+			m->visible = !m->visible;
+			dlShow(h, m->visible);
+			break;
+		case 2:
+			x = (int8)range(-8, CANVAS_WIDTH);
+			y = (int8)range(-8, CANVAS_HEIGHT);
+			if(m->type == T_LINE)
+			{
+				m->x1 += x - m->x;
+				m->y1 += y - m->y;
+			}
+			m->x = x;
+			m->y = y;
+			dlMove(h, x, y);
+			break;
+		case 3:
+			m->c = anyColor();
+			dlSetColor(h, m->c);
+			break;
+		default:
+			if(m->type == T_RECT)
+			{
+				m->x1 = (int8)range(0, 12);
+				m->y1 = (int8)range(0, 12);
+				dlSetSize(h, m->x1, m->y1);
+			}
+			else if(m->type == T_LINE)
+			{
+				m->x1 = (int8)range(-8, CANVAS_WIDTH);
+				m->y1 = (int8)range(-8, CANVAS_HEIGHT);
+				dlSetEnd(h, m->x1, m->y1);
+			}
+			else if(m->type == T_TEXT)
+			{
+				m->arg = (uint8)range(0, 2);
+				dlSetText(h, texts[m->arg]);
+			}
+			else
+			{
+				m->arg = (uint8)range(0, DL_DIGIT_COLON);
+				dlSetDigit(h, m->arg);
+			}
+			break;
+	}
+}
+
+static void clearList(void)
+{
+	uint8 n;
+
+	for(n = 0; n < DL_MAX_ITEMS; n++)
+	{
+		dlRemove(n);
+		mirror[n].used = 0;
+	}
+	render();
+}
+
+/* Clock mode's list, as main.c builds and updates it */
+static uint8 clockItems[5];
+
+static void clockStart(RGB c)
+{
+	clockItems[0] = dlDigit(24, 2, 1, c);
+	clockItems[1] = dlDigit(18, 2, 0, c);
+	clockItems[2] = dlDigit(15, 2, DL_DIGIT_COLON, c);
+	clockItems[3] = dlDigit(7, 2, 0, c);
+	clockItems[4] = dlDigit(1, 2, 0, c);
+}
+
+static void clockUpdate(uint8 hour, uint8 minute, uint8 sec)
+{
+	dlShow(clockItems[0], (hour >> 4) != 0);
+	dlSetDigit(clockItems[1], hour & 0x0F);
+	dlShow(clockItems[2], (sec % 2) == 0);
+	dlSetDigit(clockItems[3], minute >> 4);
+	dlSetDigit(clockItems[4], minute & 0x0F);
+}
+
+static uint8 toBcd(uint8 v)
+{
+	return (uint8)(((v / 10u) << 4) | (v % 10u));
+}
+
+int main(void)
+{
+	static const RGB green = {0, 255, 0};
+	uint16 n, k, steps;
+	uint8 hour, minute, sec;
+	double t0, idle, tick, scratch;
+
+	/* random lists changed a few items at a time */
+	for(n = 0; n < 2000u; n++)
+	{
+		steps = (uint16)range(1, 4);
+		for(k = 0; k < steps; k++)
+		{
+			changeItem();
+		}
+		render();
+		drawFromScratch(ref);
+		CHECK(memcmp(matrix, ref, sizeof(ref)) == 0, "change %u: dlRender differs from drawing the list again", n);
+		if(testFailures > 10u)
+		{
+			break;
+		}
+	}
+	clearList();
+
+	/* nothing changed: the matrix is left alone, even a pixel drawn over it */
+	addItem();
+	render();
+	drawPixel(3, 3, green, matrix);
+	memcpy(ref, matrix, sizeof(ref));
+	render();
+	CHECK(memcmp(matrix, ref, sizeof(ref)) == 0, "unchanged list redrew the matrix");
+
+	/* and nothing happens twice in one refresh frame */
+	changeItem();
+	dlRender(matrix);
+	CHECK(memcmp(matrix, ref, sizeof(ref)) == 0, "rendered without a new refresh frame");
+	clearList();
+
+	/* a change redraws its own columns only: a pixel drawn over the matrix
+	 * on the same rows but clear of them stays
+	 */
+	clearScreen(matrix);
+	k = dlRect(2, 4, 3, 3, green);
+	render();
+	drawPixel(CANVAS_WIDTH - 2, 5, green, matrix);
+	dlMove((uint8)k, 3, 4);
+	render();
+	clearScreen(ref);
+	fillRect(3, 4, 3, 3, green, ref);
+	drawPixel(CANVAS_WIDTH - 2, 5, green, ref);
+	CHECK(memcmp(matrix, ref, sizeof(ref)) == 0, "moving a rect redrew columns it never covered");
+
+	/* handles off the list change nothing */
+	memcpy(ref, matrix, sizeof(ref));
+	for(n = DL_MAX_ITEMS; n <= DL_NO_HANDLE; n++)
+	{
+		dlRemove((uint8)n);
+		dlShow((uint8)n, 0);
+		dlMove((uint8)n, 0, 0);
+		dlSetColor((uint8)n, anyColor());
+		dlSetSize((uint8)n, 5, 5);
+		dlSetEnd((uint8)n, 9, 9);
+		dlSetText((uint8)n, texts[0]);
+		dlSetGlyph((uint8)n, 'A');
+		dlSetDigit((uint8)n, 7);
+	}
+	render();
+	CHECK(memcmp(matrix, ref, sizeof(ref)) == 0, "a handle past DL_MAX_ITEMS changed the matrix");
+	clearList();
+	clearScreen(matrix);
+
+	/* clock mode shows what printTime draws, through every minute in 12 and
+	 * 24 hour form and both colon phases
+	 */
+	clockStart(green);
+	for(n = 0; n < 24u * 60u * 2u; n++)
+	{
+		hour = toBcd((uint8)(n / 120u));
+		minute = toBcd((uint8)(n / 2u % 60u));
+		sec = (uint8)(n & 1u);
+		clockUpdate(hour, minute, sec);
+		render();
+		clearScreen(ref);
+		printTime(hour, minute, sec, green, ref);
+		CHECK(memcmp(matrix, ref, sizeof(ref)) == 0, "clock at %02x:%02x:%02x differs from printTime", hour, minute, sec);
+		if(testFailures > 10u)
+		{
+			break;
+		}
+	}
+
+	/* host figures per frame, the M0 ones from TLM_COUNT_DL_DRAWN and
+	 * TLM_COUNT_DL_SKIPPED against the loop time
+	 */
+	t0 = benchNs();
+	for(n = 0; n < 50000u; n++)
+	{
+		render();
+	}
+	idle = (benchNs() - t0) / 50000u;
+	t0 = benchNs();
+	for(n = 0; n < 50000u; n++)
+	{
+		clockUpdate(0x12, 0x34, (uint8)n);
+		render();
+	}
+	tick = (benchNs() - t0) / 50000u;
+	t0 = benchNs();
+	for(n = 0; n < 50000u; n++)
+	{
+		clearScreen(ref);
+		printTime(0x12, 0x34, (uint8)n, green, ref);
+	}
+	scratch = (benchNs() - t0) / 50000u;
+	printf("clock: %.0f ns/frame unchanged, %.0f ns/frame colon blinking, %.0f ns clearScreen + printTime\n",
+		idle, tick, scratch);
+
+	return TEST_RESULT("displaylist");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,125 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* Built with LED_MATRIX_DITHER. The panel shows 'matrix' as it stands
+ * between ditherService calls, one refresh frame each: averaged over the
+ * 4-frame pattern every pixel shows its full quarter-step value, the planes
+ * never move by more than one step, and a flat area lights the same number
+ * of extra steps in every frame.
+ */
+
+#include <math.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "test.h"
+
+#if !LED_MATRIX_DITHER
+#error "build with -DLED_MATRIX_DITHER=1"
+#endif
+
+/* drawPixel's gamma table: round(124 * (v / 255) ^ 2.2) */
+static uint8 quarters(uint8 v)
+{
+	return (uint8)floor(124.0 * pow(v / 255.0, 2.2) + 0.5);
+}
+
+/* One refresh frame: the ISR wraps, the main loop services the dither */
+static void frame(void)
+{
+	refreshFrames++;
+	ditherService(matrix);
+}
+
+int main(void)
+{
+	RGB c = {0, 0, 0}, p;
+	uint16 v, sum[3], x, y, lit;
+	uint8 start, f, q, lo, n;
+	double t0, ns;
+
+	/* every value, drawn in every phase of the pattern */
+	for(start = 0; start < 4u; start++)
+	{
+		for(v = 0; v < 256u; v++)
+		{
+			c.r = (uint8)v;
+			c.g = (uint8)(255u - v);
+			c.b = (uint8)(v ^ 0x55u);
+			x = (uint8)(v % MATRIX_WIDTH);
+			y = (uint8)((v / MATRIX_WIDTH) % MATRIX_HEIGHT);
+			drawPixel((int8)x, (int8)y, c, matrix);
+			sum[0] = sum[1] = sum[2] = 0;
+			for(f = 0; f < 4u; f++)
+			{
+				p = hostPixel((uint8)x, (uint8)y);
+				sum[0] += p.r;
+				sum[1] += p.g;
+				sum[2] += p.b;
+				q = quarters(c.r);
+				CHECK((p.r == (q >> 2)) || (p.r == (q >> 2) + 1u), "red %u frame %u: %u", v, f, p.r);
+				frame();
+			}
+			CHECK(sum[0] == quarters(c.r), "red %u from phase %u averages %u/4, want %u/4", v, start, sum[0], quarters(c.r));
+			CHECK(sum[1] == quarters(c.g), "green %u from phase %u averages %u/4, want %u/4", c.g, start, sum[1], quarters(c.g));
+			CHECK(sum[2] == quarters(c.b), "blue %u from phase %u averages %u/4, want %u/4", c.b, start, sum[2], quarters(c.b));
+		}
+		frame();
+	}
+
+	/* flat fills: the extra steps move around the 2x2 tiles, so every
+	 * frame lights the same number of them and the area does not pulse
+	 */
+	for(v = 1; v < 256u; v += 7u)
+	{
+		c.r = c.g = c.b = (uint8)v;
+		fillScreen(c, matrix);
+		q = quarters((uint8)v);
+		lo = q >> 2;
+		for(f = 0; f < 4u; f++)
+		{
+			for(y = 0, lit = 0; y < MATRIX_HEIGHT; y++)
+			{
+				for(x = 0; x < MATRIX_WIDTH; x++)
+				{
+					n = hostPixel((uint8)x, (uint8)y).g;
+					CHECK((n == lo) || (n == lo + 1u), "fill %u: %u at %u,%u", v, n, x, y);
+					lit += (n > lo);
+				}
+			}
+			CHECK(lit == (q & 3u) * (MATRIX_WIDTH * MATRIX_HEIGHT / 4u),
+				"fill %u frame %u: %u pixels a step up", v, f, lit);
+			frame();
+		}
+	}
+
+	/* CPU cost per frame with every pixel changing */
+	for(y = 0; y < MATRIX_HEIGHT; y++)
+	{
+		for(x = 0; x < MATRIX_WIDTH; x++)
+		{
+			c.r = (uint8)(x * 8u + 1u);
+			c.g = (uint8)(y * 16u + 2u);
+			c.b = (uint8)(x * y + 3u);
+			drawPixel((int8)x, (int8)y, c, matrix);
+		}
+	}
+	t0 = benchNs();
+	for(v = 0; v < 10000u; v++)
+	{
+		frame();
+	}
+	ns = (benchNs() - t0) / 10000.0;
+	printf("ditherService: %.0f ns per frame (host), %u lanes\n", ns, MATRIX_LANES);
+
+	return TEST_RESULT("dither");
+}
+
+/* [] END OF FILE */
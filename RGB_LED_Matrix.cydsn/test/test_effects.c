@@ -0,0 +1,205 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* effectService: the frame rate limit, whole frames drawn over whatever was
+ * there, selection, motion that stays smooth across the 16-bit wrap of the
+ * time, the fire fading upwards and a starfield that keeps flying; then the
+ * time per frame of each effect.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "Effects.h"
+#include "test.h"
+
+static const char *names[EFFECT_COUNT] = {"plasma", "fire", "starfield"};
+
+static color frame[MATRIX_LANES];
+
+/* The frame effect n shows at time t, into 'matrix' */
+static void render(uint8 n, uint32 t)
+{
+	effectSelect(n);
+	hostMillis = t;
+	effectService(matrix);
+}
+
+/* Change of the plane values, summed over the pixels, from 'frame' to 'matrix' */
+static uint32 frameStep(void)
+{
+	color now[MATRIX_LANES];
+	uint8 x, y;
+	uint32 step = 0;
+	RGB a, b;
+
+	memcpy(now, matrix, sizeof(now));
+	for(y = 0; y < MATRIX_HEIGHT; y++)
+	{
+		for(x = 0; x < MATRIX_WIDTH; x++)
+		{
+			memcpy(matrix, frame, sizeof(frame));
+			a = hostPixel(x, y);
+			memcpy(matrix, now, sizeof(now));
+			b = hostPixel(x, y);
+			step += (uint32)(abs(a.r - b.r) + abs(a.g - b.g) + abs(a.b - b.b));
+		}
+	}
+	return step;
+}
+
+/* Sum of the plane values of canvas row y */
+static uint16 rowLevel(uint8 y)
+{
+	uint16 sum = 0;
+	uint8 x;
+	RGB p;
+
+	for(x = 0; x < CANVAS_WIDTH; x++)
+	{
+		p = hostPixel(x, y);
+		sum += p.r + p.g + p.b;
+	}
+	return sum;
+}
+
+int main(void)
+{
+	uint8 n, x, y, lit, grey, lastLit = 0;
+	uint16 i;
+	uint32 t, d, step, wrapStep, levels[CANVAS_HEIGHT];
+	double t0;
+
+	for(n = 0; n < EFFECT_COUNT; n++)
+	{
+		/* no new frame before EFFECT_FRAME_MS, a whole one after */
+		render(n, 100000u);
+		clearScreen(matrix);
+		render(n, 100000u + EFFECT_FRAME_MS - 1u);
+		memset(frame, 0, sizeof(frame));
+		CHECK(memcmp(matrix, frame, sizeof(frame)) == 0, "%s drew before EFFECT_FRAME_MS", names[n]);
+
+		/* the frame does not depend on what was on the matrix */
+		render(n, 200000u);
+		memcpy(frame, matrix, sizeof(frame));
+		for(i = 0; i < sizeof(frame); i++)
+		{
+			((uint8 *)matrix)[i] = (uint8)rand();
+		}
+		render(n, 200000u + 65536u);
+		if(n != EFFECT_STARFIELD)
+		{
+			CHECK(memcmp(matrix, frame, sizeof(frame)) == 0, "%s leaves pixels of the old frame", names[n]);
+		}
+	}
+
+	/* plasma and fire: the change between frames EFFECT_FRAME_MS apart is
+	 * no bigger across the wrap of the 16-bit time than anywhere else, and
+	 * there is motion
+	 */
+	for(n = EFFECT_PLASMA; n <= EFFECT_FIRE; n++)
+	{
+		for(t = 1000u, step = 0; t < 60000u; t += 997u)
+		{
+			render(n, t);
+			memcpy(frame, matrix, sizeof(frame));
+			render(n, t + EFFECT_FRAME_MS);
+			d = frameStep();
+			step = (d > step) ? d : step;
+		}
+		CHECK(step > 0u, "%s does not move", names[n]);
+		for(t = 65536u - 3u * EFFECT_FRAME_MS, wrapStep = 0; t < 65536u + 3u * EFFECT_FRAME_MS; t += EFFECT_FRAME_MS)
+		{
+			render(n, t);
+			memcpy(frame, matrix, sizeof(frame));
+			render(n, t + EFFECT_FRAME_MS);
+			d = frameStep();
+			wrapStep = (d > wrapStep) ? d : wrapStep;
+		}
+		CHECK(wrapStep <= step, "%s jumps by %u across the time wrap, at most %u elsewhere", names[n], wrapStep, step);
+	}
+
+	/* fire: the base at row 0 burns brightest, the flames fade upwards and
+	 * the top row is dark
+	 */
+	memset(levels, 0, sizeof(levels));
+	for(t = 0; t < 20000u; t += 97u)
+	{
+		render(EFFECT_FIRE, t);
+		for(y = 0; y < CANVAS_HEIGHT; y++)
+		{
+			levels[y] += rowLevel(y);
+		}
+		CHECK(rowLevel(CANVAS_HEIGHT - 1u) == 0u, "fire: top row lit at %u ms", t);
+	}
+	for(y = 1; y < CANVAS_HEIGHT; y++)
+	{
+		CHECK(levels[y] <= levels[y - 1u], "fire: row %u brighter than row %u", y, y - 1u);
+	}
+	CHECK(levels[0] > 0u, "fire: no flames");
+
+	/* starfield: grey stars, never all gone, also after long pauses */
+	for(t = 0, i = 0; i < 3000u; i++)
+	{
+		t += (i % 500u == 499u) ? 60000u : EFFECT_FRAME_MS;
+		render(EFFECT_STARFIELD, t);
+		for(y = 0, lit = 0, grey = 1; y < CANVAS_HEIGHT; y++)
+		{
+			for(x = 0; x < CANVAS_WIDTH; x++)
+			{
+				RGB p = hostPixel(x, y);
+
+				lit += (p.r | p.g | p.b) != 0u;
+				grey &= (p.r == p.g) && (p.g == p.b);
+			}
+		}
+		CHECK(grey, "starfield: coloured star at frame %u", i);
+		CHECK((i < 50u) || lit || lastLit, "starfield: empty for two frames at frame %u", i);
+		lastLit = lit;
+	}
+
+	/* effectNext runs through all of them and back to the plasma, a bad
+	 * number selects the plasma
+	 */
+	render(EFFECT_PLASMA, 300000u);
+	memcpy(frame, matrix, sizeof(frame));
+	effectSelect(EFFECT_PLASMA);
+	for(n = 0; n < EFFECT_COUNT; n++)
+	{
+		effectNext();
+	}
+	hostMillis = 300000u + 65536u;
+	effectService(matrix);
+	CHECK(memcmp(matrix, frame, sizeof(frame)) == 0, "effectNext does not come back to the plasma");
+	render(EFFECT_COUNT, 300000u + 2u * 65536u);
+	CHECK(memcmp(matrix, frame, sizeof(frame)) == 0, "effectSelect(EFFECT_COUNT) is not the plasma");
+
+	/* host figures, the M0 cycles per frame come from the TLM_STAT_EFFECT
+	 * telemetry stat
+	 */
+	for(n = 0; n < EFFECT_COUNT; n++)
+	{
+		effectSelect(n);
+		t0 = benchNs();
+		for(t = 0; t < 20000u; t++)
+		{
+			hostMillis = t * EFFECT_FRAME_MS;
+			effectService(matrix);
+		}
+		t0 = (benchNs() - t0) / 20000u;
+		printf("%-9s %6.0f ns/frame, %5.1f ns/pixel\n", names[n], t0, t0 / (CANVAS_WIDTH * CANVAS_HEIGHT));
+	}
+
+	return TEST_RESULT("effects");
+}
+
+/* [] END OF FILE */
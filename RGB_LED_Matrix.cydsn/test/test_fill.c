@@ -0,0 +1,338 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* fillCircle, fillRoundRect and fillTriangle against drawPixel loops that
+ * fill the same shapes the slow way, for random shapes and clip rectangles,
+ * then the time per shape of both. drawLine under a clip rectangle lights
+ * the pixels of the whole line that fall inside it.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "test.h"
+
+static color fb[MATRIX_LANES];
+static color ref[MATRIX_LANES];
+static color outline[MATRIX_LANES];
+
+static uint32 seed = 11;
+
+static int16 range(int16 lo, int16 hi)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return (int16)(lo + (int16)(seed % (uint32)(hi - lo + 1)));
+}
+
+static int8 clipX, clipY, clipW, clipH;
+
+static void clip(void)
+{
+	setClipRect(clipX, clipY, clipW, clipH);
+}
+
+static uint8 outlineLit(int16 x, int16 y)
+{
+	return (outline[MATRIX_LANE(x, y)].r[BCM_PLANES - 1] >> (x % 8)) & 1u;
+}
+
+static void pixelSpan(int16 x0, int16 x1, int16 y, RGB c, color *m)
+{
+	for(; x0 <= x1; x0++)
+	{
+		if((x0 >= -128) && (x0 <= 127) && (y >= -128) && (y <= 127))
+		{
+			drawPixel((int8)x0, (int8)y, c, m);
+		}
+	}
+}
+
+/* A disc the slow way: drawCircle's outline on a scratch canvas, then every
+ * row filled between its outermost outline pixels under the test's clip
+ * rectangle. The canvas is big enough for every radius drawn here.
+ */
+static void refDisc(int16 x0, int16 y0, int16 r, RGB c, color *m)
+{
+	static const RGB white = {255, 255, 255};
+	int16 x, y, l, rt;
+
+	memset(outline, 0, sizeof(outline));
+	resetClipRect();
+	drawCircle((int8)(MATRIX_WIDTH / 2), (int8)(MATRIX_HEIGHT / 2), (int8)r, white, outline);
+	clip();
+	for(y = 0; y < MATRIX_HEIGHT; y++)
+	{
+		for(x = 0, l = MATRIX_WIDTH, rt = -1; x < MATRIX_WIDTH; x++)
+		{
+			if(outlineLit(x, y))
+			{
+				l = (x < l) ? x : l;
+				rt = x;
+			}
+		}
+		if(rt >= 0)
+		{
+			pixelSpan(x0 + l - MATRIX_WIDTH / 2, x0 + rt - MATRIX_WIDTH / 2, y0 + y - MATRIX_HEIGHT / 2, c, m);
+		}
+	}
+}
+
+static void refRoundRect(int16 x, int16 y, int16 w, int16 h, int16 r, RGB c, color *m)
+{
+	int16 limit = (((w < h) ? w : h) - 1) / 2, j;
+
+	if((w <= 0) || (h <= 0))
+	{
+		return;
+	}
+	r = (r > limit) ? limit : ((r < 0) ? 0 : r);
+	for(j = 0; j < h; j++)
+	{
+		if((j >= r) && (j < h - r))
+		{
+			pixelSpan(x, x + w - 1, y + j, c, m);
+		}
+		else
+		{
+			pixelSpan(x + r, x + w - 1 - r, y + j, c, m);
+		}
+	}
+	refDisc(x + r, y + r, r, c, m);
+	refDisc(x + w - 1 - r, y + r, r, c, m);
+	refDisc(x + r, y + h - 1 - r, r, c, m);
+	refDisc(x + w - 1 - r, y + h - 1 - r, r, c, m);
+}
+
+/* x of the edge from (x0, y0) to (x1, y1) at row y, rounded down */
+static int16 edgeX(int16 x0, int16 y0, int16 x1, int16 y1, int16 y)
+{
+	int16 dx = x1 - x0, dy = y1 - y0, t = y - y0;
+	int16 q = (int16)(dx * t / dy);
+
+	if(((dx * t) % dy != 0) && ((dx * t < 0) != (dy < 0)))
+	{
+		q--;
+	}
+	return x0 + q;
+}
+
+/* A triangle the slow way: per row, both edges by division, one pixel at
+ * a time between them
+ */
+static void refTriangle(int16 ax, int16 ay, int16 bx, int16 by, int16 cx, int16 cy, RGB c, color *m)
+{
+	int16 t, y, xm, xn;
+
+	if(ay > by) { t = ax; ax = bx; bx = t; t = ay; ay = by; by = t; }
+	if(by > cy) { t = bx; bx = cx; cx = t; t = by; by = cy; cy = t; }
+	if(ay > by) { t = ax; ax = bx; bx = t; t = ay; ay = by; by = t; }
+
+	if(ay == cy)
+	{
+		xm = (ax < bx) ? ax : bx;
+		xm = (cx < xm) ? cx : xm;
+		xn = (ax > bx) ? ax : bx;
+		xn = (cx > xn) ? cx : xn;
+		pixelSpan(xm, xn, ay, c, m);
+		return;
+	}
+	for(y = ay; y <= cy; y++)
+	{
+		xm = edgeX(ax, ay, cx, cy, y);
+		if((y < by) || (by == cy))
+		{
+			xn = (by == ay) ? ax : edgeX(ax, ay, bx, by, y);
+		}
+		else
+		{
+			xn = edgeX(bx, by, cx, cy, y);
+		}
+		if(xm < xn)
+		{
+			pixelSpan(xm, xn, y, c, m);
+		}
+		else
+		{
+			pixelSpan(xn, xm, y, c, m);
+		}
+	}
+}
+
+/* The line drawn whole on a scratch canvas, then its pixels through
+ * drawPixel under the test's clip rectangle
+ */
+static void refLine(int16 x0, int16 y0, int16 x1, int16 y1, RGB c, color *m)
+{
+	static const RGB white = {255, 255, 255};
+	int16 x, y;
+
+	memset(outline, 0, sizeof(outline));
+	resetClipRect();
+	drawLine((int8)x0, (int8)y0, (int8)x1, (int8)y1, white, outline);
+	clip();
+	for(y = 0; y < MATRIX_HEIGHT; y++)
+	{
+		for(x = 0; x < MATRIX_WIDTH; x++)
+		{
+			if(outlineLit(x, y))
+			{
+				drawPixel((int8)x, (int8)y, c, m);
+			}
+		}
+	}
+}
+
+/* What a first attempt with drawPixel would do, for the benchmark */
+static void naiveDisc(int16 x0, int16 y0, int16 r, RGB c, color *m)
+{
+	int16 dx, dy;
+
+	for(dy = -r; dy <= r; dy++)
+	{
+		for(dx = -r; dx <= r; dx++)
+		{
+			if(dx * dx + dy * dy <= r * r + r)
+			{
+				drawPixel((int8)(x0 + dx), (int8)(y0 + dy), c, m);
+			}
+		}
+	}
+}
+
+static void naiveRoundRect(int16 x, int16 y, int16 w, int16 h, int16 r, RGB c, color *m)
+{
+	int16 i, j, dx, dy;
+
+	for(j = 0; j < h; j++)
+	{
+		for(i = 0; i < w; i++)
+		{
+			dx = (i < r) ? r - i : ((i > w - 1 - r) ? i - (w - 1 - r) : 0);
+			dy = (j < r) ? r - j : ((j > h - 1 - r) ? j - (h - 1 - r) : 0);
+			if(dx * dx + dy * dy <= r * r + r)
+			{
+				drawPixel((int8)(x + i), (int8)(y + j), c, m);
+			}
+		}
+	}
+}
+
+static uint8 same(void)
+{
+	return memcmp(fb, ref, sizeof(fb)) == 0;
+}
+
+/* Host time of one call of each, fast and slow */
+#define TIME(label, reps, fast, slow) \
+	do { \
+		uint32 n_; \
+		double t0_, tf_, ts_; \
+		t0_ = benchNs(); \
+		for(n_ = 0; n_ < (reps); n_++) { fast; } \
+		tf_ = (benchNs() - t0_) / (reps); \
+		t0_ = benchNs(); \
+		for(n_ = 0; n_ < (reps); n_++) { slow; } \
+		ts_ = (benchNs() - t0_) / (reps); \
+		printf("%-26s %7.0f ns spans, %7.0f ns drawPixel loop, %4.1fx\n", label, tf_, ts_, ts_ / tf_); \
+	} while(0)
+
+int main(void)
+{
+	RGB c;
+	uint16 n;
+	int16 x[3], y[3], r, w, h;
+
+	for(n = 0; n < 20000u; n++)
+	{
+		c.r = (uint8)range(1, 255);
+		c.g = (uint8)range(0, 255);
+		c.b = (uint8)range(0, 255);
+		if(n & 1u)
+		{
+			clipX = (int8)range(-4, MATRIX_WIDTH);
+			clipY = (int8)range(-4, MATRIX_HEIGHT);
+			clipW = (int8)range(0, MATRIX_WIDTH);
+			clipH = (int8)range(0, MATRIX_HEIGHT);
+		}
+		else
+		{
+			clipX = 0;
+			clipY = 0;
+			clipW = MATRIX_WIDTH;
+			clipH = MATRIX_HEIGHT;
+		}
+		x[0] = range(-10, MATRIX_WIDTH + 10);
+		y[0] = range(-10, MATRIX_HEIGHT + 10);
+		x[1] = range(-10, MATRIX_WIDTH + 10);
+		y[1] = range(-10, MATRIX_HEIGHT + 10);
+		x[2] = range(-10, MATRIX_WIDTH + 10);
+		y[2] = range(-10, MATRIX_HEIGHT + 10);
+		r = range(0, MATRIX_HEIGHT / 2 - 1);
+		w = range(-2, MATRIX_WIDTH);
+		h = range(-2, MATRIX_HEIGHT);
+
+		memset(fb, 0, sizeof(fb));
+		memset(ref, 0, sizeof(ref));
+		clip();
+		fillCircle((int8)x[0], (int8)y[0], (int8)r, c, fb);
+		refDisc(x[0], y[0], r, c, ref);
+		CHECK(same(), "fillCircle(%d, %d, %d) clipped to %d,%d %dx%d", x[0], y[0], r, clipX, clipY, clipW, clipH);
+
+		memset(fb, 0, sizeof(fb));
+		memset(ref, 0, sizeof(ref));
+		clip();
+		fillRoundRect((int8)x[0], (int8)y[0], (int8)w, (int8)h, (int8)r, c, fb);
+		refRoundRect(x[0], y[0], w, h, r, c, ref);
+		CHECK(same(), "fillRoundRect(%d, %d, %d, %d, %d) clipped to %d,%d %dx%d", x[0], y[0], w, h, r,
+			clipX, clipY, clipW, clipH);
+
+		memset(fb, 0, sizeof(fb));
+		memset(ref, 0, sizeof(ref));
+		clip();
+		fillTriangle((int8)x[0], (int8)y[0], (int8)x[1], (int8)y[1], (int8)x[2], (int8)y[2], c, fb);
+		refTriangle(x[0], y[0], x[1], y[1], x[2], y[2], c, ref);
+		CHECK(same(), "fillTriangle(%d, %d, %d, %d, %d, %d) clipped to %d,%d %dx%d", x[0], y[0], x[1], y[1],
+			x[2], y[2], clipX, clipY, clipW, clipH);
+
+		memset(fb, 0, sizeof(fb));
+		memset(ref, 0, sizeof(ref));
+		clip();
+		drawLine((int8)x[0], (int8)y[0], (int8)x[1], (int8)y[1], c, fb);
+		refLine(x[0], y[0], x[1], y[1], c, ref);
+		CHECK(same(), "drawLine(%d, %d, %d, %d) clipped to %d,%d %dx%d", x[0], y[0], x[1], y[1],
+			clipX, clipY, clipW, clipH);
+		if(testFailures > 10u)
+		{
+			break;
+		}
+	}
+	resetClipRect();
+
+	/* host figures: the ratio is what carries over to the M0 */
+	clipX = 0;
+	clipY = 0;
+	clipW = MATRIX_WIDTH;
+	clipH = MATRIX_HEIGHT;
+	c.r = 255;
+	c.g = 128;
+	c.b = 0;
+	TIME("fillCircle r=7", 20000u, fillCircle(16, 8, 7, c, fb), naiveDisc(16, 8, 7, c, ref));
+	TIME("fillRoundRect 28x14 r=4", 20000u, fillRoundRect(2, 1, 28, 14, 4, c, fb),
+		naiveRoundRect(2, 1, 28, 14, 4, c, ref));
+	TIME("fillTriangle 30x15", 20000u, fillTriangle(1, 0, 30, 7, 10, 15, c, fb),
+		refTriangle(1, 0, 30, 7, 10, 15, c, ref));
+
+	return TEST_RESULT("fill");
+}
+
+/* [] END OF FILE */
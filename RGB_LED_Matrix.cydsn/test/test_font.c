@@ -0,0 +1,183 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* The font tables, drawString against its glyph bitmaps and measureString,
+ * then the time per character.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "Font.h"
+#include "test.h"
+
+static const RGB white = {255, 255, 255};
+
+static uint8 lit(uint8 x, uint8 y)
+{
+	return hostPixel(x, y).g != 0u;
+}
+
+/* Widths within limits, no bits right of the width, and every glyph but
+ * the space cropped to its ink on both sides
+ */
+static void checkTables(const char *name, const Font *f)
+{
+	Sprite g;
+	uint8 ch, j, ink;
+
+	for(ch = f->first; ch <= f->last; ch++)
+	{
+		fontGlyph(f, (char8)ch, &g);
+		CHECK((g.width >= 1u) && (g.width <= FONT_MAX_GLYPH_WIDTH), "%s '%c' is %u wide", name, ch, g.width);
+		CHECK(g.height == f->height, "%s '%c' is %u high", name, ch, g.height);
+		for(j = 0, ink = 0; j < g.height; j++)
+		{
+			CHECK((g.data[j] >> g.width) == 0u, "%s '%c' row %u has bits past its width", name, ch, j);
+			ink |= g.data[j];
+		}
+		if(ch != ' ')
+		{
+			CHECK((ink & 1u) && (ink & (1u << (g.width - 1u))), "%s '%c' is not cropped to its ink", name, ch);
+		}
+	}
+	fontGlyph(f, (char8)0x7F, &g);
+	CHECK(g.data == f->bitmap + ('?' - f->first) * f->height, "%s: DEL does not draw '?'", name);
+}
+
+/* drawString at (x, y) of one glyph must light exactly its bitmap */
+static void checkGlyphs(const char *name, const Font *f)
+{
+	Sprite g;
+	char8 s[2] = {0, 0};
+	uint8 ch, k, j, want, bad;
+	uint16 x, y, count;
+
+	for(ch = f->first; ch <= f->last; ch++)
+	{
+		s[0] = (char8)ch;
+		fontGlyph(f, s[0], &g);
+		clearScreen(matrix);
+		drawString(5, 3, s, f, white, matrix);
+		for(j = 0, bad = 0; j < g.height; j++)
+		{
+			for(k = 0; k < g.width; k++)
+			{
+				want = (g.data[j] >> k) & 1u;
+				bad |= (lit(5u + k, 3u + j) != want);
+			}
+		}
+		for(y = 0, count = 0; y < MATRIX_HEIGHT; y++)
+		{
+			for(x = 0; x < MATRIX_WIDTH; x++)
+			{
+				count += lit((uint8)x, (uint8)y);
+			}
+		}
+		for(j = 0; j < g.height; j++)
+		{
+			for(k = 0; k < g.width; k++)
+			{
+				count -= (g.data[j] >> k) & 1u;
+			}
+		}
+		CHECK(!bad && (count == 0u), "%s '%c' does not draw its bitmap", name, ch);
+	}
+}
+
+/* Host time per character over 'reps' strings */
+static double nsPerChar(const Font *f, const char8 *s, int8 x, uint32 reps)
+{
+	uint32 n;
+	double t0 = benchNs();
+
+	for(n = 0; n < reps; n++)
+	{
+		drawString(x, 0, s, f, white, matrix);
+	}
+	return (benchNs() - t0) / ((double)reps * strlen(s));
+}
+
+int main(void)
+{
+	static const char8 text[] = "12:34 Tue";
+	static const char8 longText[] = "The quick brown fox jumps over the lazy dog";
+	const Font *fonts[2] = {&font5x7, &font3x5};
+	const char *names[2] = {"5x7", "3x5"};
+	char8 s[8];
+	uint8 i, n, k;
+	uint32 seed = 5;
+	int16 pen, width, x, y, right;
+	Sprite t, dot;
+
+	for(i = 0; i < 2u; i++)
+	{
+		checkTables(names[i], fonts[i]);
+		checkGlyphs(names[i], fonts[i]);
+
+		/* pen, width and ink agree for random short strings */
+		for(n = 0; n < 200u; n++)
+		{
+			for(k = 0; k < sizeof(s) - 1u; k++)
+			{
+				seed = seed * 1103515245u + 12345u;
+				s[k] = (char8)(33u + (seed >> 16) % 94u);
+			}
+			s[k - (n % 4u)] = 0;
+			width = measureString(s, fonts[i]);
+			clearScreen(matrix);
+			pen = drawString(0, 0, s, fonts[i], white, matrix);
+			if(width > MATRIX_WIDTH)
+			{
+				continue;
+			}
+			CHECK(pen == width, "%s \"%s\": pen at %d, measured %d", names[i], s, pen, width);
+			for(y = 0, right = -1; y < MATRIX_HEIGHT; y++)
+			{
+				for(x = 0; x < MATRIX_WIDTH; x++)
+				{
+					if(lit((uint8)x, (uint8)y))
+					{
+						right = (x > right) ? x : right;
+						CHECK(y < fonts[i]->height, "%s \"%s\": ink below the cell", names[i], s);
+					}
+				}
+			}
+			CHECK(right == width - 1, "%s \"%s\": ink ends at %d, measured %d", names[i], s, right, width);
+		}
+	}
+
+	/* kerning pairs close up, other pairs keep the spacing */
+	fontGlyph(&font5x7, 'T', &t);
+	fontGlyph(&font5x7, '.', &dot);
+	CHECK(measureString("T.", &font5x7) == t.width + dot.width + font5x7.spacing - 1,
+		"'T.' is not kerned: %d", measureString("T.", &font5x7));
+	CHECK(measureString(".T", &font5x7) == t.width + dot.width + font5x7.spacing,
+		"'.T' is kerned: %d", measureString(".T", &font5x7));
+	CHECK(measureString("", &font5x7) == 0, "empty string measures %d", measureString("", &font5x7));
+
+	/* a string running off the right edge stops there */
+	clearScreen(matrix);
+	pen = drawString(0, 0, longText, &font5x7, white, matrix);
+	CHECK((pen >= SURFACE_WIDTH) && (pen < SURFACE_WIDTH + (int16)FONT_MAX_GLYPH_WIDTH + 2),
+		"long string: pen at %d", pen);
+
+	/* host figures, the M0 ones come from the TLM_STAT_GLYPH telemetry stat */
+	for(i = 0; i < 2u; i++)
+	{
+		printf("drawString %s: %.0f ns/char on the panel, %.0f ns/char starting off the left edge\n",
+			names[i], nsPerChar(fonts[i], text, 0, 200000u), nsPerChar(fonts[i], text, -60, 200000u));
+	}
+
+	return TEST_RESULT("font");
+}
+
+/* [] END OF FILE */
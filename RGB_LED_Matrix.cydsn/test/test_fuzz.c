@@ -0,0 +1,309 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* Random drawing primitives with random, mostly off-screen arguments under a
+ * random clip rectangle, into a framebuffer fenced by guard bytes. After
+ * every call the guards must be intact and no pixel outside the clip
+ * rectangle may have changed.
+ *   fuzz [iterations [seed]]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "Font.h"
+#include "test.h"
+
+#define GUARD			256
+#define GUARD_BYTE		0xA5u
+
+static struct
+{
+	uint8 before[GUARD];
+	color fb[MATRIX_LANES];
+	uint8 after[GUARD];
+} buf;
+
+static color snapshot[MATRIX_LANES];
+
+/* the clip rectangle as setClipRect should have cut it */
+static int16 clipL, clipT, clipR, clipB;
+
+static uint32 seed = 1;
+
+static uint32 rnd(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/* lo to hi inclusive */
+static int16 range(int16 lo, int16 hi)
+{
+	return (int16)(lo + (int16)(rnd() % (uint32)(hi - lo + 1)));
+}
+
+/* Coordinates: mostly around the canvas, sometimes anywhere in int8 */
+static int8 coordX(void)
+{
+	return (int8)((rnd() & 7u) ? range(-40, CANVAS_WIDTH + 40) : range(-128, 127));
+}
+
+static int8 coordY(void)
+{
+	return (int8)((rnd() & 7u) ? range(-40, CANVAS_HEIGHT + 40) : range(-128, 127));
+}
+
+/* Sizes and radii: mostly small, sometimes negative or huge */
+static int8 size(void)
+{
+	return (int8)((rnd() & 7u) ? range(-4, 70) : range(-128, 127));
+}
+
+static RGB anyColor(void)
+{
+	RGB c;
+
+	c.r = (uint8)rnd();
+	c.g = (uint8)rnd();
+	c.b = (uint8)rnd();
+	return c;
+}
+
+static void newClip(void)
+{
+	int8 x, y, w, h;
+
+	if((rnd() & 3u) == 0u)
+	{
+		resetClipRect();
+		clipL = 0;
+		clipT = 0;
+		clipR = CANVAS_WIDTH - 1;
+		clipB = CANVAS_HEIGHT - 1;
+		return;
+	}
+	x = coordX();
+	y = coordY();
+	w = size();
+	h = size();
+	setClipRect(x, y, w, h);
+	clipL = (x < 0) ? 0 : x;
+	clipT = (y < 0) ? 0 : y;
+	clipR = (int16)x + w - 1;
+	clipB = (int16)y + h - 1;
+	if(clipR > CANVAS_WIDTH - 1)
+	{
+		clipR = CANVAS_WIDTH - 1;
+	}
+	if(clipB > CANVAS_HEIGHT - 1)
+	{
+		clipB = CANVAS_HEIGHT - 1;
+	}
+}
+
+static uint8 spriteData[SPRITE_MAX_WIDTH / 2u * 40u];
+
+static void anySprite(Sprite *s)
+{
+	uint16 i;
+
+	s->width = (uint8)range(1, SPRITE_MAX_WIDTH);
+	s->height = (uint8)range(1, 40);
+	s->data = spriteData;
+	for(i = 0; i < sizeof(spriteData); i++)
+	{
+		spriteData[i] = (uint8)rnd();
+	}
+}
+
+/* One random call, its name for the report */
+static const char *drawSomething(void)
+{
+	RGB c = anyColor(), row[80], palette[16];
+	uint8 bits[MATRIX_ROW_BYTES], i;
+	Sprite s;
+	char8 text[12];
+
+	switch(rnd() % 22u)
+	{
+		case 0:
+			drawPixel(coordX(), coordY(), c, buf.fb);
+			return "drawPixel";
+		case 1:
+			clearPixel((uint8)coordX(), (uint8)coordY(), buf.fb);
+			return "clearPixel";
+		case 2:
+			drawLine(coordX(), coordY(), coordX(), coordY(), c, buf.fb);
+			return "drawLine";
+		case 3:
+			drawCircle(coordX(), coordY(), size(), c, buf.fb);
+			return "drawCircle";
+		case 4:
+			drawCircleHelper(coordX(), coordY(), size(), (int8)range(0, 15), c, buf.fb);
+			return "drawCircleHelper";
+		case 5:
+			drawFastVLine(coordX(), coordY(), size(), c, buf.fb);
+			return "drawFastVLine";
+		case 6:
+			drawFastHLine(coordX(), coordY(), size(), c, buf.fb);
+			return "drawFastHLine";
+		case 7:
+			fillRect(coordX(), coordY(), size(), size(), c, buf.fb);
+			return "fillRect";
+		case 8:
+			fillScreen(c, buf.fb);
+			return "fillScreen";
+		case 9:
+			for(i = 0; i < 80u; i++)
+			{
+				row[i] = anyColor();
+			}
+			drawRow(coordX(), coordY(), (uint8)range(0, 80), row, buf.fb);
+			return "drawRow";
+		case 10:
+			for(i = 0; i < MATRIX_ROW_BYTES; i++)
+			{
+				bits[i] = (uint8)rnd();
+			}
+			drawRowBits(coordY(), bits, c, anyColor(), buf.fb);
+			return "drawRowBits";
+		case 11:
+			drawTriangle(coordX(), coordY(), coordX(), coordY(), coordX(), coordY(), c, buf.fb);
+			return "drawTriangle";
+		case 12:
+			fillCircle(coordX(), coordY(), size(), c, buf.fb);
+			return "fillCircle";
+		case 13:
+			fillRoundRect(coordX(), coordY(), size(), size(), size(), c, buf.fb);
+			return "fillRoundRect";
+		case 14:
+			fillTriangle(coordX(), coordY(), coordX(), coordY(), coordX(), coordY(), c, buf.fb);
+			return "fillTriangle";
+		case 15:
+			anySprite(&s);
+			drawSprite1(coordX(), coordY(), &s, c, (uint8)(rnd() & 3u), buf.fb);
+			return "drawSprite1";
+		case 16:
+			anySprite(&s);
+			for(i = 0; i < 16u; i++)
+			{
+				palette[i] = anyColor();
+			}
+			drawSprite4(coordX(), coordY(), &s, palette, ((rnd() & 1u) ? (uint8)range(0, 15) : SPRITE_NO_TRANSPARENT),
+				(uint8)(rnd() & 3u), buf.fb);
+			return "drawSprite4";
+		case 17:
+			drawHex((uint8)rnd(), coordX(), coordY(), c, buf.fb);
+			return "drawHex";
+		case 18:
+			drawblock((int8)range(-128, 127), size(), c, buf.fb);
+			return "drawblock";
+		case 19:
+			fallingLine((int8)range(-128, 127), size(), c, buf.fb);
+			return "fallingLine";
+		case 20:
+			for(i = 0; i < sizeof(text) - 1u; i++)
+			{
+				text[i] = (char8)range(1, 255);
+			}
+			text[i] = 0;
+			drawString(coordX(), coordY(), text, (rnd() & 1u) ? &font5x7 : &font3x5, c, buf.fb);
+			return "drawString";
+		default:
+			printTime((uint8)rnd(), (uint8)rnd(), (uint8)rnd(), c, buf.fb);
+			return "printTime";
+	}
+}
+
+/* The first pixel changed outside the clip rectangle, -1 if none */
+static int16 strayPixel(void)
+{
+	uint16 lane, x, y;
+	uint8 i, diff;
+	const uint8 *now, *was;
+
+	for(lane = 0; lane < MATRIX_LANES; lane++)
+	{
+		now = (const uint8 *)&buf.fb[lane];
+		was = (const uint8 *)&snapshot[lane];
+		for(i = 0, diff = 0; i < sizeof(color); i++)
+		{
+			diff |= now[i] ^ was[i];
+		}
+		for(x = (lane % MATRIX_ROW_BYTES) * 8u, y = lane / MATRIX_ROW_BYTES; diff; diff >>= 1, x++)
+		{
+			if((diff & 1u) && ((x < clipL) || (x > clipR) || (y < clipT) || (y > clipB)))
+			{
+				return (int16)(y * MATRIX_WIDTH + x);
+			}
+		}
+	}
+	return -1;
+}
+
+static uint8 guardsIntact(void)
+{
+	uint16 i;
+
+	for(i = 0; i < GUARD; i++)
+	{
+		if((buf.before[i] != GUARD_BYTE) || (buf.after[i] != GUARD_BYTE))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	uint32 n, iterations = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 0) : 200000u;
+	const char *what;
+	int16 stray;
+
+	if(argc > 2)
+	{
+		seed = (uint32)strtoul(argv[2], NULL, 0) | 1u;
+	}
+	memset(buf.before, GUARD_BYTE, GUARD);
+	memset(buf.after, GUARD_BYTE, GUARD);
+
+	for(n = 0; n < iterations; n++)
+	{
+		if((n & 15u) == 0u)
+		{
+			newClip();
+		}
+		memcpy(snapshot, buf.fb, sizeof(snapshot));
+		what = drawSomething();
+		if(!guardsIntact())
+		{
+			CHECK(0, "%s wrote outside the framebuffer, iteration %u", what, n);
+			break;
+		}
+		stray = strayPixel();
+		if(stray >= 0)
+		{
+			CHECK(0, "%s changed %d,%d outside the clip rectangle %d,%d - %d,%d, iteration %u", what,
+				stray % MATRIX_WIDTH, stray / MATRIX_WIDTH, clipL, clipT, clipR, clipB, n);
+			break;
+		}
+	}
+	printf("%u draw calls\n", n);
+
+	return TEST_RESULT("fuzz " TEST_GEOMETRY);
+}
+
+/* [] END OF FILE */
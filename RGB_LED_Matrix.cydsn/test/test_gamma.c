@@ -0,0 +1,140 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* 8-bit ramps through drawPixel's gamma table and setBrightness: the light
+ * out (plane value times OE on-time) never drops as the input rises, and
+ * follows (v / 255) ^ 2.2 to within the plane quantization, so equal input
+ * steps look equally bright. Then setBrightness's periods per plane and
+ * setColorDepth's clamping.
+ */
+
+#include <math.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "test.h"
+
+/* OE units plane value p is lit for at the current brightness */
+static uint16 onTime(uint8 p)
+{
+	uint16 t = 0;
+	uint8 i;
+
+	for(i = 0; i < BCM_PLANES; i++)
+	{
+		if(p & (1u << i))
+		{
+			t += bcmPeriod[i];
+		}
+	}
+	return t;
+}
+
+int main(void)
+{
+	RGB c, p, last = {0, 0, 0};
+	uint16 v, level, t, lastT;
+	double want;
+	uint8 q;
+
+	/* every channel on its own, the others must stay dark */
+	for(v = 0; v < 256u; v++)
+	{
+		c.r = (uint8)v;
+		c.g = 0;
+		c.b = (uint8)(255u - v);
+		drawPixel(3, 5, c, matrix);
+		p = hostPixel(3, 5);
+		CHECK(p.g == 0u, "green %u for red %u", p.g, v);
+
+		CHECK(p.r >= last.r, "red ramp drops at %u: %u after %u", v, p.r, last.r);
+		CHECK((v == 0u) || (p.b <= last.b), "blue ramp rises at %u", v);
+		want = 31.0 * pow(v / 255.0, 2.2);
+		CHECK(fabs(p.r - want) <= 0.625 + 1e-9, "red %u is %u, gamma 2.2 wants %.2f", v, p.r, want);
+		last = p;
+	}
+	CHECK(last.r == 31u, "full red is plane value %u", last.r);
+
+	/* and never more than one plane value per input step */
+	c.g = c.b = 0;
+	for(v = 1, q = 0; v < 256u; v++)
+	{
+		c.r = (uint8)v;
+		drawPixel(0, 0, c, matrix);
+		p = hostPixel(0, 0);
+		CHECK(p.r <= q + 1u, "jump of %u at %u", p.r - q, v);
+		q = p.r;
+	}
+
+	/* brightness: every plane's period grows with the plane and the level,
+	 * none is 0 before the level is, and every period is the exact weight
+	 * rounded up
+	 */
+	for(level = 0; level < 256u; level++)
+	{
+		setBrightness((uint8)level);
+		for(q = 0; q < BCM_PLANES; q++)
+		{
+			want = (double)(BCM_UNIT_MAX << q) * level / 255.0;
+			CHECK((bcmPeriod[q] >= want) && (bcmPeriod[q] < want + 1.0), "level %u: plane %u on for %u, %.2f wanted",
+				level, q, bcmPeriod[q], want);
+			CHECK((level == 0u) || (bcmPeriod[q] >= 1u), "level %u: plane %u is dark", level, q);
+			CHECK((q == 0u) || (bcmPeriod[q] >= bcmPeriod[q - 1u]), "level %u: plane %u shorter than plane %u",
+				level, q, q - 1u);
+		}
+		for(q = 1, lastT = 0; q < 32u; q++)
+		{
+			/* rounding up costs the binary weighting at most a unit per
+			 * lower plane
+			 */
+			t = onTime(q);
+			CHECK(t + BCM_PLANES - 1u >= lastT, "level %u: value %u on for %u, %u below", level, q, t, lastT);
+			lastT = t;
+		}
+	}
+
+	/* the on-time of every plane value is monotonic in the level, and
+	 * exactly linear at full brightness
+	 */
+	for(q = 1; q < 32u; q++)
+	{
+		for(level = 0, lastT = 0; level < 256u; level++)
+		{
+			setBrightness((uint8)level);
+			t = onTime(q);
+			CHECK(t >= lastT, "value %u: on for %u at level %u, %u below", q, t, level, lastT);
+			lastT = t;
+		}
+		CHECK(t == (uint16)(q * BCM_UNIT_MAX), "value %u at full brightness: %u units", q, t);
+		for(level = 128; level < 256u; level++)
+		{
+			setBrightness((uint8)level);
+			CHECK(onTime(q) >= onTime(q - 1u), "level %u: value %u darker than %u", level, q, q - 1u);
+		}
+	}
+	setBrightness(0);
+	CHECK(onTime(31) == 0u, "brightness 0 still lights %u units", onTime(31));
+	setBrightness(1);
+	CHECK(bcmPeriod[0] == 1u, "brightness 1 leaves plane 0 on for %u", bcmPeriod[0]);
+
+	/* colour depth: 1 to BCM_PLANES from the top plane down, clamped */
+	for(level = 0; level < 256u; level++)
+	{
+		setColorDepth((uint8)level);
+		q = (level < 1u) ? 1u : (level > BCM_PLANES) ? BCM_PLANES : (uint8)level;
+		CHECK((getColorDepth() == q) && (bcmFirstPlane == BCM_PLANES - q), "depth %u: %u planes from plane %u",
+			level, getColorDepth(), bcmFirstPlane);
+	}
+	setColorDepth(BCM_PLANES);
+
+	return TEST_RESULT("gamma");
+}
+
+/* [] END OF FILE */
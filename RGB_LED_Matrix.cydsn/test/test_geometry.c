@@ -0,0 +1,234 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* Built once per panel geometry (PANEL_WIDTH, PANEL_HEIGHT,
+ * MATRIX_SCAN_ROWS from the Makefile). Every pixel lands in its own bit of
+ * the lane the refresh reads for its scan row and half, whole-screen draws
+ * cover the framebuffer and nothing past it, and circles of radius 64 and
+ * more with their centre off the panel follow the midpoint stepping.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "test.h"
+
+#define GUARD			64
+#define GUARD_BYTE		0xA5u
+
+static struct
+{
+	uint8 before[GUARD];
+	color fb[MATRIX_LANES];
+	uint8 after[GUARD];
+} buf;
+
+static const RGB white = {255, 255, 255};
+
+static uint8 guardsIntact(void)
+{
+	uint8 i;
+
+	for(i = 0; i < GUARD; i++)
+	{
+		if((buf.before[i] != GUARD_BYTE) || (buf.after[i] != GUARD_BYTE))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Pixels set in the whole buffer, reading it the way the refresh does */
+static uint16 litPixels(void)
+{
+	uint16 lane, n = 0;
+	uint8 bit;
+
+	for(lane = 0; lane < MATRIX_LANES; lane++)
+	{
+		for(bit = 0; bit < 8u; bit++)
+		{
+			n += ((buf.fb[lane].r[BCM_PLANES - 1] >> bit) & 1u);
+		}
+	}
+	return n;
+}
+
+static uint8 isLit(uint8 x, uint8 y)
+{
+	return (buf.fb[MATRIX_LANE(x, y)].r[BCM_PLANES - 1] >> (x % 8u)) & 1u;
+}
+
+static uint8 want[MATRIX_HEIGHT][MATRIX_WIDTH];
+
+static void wantPoint(int x, int y)
+{
+	if((x >= 0) && (x < MATRIX_WIDTH) && (y >= 0) && (y < MATRIX_HEIGHT))
+	{
+		want[y][x] = 1;
+	}
+}
+
+/* drawCircle's midpoint stepping in int, the points on the panel; without
+ * the four on the axes for drawCircleHelper's corners
+ */
+static void wantCircle(int x0, int y0, int r, uint8 axes)
+{
+	int f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+
+	memset(want, 0, sizeof(want));
+	if(axes)
+	{
+		wantPoint(x0, y0 + r);
+		wantPoint(x0, y0 - r);
+		wantPoint(x0 + r, y0);
+		wantPoint(x0 - r, y0);
+	}
+	while(x < y)
+	{
+		if(f >= 0)
+		{
+			y--;
+			ddF_y += 2;
+			f += ddF_y;
+		}
+		x++;
+		ddF_x += 2;
+		f += ddF_x;
+		wantPoint(x0 + x, y0 + y);
+		wantPoint(x0 - x, y0 + y);
+		wantPoint(x0 + x, y0 - y);
+		wantPoint(x0 - x, y0 - y);
+		wantPoint(x0 + y, y0 + x);
+		wantPoint(x0 - y, y0 + x);
+		wantPoint(x0 + y, y0 - x);
+		wantPoint(x0 - y, y0 - x);
+	}
+}
+
+static uint8 litAsWanted(void)
+{
+	uint16 x, y;
+
+	for(y = 0; y < MATRIX_HEIGHT; y++)
+	{
+		for(x = 0; x < MATRIX_WIDTH; x++)
+		{
+			if(isLit((uint8)x, (uint8)y) != want[y][x])
+			{
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+int main(void)
+{
+	uint16 x, y, lane, j, half;
+	int16 cx, cy, r;
+	uint8 i, bit, ok;
+	const color *row;
+
+	memset(buf.before, GUARD_BYTE, GUARD);
+	memset(buf.after, GUARD_BYTE, GUARD);
+	printf("geometry %ux%u, 1/%u scan, %u lanes, %u FIFO chunks per row\n",
+		MATRIX_WIDTH, MATRIX_HEIGHT, MATRIX_SCAN_ROWS, MATRIX_LANES, MATRIX_ROW_CHUNKS);
+
+	/* every pixel on its own: one bit, in all planes, nowhere else */
+	for(y = 0; y < MATRIX_HEIGHT; y++)
+	{
+		for(x = 0; x < MATRIX_WIDTH; x++)
+		{
+			clearScreen(buf.fb);
+			drawPixel((int8)x, (int8)y, white, buf.fb);
+			bit = (uint8)(1u << (x % 8u));
+			for(lane = 0, ok = 1; lane < MATRIX_LANES; lane++)
+			{
+				for(i = 0; i < BCM_PLANES; i++)
+				{
+					uint8 want = (lane == MATRIX_LANE(x, y)) ? bit : 0u;
+
+					ok &= (buf.fb[lane].r[i] == want) && (buf.fb[lane].g[i] == want) && (buf.fb[lane].b[i] == want);
+				}
+			}
+			CHECK(ok, "pixel %u,%u is not bit %u of lane %u alone", x, y, x % 8u, MATRIX_LANE(x, y));
+		}
+	}
+	CHECK(guardsIntact(), "single pixels wrote outside the framebuffer");
+
+	/* scan row j shows row j in the upper half and row j + MATRIX_SCAN_ROWS
+	 * in the lower, MATRIX_ROW_BYTES lanes each from the MATRIX_UPPER and
+	 * MATRIX_LOWER lanes
+	 */
+	for(j = 0; j < MATRIX_SCAN_ROWS; j++)
+	{
+		for(half = 0; half < 2u; half++)
+		{
+			y = j + half * MATRIX_SCAN_ROWS;
+			clearScreen(buf.fb);
+			drawFastHLine(0, (int8)y, MATRIX_WIDTH, white, buf.fb);
+			row = &buf.fb[half ? MATRIX_LOWER(j) : MATRIX_UPPER(j)];
+			for(lane = 0, ok = 1; lane < MATRIX_ROW_BYTES; lane++)
+			{
+				ok &= (row[lane].g[0] == 0xFFu);
+			}
+			CHECK(ok && (litPixels() == MATRIX_WIDTH), "row %u is not where scan row %u reads it", y, j);
+		}
+	}
+
+	/* whole-screen draws */
+	fillScreen(white, buf.fb);
+	CHECK(litPixels() == MATRIX_WIDTH * MATRIX_HEIGHT, "fillScreen lit %u pixels", litPixels());
+	clearScreen(buf.fb);
+	fillRect(0, 0, MATRIX_WIDTH, MATRIX_HEIGHT, white, buf.fb);
+	CHECK(litPixels() == MATRIX_WIDTH * MATRIX_HEIGHT, "full fillRect lit %u pixels", litPixels());
+	clearScreen(buf.fb);
+	CHECK(litPixels() == 0u, "clearScreen left %u pixels", litPixels());
+
+	/* corner to corner, and a circle as large as the panel allows */
+	drawLine(0, 0, MATRIX_WIDTH - 1, MATRIX_HEIGHT - 1, white, buf.fb);
+	CHECK(isLit(0, 0) && isLit(MATRIX_WIDTH - 1, MATRIX_HEIGHT - 1), "diagonal misses a corner");
+	CHECK(litPixels() == MATRIX_WIDTH, "diagonal lit %u pixels", litPixels());
+	clearScreen(buf.fb);
+	drawCircle(MATRIX_WIDTH / 2, MATRIX_HEIGHT / 2, MATRIX_HEIGHT / 2 - 1, white, buf.fb);
+	CHECK(isLit(MATRIX_WIDTH / 2, 1) && isLit(MATRIX_WIDTH / 2, MATRIX_HEIGHT - 1) &&
+		isLit(MATRIX_WIDTH / 2 - MATRIX_HEIGHT / 2 + 1, MATRIX_HEIGHT / 2) &&
+		isLit(MATRIX_WIDTH / 2 + MATRIX_HEIGHT / 2 - 1, MATRIX_HEIGHT / 2), "circle misses an extreme");
+	CHECK(guardsIntact(), "drawing wrote outside the framebuffer");
+
+	/* radii past 63 and centres off the panel, where the edge still crosses
+	 * it: no int8 overflow bending the arc, no point wrapping back on
+	 */
+	for(r = 64; r <= 127; r += 7)
+	{
+		for(cx = -128; cx <= 127; cx += 17)
+		{
+			for(cy = -128; cy <= 127; cy += 51)
+			{
+				wantCircle(cx, cy, r, 1);
+				clearScreen(buf.fb);
+				drawCircle((int8)cx, (int8)cy, (int8)r, white, buf.fb);
+				CHECK(litAsWanted(), "drawCircle(%d, %d, %d) differs from the int stepping", cx, cy, r);
+				clearScreen(buf.fb);
+				drawCircleHelper((int8)cx, (int8)cy, (int8)r, 0x0F, white, buf.fb);
+				wantCircle(cx, cy, r, 0);
+				CHECK(litAsWanted(), "drawCircleHelper(%d, %d, %d, 0x0F) differs from the int stepping", cx, cy, r);
+			}
+		}
+	}
+	CHECK(guardsIntact(), "large circles wrote outside the framebuffer");
+
+	return TEST_RESULT("geometry " TEST_GEOMETRY);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,301 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* lifeStep against a neighbor count per cell for random fields and rules,
+ * with and without LIFE_WRAP; Conway's still life, blinker and a glider
+ * round the torus; lifeService's timing and reseeding; then generations
+ * per second, bit-sliced and per cell.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "Life.h"
+#include "test.h"
+
+#define W		CANVAS_WIDTH
+#define H		CANVAS_HEIGHT
+
+static const RGB white = {255, 255, 255};
+static const RGB black = {0, 0, 0};
+
+static uint8 cells[H][W];
+static uint8 next[H][W];
+
+static uint32 seed = 3;
+
+static uint32 rnd(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/* The field as lifeDraw shows it */
+static void readField(uint8 out[H][W])
+{
+	uint8 x, y;
+
+	lifeDraw(white, black, matrix);
+	for(y = 0; y < H; y++)
+	{
+		for(x = 0; x < W; x++)
+		{
+			out[y][x] = hostPixel(x, y).r != 0u;
+		}
+	}
+}
+
+static void writeField(uint8 in[H][W])
+{
+	uint8 x, y;
+
+	for(y = 0; y < H; y++)
+	{
+		for(x = 0; x < W; x++)
+		{
+			lifeSet((int8)x, (int8)y, in[y][x]);
+		}
+	}
+}
+
+/* One generation the slow way, cell by cell */
+static void refStep(uint8 in[H][W], uint8 out[H][W], uint16 birth, uint16 survive, uint8 wrap)
+{
+	int16 x, y, dx, dy, nx, ny;
+	uint8 n;
+
+	for(y = 0; y < H; y++)
+	{
+		for(x = 0; x < W; x++)
+		{
+			for(n = 0, dy = -1; dy <= 1; dy++)
+			{
+				for(dx = -1; dx <= 1; dx++)
+				{
+					nx = x + dx;
+					ny = y + dy;
+					if((dx == 0) && (dy == 0))
+					{
+						continue;
+					}
+					if(wrap)
+					{
+						nx = (nx + W) % W;
+						ny = (ny + H) % H;
+					}
+					else if((nx < 0) || (nx >= W) || (ny < 0) || (ny >= H))
+					{
+						continue;
+					}
+					n += in[ny][nx];
+				}
+			}
+			out[y][x] = in[y][x] ? ((survive >> n) & 1u) : ((birth >> n) & 1u);
+		}
+	}
+}
+
+static uint8 fieldIs(uint8 want[H][W])
+{
+	uint8 got[H][W];
+
+	readField(got);
+	return memcmp(got, want, sizeof(got)) == 0;
+}
+
+static void clearField(void)
+{
+	memset(cells, 0, sizeof(cells));
+	writeField(cells);
+}
+
+/* Conway's glider heading down and right, top left cell at x, y */
+static void glider(uint8 f[H][W], uint8 x, uint8 y)
+{
+	f[y][(x + 1u) % W] = 1;
+	f[(y + 1u) % H][(x + 2u) % W] = 1;
+	f[(y + 2u) % H][x % W] = 1;
+	f[(y + 2u) % H][(x + 1u) % W] = 1;
+	f[(y + 2u) % H][(x + 2u) % W] = 1;
+}
+
+static uint8 liveCells(void)
+{
+	uint8 got[H][W], x, y, n = 0;
+
+	readField(got);
+	for(y = 0; y < H; y++)
+	{
+		for(x = 0; x < W; x++)
+		{
+			n += got[y][x];
+		}
+	}
+	return n;
+}
+
+int main(void)
+{
+	uint16 birth, survive, g, i;
+	uint8 wrap, x, y, density, steps, lit;
+	uint32 t;
+	double t0, fast, slow;
+
+	/* random rules, densities and edges against the reference */
+	for(i = 0; i < 3000u; i++)
+	{
+		birth = (uint16)(rnd() & 0x1FFu);
+		survive = (uint16)(rnd() & 0x1FFu);
+		wrap = (uint8)(rnd() & 1u);
+		density = (uint8)(rnd() % 8u);
+		if(i < 200u)
+		{
+			/* Conway's often, the rule everyone runs */
+			birth = LIFE_BIRTH;
+			survive = LIFE_SURVIVE;
+		}
+		lifeRule(birth, survive, wrap ? LIFE_WRAP : 0u);
+		for(y = 0; y < H; y++)
+		{
+			for(x = 0; x < W; x++)
+			{
+				cells[y][x] = (rnd() % 8u) < density;
+			}
+		}
+		writeField(cells);
+		for(steps = 0; steps < 4u; steps++)
+		{
+			refStep(cells, next, birth, survive, wrap);
+			memcpy(cells, next, sizeof(cells));
+			lifeStep();
+			if(!fieldIs(cells))
+			{
+				CHECK(0, "B%03x/S%03x %s, density %u/8: generation %u differs from the per-cell count",
+					birth, survive, wrap ? "wrapped" : "bounded", density, steps + 1u);
+				break;
+			}
+		}
+		if(testFailures > 10u)
+		{
+			break;
+		}
+	}
+
+	lifeRule(LIFE_BIRTH, LIFE_SURVIVE, LIFE_WRAP);
+
+	/* a block stays, a blinker has period 2, also across the edge */
+	clearField();
+	cells[4][4] = cells[4][5] = cells[5][4] = cells[5][5] = 1;
+	writeField(cells);
+	lifeStep();
+	CHECK(fieldIs(cells), "block does not stay");
+
+	clearField();
+	cells[0][W - 1] = cells[0][0] = cells[0][1] = 1;
+	writeField(cells);
+	lifeStep();
+	CHECK(!fieldIs(cells) && (liveCells() == 3u), "blinker across the edge does not turn");
+	lifeStep();
+	CHECK(fieldIs(cells), "blinker across the edge does not come back");
+
+	/* a glider moves one cell down and right every 4 generations and is
+	 * back where it started after going round the torus
+	 */
+	clearField();
+	glider(cells, 10, 3);
+	writeField(cells);
+	for(g = 0; g < 4u; g++)
+	{
+		lifeStep();
+	}
+	memset(next, 0, sizeof(next));
+	glider(next, 11, 4);
+	CHECK(fieldIs(next), "glider did not move by one cell in 4 generations");
+	for(; g < 4u * W; g++)
+	{
+		lifeStep();
+	}
+	CHECK(fieldIs(cells), "glider not back after %u generations", 4u * W);
+
+	/* without LIFE_WRAP it settles into a block at the corner */
+	lifeRule(LIFE_BIRTH, LIFE_SURVIVE, 0);
+	for(g = 0; g < 4u * W; g++)
+	{
+		lifeStep();
+	}
+	CHECK(liveCells() == 4u, "bounded glider ends with %u cells", liveCells());
+	lifeRule(LIFE_BIRTH, LIFE_SURVIVE, LIFE_WRAP);
+
+	/* cells off the field are ignored */
+	clearField();
+	lifeSet(-1, 0, 1);
+	lifeSet(W, 0, 1);
+	lifeSet(0, -1, 1);
+	lifeSet(0, H, 1);
+	lifeSet(-128, 127, 1);
+	CHECK(liveCells() == 0u, "lifeSet off the field set a cell");
+
+	/* lifeService steps every LIFE_GENERATION_MS and draws in the given
+	 * color
+	 */
+	clearField();
+	cells[7][10] = cells[7][11] = cells[7][12] = 1;
+	writeField(cells);
+	hostMillis = 1000u;
+	lifeService(white, matrix);
+	hostMillis += LIFE_GENERATION_MS - 1u;
+	lifeService(white, matrix);
+	refStep(cells, next, LIFE_BIRTH, LIFE_SURVIVE, 1);
+	CHECK(fieldIs(next), "lifeService stepped early or not at all");
+	hostMillis += 1u;
+	lifeService(white, matrix);
+	CHECK(fieldIs(cells), "lifeService did not step after LIFE_GENERATION_MS");
+
+	/* a blinker is reseeded once it has repeated itself for
+	 * LIFE_STALE_GENERATIONS, from its third generation on, not before
+	 */
+	for(g = 0; g < LIFE_STALE_GENERATIONS - 1u; g++)
+	{
+		hostMillis += LIFE_GENERATION_MS;
+		lifeService(white, matrix);
+	}
+	lit = liveCells();
+	CHECK(lit == 3u, "blinker reseeded early, %u cells", lit);
+	hostMillis += LIFE_GENERATION_MS;
+	lifeService(white, matrix);
+	lit = liveCells();
+	CHECK(lit > 3u, "blinker not reseeded after LIFE_STALE_GENERATIONS, %u cells", lit);
+
+	/* host figures, the M0 ones from the TLM_STAT_LIFE telemetry stat */
+	lifeSeed();
+	readField(cells);
+	t0 = benchNs();
+	for(t = 0; t < 200000u; t++)
+	{
+		lifeStep();
+	}
+	fast = (benchNs() - t0) / 200000u;
+	t0 = benchNs();
+	for(t = 0; t < 2000u; t++)
+	{
+		refStep(cells, next, LIFE_BIRTH, LIFE_SURVIVE, 1);
+		memcpy(cells, next, sizeof(cells));
+	}
+	slow = (benchNs() - t0) / 2000u;
+	printf("lifeStep %ux%u: %.0f ns, %.0f gen/s; per cell %.0f ns, %.0f gen/s\n", W, H, fast, 1e9 / fast,
+		slow, 1e9 / slow);
+
+	return TEST_RESULT("life");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,209 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* Built with LED_MATRIX_PALETTE. paletteExpandRow against the lanes the
+ * plane buffer's putPixel lays out for the same pixels, every scan row, for
+ * random pictures drawn by index and by color, after paletteSet and with
+ * clipping; then the time per row against the window it has to fit in.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "test.h"
+
+#if !LED_MATRIX_PALETTE
+#error "build with -DLED_MATRIX_PALETTE=1"
+#endif
+
+/* Plane values of the channels 0, 128 and 255, as putPixel's gamma gives
+ * them and the default palette has them
+ */
+static const uint8 level[3] = {0, 128, 255};
+static const uint8 planeOf[3] = {0, 7, 31};
+
+/* What each palette entry should show, and which entry each pixel holds */
+static RGB entry[PALETTE_SIZE];
+static uint8 pixel[CANVAS_HEIGHT][CANVAS_WIDTH];
+
+static uint32 seed = 17;
+
+static uint32 rnd(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/* The two-row buffer for scan row j, laid out as putPixel lays out the
+ * plane buffer: bit x % 8 of lane x / 8, every plane of every channel
+ */
+static void refRows(uint8 j, color *ref)
+{
+	uint8 half, x, i, bit;
+	RGB p;
+	color *lane;
+
+	memset(ref, 0, MATRIX_BUFFER_LANES * sizeof(color));
+	for(half = 0; half < 2u; half++)
+	{
+		for(x = 0; x < MATRIX_WIDTH; x++)
+		{
+			p = entry[pixel[j + half * MATRIX_SCAN_ROWS][x]];
+			lane = &ref[half * MATRIX_ROW_BYTES + x / 8u];
+			bit = (uint8)(1u << (x % 8u));
+			for(i = 0; i < BCM_PLANES; i++)
+			{
+				lane->r[i] |= (p.r & (1u << i)) ? bit : 0u;
+				lane->g[i] |= (p.g & (1u << i)) ? bit : 0u;
+				lane->b[i] |= (p.b & (1u << i)) ? bit : 0u;
+			}
+		}
+	}
+}
+
+/* Every scan row expanded and compared; 1 if all match */
+static uint8 expandsAsDrawn(const char *what)
+{
+	color ref[MATRIX_BUFFER_LANES];
+	uint8 j;
+
+	for(j = 0; j < MATRIX_SCAN_ROWS; j++)
+	{
+		paletteExpandRow(j, matrix);
+		refRows(j, ref);
+		if(memcmp(matrix, ref, sizeof(ref)) != 0)
+		{
+			CHECK(0, "%s: scan row %u differs from the plane layout", what, j);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static RGB channels(uint8 r, uint8 g, uint8 b)
+{
+	RGB c;
+
+	c.r = r;
+	c.g = g;
+	c.b = b;
+	return c;
+}
+
+int main(void)
+{
+	uint16 n, k;
+	uint8 x, y, e, r, g, b;
+	int8 px, py;
+	RGB c;
+	double t0, t;
+
+	/* the default palette: primaries at full, then at half */
+	for(e = 0; e < PALETTE_SIZE; e++)
+	{
+		k = (e < 8u) ? 2u : 1u;
+		entry[e] = channels((e & 1u) ? planeOf[k] : 0u, (e & 2u) ? planeOf[k] : 0u, (e & 4u) ? planeOf[k] : 0u);
+	}
+	clearScreen(matrix);
+	expandsAsDrawn("clearScreen");
+
+	/* random pictures by index, some of them recolored through paletteSet */
+	for(n = 0; n < 200u; n++)
+	{
+		for(k = 0; k < 300u; k++)
+		{
+			x = (uint8)(rnd() % CANVAS_WIDTH);
+			y = (uint8)(rnd() % CANVAS_HEIGHT);
+			pixel[y][x] = (uint8)(rnd() % PALETTE_SIZE);
+			drawPixelIndex((int8)x, (int8)y, pixel[y][x]);
+		}
+		if(n % 4u == 3u)
+		{
+			e = (uint8)(rnd() % PALETTE_SIZE);
+			r = (uint8)(rnd() % 3u);
+			g = (uint8)(rnd() % 3u);
+			b = (uint8)(rnd() % 3u);
+			paletteSet(e, channels(level[r], level[g], level[b]));
+			entry[e] = channels(planeOf[r], planeOf[g], planeOf[b]);
+		}
+		if(!expandsAsDrawn("drawPixelIndex"))
+		{
+			break;
+		}
+	}
+
+	/* by color: putPixel finds the entry that shows it exactly */
+	for(e = 0; e < PALETTE_SIZE; e++)
+	{
+		r = (uint8)(e % 3u);
+		g = (uint8)(e / 3u % 3u);
+		b = (uint8)(e / 9u % 3u);
+		paletteSet(e, channels(level[r], level[g], level[b]));
+		entry[e] = channels(planeOf[r], planeOf[g], planeOf[b]);
+	}
+	for(n = 0; n < 50u; n++)
+	{
+		for(k = 0; k < 300u; k++)
+		{
+			x = (uint8)(rnd() % CANVAS_WIDTH);
+			y = (uint8)(rnd() % CANVAS_HEIGHT);
+			e = (uint8)(rnd() % PALETTE_SIZE);
+			pixel[y][x] = e;
+			c = channels(level[e % 3u], level[e / 3u % 3u], level[e / 9u % 3u]);
+			drawPixel((int8)x, (int8)y, c, matrix);
+		}
+		if(!expandsAsDrawn("drawPixel"))
+		{
+			break;
+		}
+	}
+
+	/* off the canvas nothing changes, clearScreen leaves entry 0 */
+	for(k = 0; k < 2000u; k++)
+	{
+		px = (int8)rnd();
+		py = (int8)rnd();
+		if((px < 0) || (px >= CANVAS_WIDTH) || (py < 0) || (py >= CANVAS_HEIGHT))
+		{
+			drawPixelIndex(px, py, (uint8)rnd());
+		}
+	}
+	expandsAsDrawn("off the canvas");
+	clearScreen(matrix);
+	memset(pixel, 0, sizeof(pixel));
+	expandsAsDrawn("clearScreen after drawing");
+
+	/* host figure per row; on the target it has to fit in the longest plane's
+	 * OE window, bcmPeriod[BCM_PLANES - 1] units of 4 component clocks, and
+	 * the M0 time is the TLM_STAT_ROW_EXPAND telemetry stat
+	 */
+	for(y = 0; y < CANVAS_HEIGHT; y++)
+	{
+		for(x = 0; x < CANVAS_WIDTH; x++)
+		{
+			drawPixelIndex((int8)x, (int8)y, (uint8)(rnd() % PALETTE_SIZE));
+		}
+	}
+	t0 = benchNs();
+	for(n = 0; n < 50000u; n++)
+	{
+		paletteExpandRow((uint8)(n % MATRIX_SCAN_ROWS), matrix);
+	}
+	t = (benchNs() - t0) / 50000u;
+	printf("paletteExpandRow %ux%u: %.0f ns/row pair, window %u clocks (%.1f us on a 48 MHz component clock, full brightness)\n",
+		MATRIX_WIDTH, MATRIX_HEIGHT, t, bcmPeriod[BCM_PLANES - 1] * 4u, bcmPeriod[BCM_PLANES - 1] * 4u / 48.0);
+
+	return TEST_RESULT("palette");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,251 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* Built with LED_MATRIX_SCROLL, once per virtual canvas size. The window
+ * paletteExpandRow shows after scrollTo, scrollSpeed and scrollService:
+ * wrapping round the virtual canvas both ways, stopping at its edges, speed
+ * by elapsed time whatever the call rate, and the offset only taken up at
+ * the start of a frame, row MATRIX_SCAN_ROWS - 1 of the ISR's downward scan.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "test.h"
+
+#if !LED_MATRIX_SCROLL
+#error "build with -DLED_MATRIX_PALETTE=1 -DLED_MATRIX_SCROLL=1"
+#endif
+
+#define VW		VIRTUAL_WIDTH
+#define VH		VIRTUAL_HEIGHT
+
+/* Palette entry of every pixel of the virtual canvas */
+static uint8 pixel[VH][VW];
+
+static uint32 seed = 23;
+
+static uint32 rnd(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/* Plane value of the default palette's entry e in channel bit ch: the
+ * primaries at full, then at half
+ */
+static uint8 planeOf(uint8 e, uint8 ch)
+{
+	return (e & (1u << ch)) ? ((e < 8u) ? 31u : 7u) : 0u;
+}
+
+/* 1 when every scan row shows the window with its top left corner at
+ * ox, oy of the virtual canvas. The rows are expanded in the ISR's order,
+ * downwards, and the first takes up the scroll offset.
+ */
+static uint8 showsWindow(uint8 ox, uint8 oy)
+{
+	uint8 j, half, x, i, e, bit;
+	const color *lane;
+
+	for(j = MATRIX_SCAN_ROWS; j-- > 0;)
+	{
+		paletteExpandRow(j, matrix);
+		for(half = 0; half < 2u; half++)
+		{
+			for(x = 0; x < MATRIX_WIDTH; x++)
+			{
+				e = pixel[(oy + j + half * MATRIX_SCAN_ROWS) % VH][(ox + x) % VW];
+				lane = &matrix[half * MATRIX_ROW_BYTES + x / 8u];
+				bit = (uint8)(1u << (x % 8u));
+				for(i = 0; i < BCM_PLANES; i++)
+				{
+					if((((lane->r[i] & bit) != 0u) != ((planeOf(e, 0) >> i) & 1u)) ||
+						(((lane->g[i] & bit) != 0u) != ((planeOf(e, 1) >> i) & 1u)) ||
+						(((lane->b[i] & bit) != 0u) != ((planeOf(e, 2) >> i) & 1u)))
+					{
+						return 0;
+					}
+				}
+			}
+		}
+	}
+	return 1;
+}
+
+/* The offset the scroll should be at, in thousandths of a pixel: modulo the
+ * canvas when wrapping, else clamped so the window stays on it
+ */
+static int64_t limit(int64_t pos, int32 size, int32 view, uint8 wrap)
+{
+	int64_t span = (int64_t)size * 1000;
+
+	if(wrap)
+	{
+		return ((pos % span) + span) % span;
+	}
+	span -= (int64_t)view * 1000;
+	return (pos < 0) ? 0 : ((pos > span) ? span : pos);
+}
+
+static int64_t posX, posY;
+
+static void expectTo(int32 x, int32 y, uint8 wrap)
+{
+	posX = limit((int64_t)x * 1000, VW, MATRIX_WIDTH, wrap);
+	posY = limit((int64_t)y * 1000, VH, MATRIX_HEIGHT, wrap);
+}
+
+/* scrollService every 'step' ms for 'ms' ms at vx, vy pixels per second,
+ * and the same in the model; 1 if the window followed all the way
+ */
+static uint8 run(int16 vx, int16 vy, uint8 wrap, uint32 ms, uint32 step)
+{
+	uint32 t;
+	uint8 ok = 1;
+
+	for(t = 0; t < ms; t += step)
+	{
+		hostMillis += step;
+		scrollService();
+		posX = limit(posX + (int64_t)vx * step, VW, MATRIX_WIDTH, wrap);
+		posY = limit(posY + (int64_t)vy * step, VH, MATRIX_HEIGHT, wrap);
+		ok &= showsWindow((uint8)(posX / 1000), (uint8)(posY / 1000));
+	}
+	return ok;
+}
+
+int main(void)
+{
+	int16 x, y, vx, vy;
+	uint16 n;
+	uint8 wrap;
+	uint32 step;
+
+	printf("virtual canvas %ux%u behind a %ux%u panel\n", VW, VH, MATRIX_WIDTH, MATRIX_HEIGHT);
+	for(y = 0; y < VH; y++)
+	{
+		for(x = 0; x < VW; x++)
+		{
+			pixel[y][x] = (uint8)(rnd() % PALETTE_SIZE);
+			drawPixelIndex((int8)x, (int8)y, pixel[y][x]);
+		}
+	}
+	CHECK(showsWindow(0, 0), "not at the origin to begin with");
+
+	/* scrollTo, wrapping: any position lands on the canvas modulo its size,
+	 * negative ones included
+	 */
+	hostMillis = 1000u;
+	scrollSpeed(0, 0, 1);
+	for(n = 0; n < 2000u; n++)
+	{
+		x = (int16)((int32)(rnd() % 1024u) - 512);
+		y = (int16)((int32)(rnd() % 256u) - 128);
+		scrollTo(x, y);
+		expectTo(x, y, 1);
+		CHECK(showsWindow((uint8)(posX / 1000), (uint8)(posY / 1000)), "wrapping scrollTo(%d, %d) shows %d, %d",
+			x, y, (int)(posX / 1000), (int)(posY / 1000));
+	}
+
+	/* clamped: the window stops with its far edge on the canvas edge */
+	scrollSpeed(0, 0, 0);
+	for(n = 0; n < 2000u; n++)
+	{
+		x = (int16)((int32)(rnd() % 1024u) - 512);
+		y = (int16)((int32)(rnd() % 256u) - 128);
+		scrollTo(x, y);
+		expectTo(x, y, 0);
+		CHECK(showsWindow((uint8)(posX / 1000), (uint8)(posY / 1000)), "clamped scrollTo(%d, %d) shows %d, %d",
+			x, y, (int)(posX / 1000), (int)(posY / 1000));
+	}
+	scrollTo(VW, VH);
+	CHECK(showsWindow(VW - MATRIX_WIDTH, VH - MATRIX_HEIGHT), "clamped scrollTo past the far corner");
+	scrollTo(-1, -1);
+	CHECK(showsWindow(0, 0), "clamped scrollTo(-1, -1)");
+
+	/* the offset changes at the frame's first row only, never in the middle
+	 * of a frame
+	 */
+	scrollTo(5, 0);
+	paletteExpandRow(MATRIX_SCAN_ROWS - 1, matrix);
+	scrollTo(9, 0);
+	paletteExpandRow(MATRIX_SCAN_ROWS - 2, matrix);
+	scrollTo(0, 0);
+	CHECK(showsWindow(0, 0), "back at the origin");
+	scrollTo(3, 0);
+	paletteExpandRow(MATRIX_SCAN_ROWS - 1, matrix);
+	scrollTo(11, 0);
+	for(n = MATRIX_SCAN_ROWS - 1, wrap = 1; n-- > 0;)
+	{
+		uint8 e = pixel[n][3];
+
+		paletteExpandRow((uint8)n, matrix);
+		wrap &= (((matrix[0].r[BCM_PLANES - 1] & 1u) != 0u) == ((planeOf(e, 0) >> (BCM_PLANES - 1)) & 1u)) &&
+			(((matrix[0].g[BCM_PLANES - 1] & 1u) != 0u) == ((planeOf(e, 1) >> (BCM_PLANES - 1)) & 1u)) &&
+			(((matrix[0].b[BCM_PLANES - 1] & 1u) != 0u) == ((planeOf(e, 2) >> (BCM_PLANES - 1)) & 1u));
+	}
+	CHECK(wrap, "scrollTo took effect in the middle of a frame");
+
+	/* moving, both ways on both axes, wrapping and clamped, serviced every
+	 * ms or in long gaps: the fractions of a pixel add up exactly
+	 */
+	for(n = 0; n < 400u; n++)
+	{
+		vx = (int16)((int32)(rnd() % 401u) - 200);
+		vy = (int16)((int32)(rnd() % 81u) - 40);
+		wrap = (uint8)(rnd() & 1u);
+		step = (n % 4u == 0u) ? 1u + rnd() % 2000u : 1u + rnd() % 40u;
+		x = (int16)(rnd() % VW);
+		y = (int16)(rnd() % VH);
+		scrollSpeed(0, 0, wrap);
+		scrollTo(x, y);
+		expectTo(x, y, wrap);
+		scrollSpeed(vx, vy, wrap);
+		if(!run(vx, vy, wrap, 3000u, step))
+		{
+			CHECK(0, "%d, %d px/s from %d, %d %s, every %u ms, strays from the elapsed time", vx, vy, x, y,
+				wrap ? "wrapping" : "clamped", step);
+		}
+		if(testFailures > 10u)
+		{
+			break;
+		}
+	}
+
+	/* a marquee at 7 px/s called every ms is 7 pixels on after a second,
+	 * and back there after VW seconds more, 7 whole laps
+	 */
+	scrollSpeed(0, 0, 1);
+	scrollTo(VW - 3, 0);
+	scrollSpeed(7, 0, 1);
+	for(n = 0; n < 1000u; n++)
+	{
+		hostMillis++;
+		scrollService();
+	}
+	CHECK(showsWindow(4, 0), "7 px/s for a second from %u does not wrap to 4", VW - 3);
+	hostMillis += (uint32)VW * 1000u;
+	scrollService();
+	CHECK(showsWindow(4, 0), "a whole lap did not come back to 4");
+
+	/* stopped, time passing moves nothing */
+	scrollSpeed(0, 0, 1);
+	hostMillis += 100000u;
+	scrollService();
+	CHECK(showsWindow(4, 0), "moved while stopped");
+
+	return TEST_RESULT("scroll " TEST_STR(VIRTUAL_WIDTH) "x" TEST_STR(VIRTUAL_HEIGHT));
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,200 @@
+/* ========================================
+ *
+ * Copyright YOUR COMPANY, THE YEAR
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+/* drawSprite1/drawSprite4 against the same sprite drawn pixel by pixel with
+ * drawPixel, for random sprites, positions, flips, transparent indices and
+ * clip rectangles; then pixels per microsecond for 8x8 and 16x16 sprites,
+ * blitted and drawn with drawPixel.
+ */
+
+#include <string.h>
+#include <device.h>
+#include <LED_Matrix.h>
+#include "test.h"
+
+static color fb[MATRIX_LANES];
+static color ref[MATRIX_LANES];
+
+static uint8 data[SPRITE_MAX_WIDTH / 2u * 40u];
+
+static uint32 seed = 7;
+
+static uint32 rnd(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static RGB anyColor(void)
+{
+	RGB c;
+
+	c.r = (uint8)rnd();
+	c.g = (uint8)rnd();
+	c.b = (uint8)rnd();
+	return c;
+}
+
+/* The pixel at sprite column k, row j as stored, before flipping */
+static uint8 pixel1(const Sprite *s, uint8 k, uint8 j)
+{
+	return (s->data[j * ((s->width + 7u) / 8u) + k / 8u] >> (k % 8u)) & 1u;
+}
+
+static uint8 pixel4(const Sprite *s, uint8 k, uint8 j)
+{
+	uint8 b = s->data[j * ((s->width + 1u) / 2u) + k / 2u];
+
+	return (k & 1u) ? (b >> 4) : (b & 0x0Fu);
+}
+
+/* Reference: every opaque pixel through drawPixel, which clips on its own */
+static void reference(int8 x, int8 y, const Sprite *s, uint8 bpp, RGB c, const RGB *palette,
+	uint8 transparent, uint8 flags)
+{
+	uint8 k, j, sk, sj, n;
+
+	for(j = 0; j < s->height; j++)
+	{
+		for(k = 0; k < s->width; k++)
+		{
+			sk = (flags & SPRITE_FLIP_X) ? s->width - 1u - k : k;
+			sj = (flags & SPRITE_FLIP_Y) ? s->height - 1u - j : j;
+			if(bpp == 1u)
+			{
+				if(pixel1(s, sk, sj))
+				{
+					drawPixel((int8)(x + k), (int8)(y + j), c, ref);
+				}
+			}
+			else
+			{
+				n = pixel4(s, sk, sj);
+				if(n != transparent)
+				{
+					drawPixel((int8)(x + k), (int8)(y + j), palette[n], ref);
+				}
+			}
+		}
+	}
+}
+
+/* Pixels per microsecond for 'reps' draws of a w x h sprite at x */
+static double bench(uint8 bpp, uint8 w, uint8 h, int8 x, uint8 viaPixels)
+{
+	static RGB palette[16];
+	Sprite s = {w, h, data};
+	RGB c = {200, 100, 50};
+	uint32 n, reps = 200000u;
+	double t0;
+
+	for(n = 0; n < 16u; n++)
+	{
+		palette[n] = anyColor();
+	}
+	memset(data, 0xFF, sizeof(data));
+	t0 = benchNs();
+	for(n = 0; n < reps; n++)
+	{
+		if(viaPixels)
+		{
+			reference(x, 4, &s, bpp, c, palette, SPRITE_NO_TRANSPARENT, 0);
+		}
+		else if(bpp == 1u)
+		{
+			drawSprite1(x, 4, &s, c, 0, fb);
+		}
+		else
+		{
+			drawSprite4(x, 4, &s, palette, SPRITE_NO_TRANSPARENT, 0, fb);
+		}
+	}
+	return (double)reps * w * h / ((benchNs() - t0) / 1000.0);
+}
+
+int main(void)
+{
+	RGB c, palette[16];
+	Sprite s;
+	uint32 n, i;
+	uint8 bpp, flags, transparent, sizes[2] = {8, 16};
+	int8 x, y;
+
+	s.data = data;
+	for(n = 0; n < 20000u; n++)
+	{
+		for(i = 0; i < sizeof(data); i++)
+		{
+			data[i] = (uint8)rnd();
+		}
+		for(i = 0; i < 16u; i++)
+		{
+			palette[i] = anyColor();
+		}
+		s.width = (uint8)(1u + rnd() % SPRITE_MAX_WIDTH);
+		s.height = (uint8)(1u + rnd() % 40u);
+		x = (int8)((int16)(rnd() % (CANVAS_WIDTH + 2u * SPRITE_MAX_WIDTH)) - SPRITE_MAX_WIDTH);
+		y = (int8)((int16)(rnd() % (CANVAS_HEIGHT + 80u)) - 40);
+		bpp = (rnd() & 1u) ? 1u : 4u;
+		flags = (uint8)(rnd() & 3u);
+		transparent = (rnd() & 1u) ? (uint8)(rnd() & 15u) : SPRITE_NO_TRANSPARENT;
+		c = anyColor();
+		if(n & 1u)
+		{
+			setClipRect((int8)(rnd() % CANVAS_WIDTH), (int8)(rnd() % CANVAS_HEIGHT),
+				(int8)(rnd() % CANVAS_WIDTH), (int8)(rnd() % CANVAS_HEIGHT));
+		}
+		else
+		{
+			resetClipRect();
+		}
+
+		/* the same background under both */
+		for(i = 0; i < sizeof(fb); i++)
+		{
+			((uint8 *)fb)[i] = (uint8)rnd();
+		}
+		memcpy(ref, fb, sizeof(fb));
+		if(bpp == 1u)
+		{
+			drawSprite1(x, y, &s, c, flags, fb);
+		}
+		else
+		{
+			drawSprite4(x, y, &s, palette, transparent, flags, fb);
+		}
+		reference(x, y, &s, bpp, c, palette, transparent, flags);
+		if(memcmp(fb, ref, sizeof(fb)) != 0)
+		{
+			CHECK(0, "%ubpp %ux%u at %d,%d flags %u transparent %u differs from drawPixel",
+				bpp, s.width, s.height, x, y, flags, transparent);
+			break;
+		}
+	}
+	resetClipRect();
+
+	/* host figures: the ratio between the two is what carries over */
+	for(i = 0; i < 2u; i++)
+	{
+		for(bpp = 1; bpp <= 4u; bpp += 3u)
+		{
+			printf("%ubpp %2ux%-2u  x=8: %6.1f px/us blitted, %5.1f via drawPixel   x=3: %6.1f px/us blitted\n",
+				bpp, sizes[i], sizes[i], bench(bpp, sizes[i], sizes[i], 8, 0), bench(bpp, sizes[i], sizes[i], 8, 1),
+				bench(bpp, sizes[i], sizes[i], 3, 0));
+		}
+	}
+
+	return TEST_RESULT("sprite");
+}
+
+/* [] END OF FILE */